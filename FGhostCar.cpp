@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FGhostCar.h"
+#include "FPawn.h"
+#include "FLapTimerComponent.h"
+#include "Components/PoseableMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+
+// Same bones the pawn sets its wheels up on
+const FName AFGhostCar::WheelBoneNames[4] = { FName("PhysWheel_FL"), FName("PhysWheel_FR"), FName("PhysWheel_BL"), FName("PhysWheel_BR") };
+
+AFGhostCar::AFGhostCar(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	// Soft so the class default object does not keep the car loaded, set in PostInitProperties
+	CarMeshAsset = TAssetPtr<USkeletalMesh>(FStringAssetReference(TEXT("/Game/Vehicle/Vehicle_SkelMesh.Vehicle_SkelMesh")));
+
+	GhostMesh = PCIP.CreateDefaultSubobject<UPoseableMeshComponent>(this, TEXT("GhostMesh"));
+	GhostMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	GhostMesh->CastShadow = false;
+	RootComponent = GhostMesh;
+
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	GhostMaterial = nullptr;
+	WheelRadius = 18.0f;
+	MaxSteerAngle = 50.0f;
+	bLoop = true;
+	PlaybackTimeUs = 0;
+	WheelSpin = 0.0f;
+}
+
+void AFGhostCar::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Leave what a Blueprint set on the component itself
+	if ((HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) == false) && (GhostMesh->SkeletalMesh == nullptr))
+	{
+		USkeletalMesh* CarMesh = CarMeshAsset.Get();
+		if ((CarMesh == nullptr) && (CarMeshAsset.IsNull() == false))
+		{
+			// Spawned before the bundle got to it
+			CarMesh = LoadObject<USkeletalMesh>(nullptr, *CarMeshAsset.ToStringReference().ToString());
+		}
+		GhostMesh->SetSkeletalMesh(CarMesh);
+	}
+}
+
+void AFGhostCar::GetPreloadAssets(UClass* Class, TArray<FStringAssetReference>& OutAssets)
+{
+	const AFGhostCar* Defaults = CastChecked<AFGhostCar>(Class->GetDefaultObject());
+	OutAssets.AddUnique(Defaults->CarMeshAsset.ToStringReference());
+}
+
+bool AFGhostCar::StartPlayback(const FString& TelemetryFile, int32 Lap, AFPawn* InFollowPawn)
+{
+	FGhostLapCache::Get().Release(GhostLap);
+	GhostLap = FGhostLapCache::Get().FindOrLoad(TelemetryFile, Lap);
+	if (GhostLap.IsValid() == false)
+	{
+		SetActorTickEnabled(false);
+		return false;
+	}
+
+	if (GhostMaterial != nullptr)
+	{
+		for (int32 MaterialIndex = 0; MaterialIndex < GhostMesh->GetNumMaterials(); ++MaterialIndex)
+		{
+			GhostMesh->SetMaterial(MaterialIndex, GhostMaterial);
+		}
+	}
+
+	FollowPawn = InFollowPawn;
+	RestartLap();
+	SetActorHiddenInGame(false);
+	SetActorTickEnabled(true);
+	return true;
+}
+
+void AFGhostCar::StopPlayback()
+{
+	FGhostLapCache::Get().Release(GhostLap);
+	SetActorTickEnabled(false);
+	SetActorHiddenInGame(true);
+}
+
+void AFGhostCar::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FGhostLapCache::Get().Release(GhostLap);
+	Super::EndPlay(EndPlayReason);
+}
+
+void AFGhostCar::RestartLap()
+{
+	Cursor = FGhostLapCursor();
+	PlaybackTimeUs = 0;
+}
+
+void AFGhostCar::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (GhostLap.IsValid() == false)
+	{
+		return;
+	}
+
+	int64 LapTimeUs = 0;
+	AFPawn* Pawn = FollowPawn.Get();
+	if ((Pawn != nullptr) && (Pawn->LapTimer.IsValid() == true))
+	{
+		LapTimeUs = Pawn->LapTimer->GetCurrentLapTimeUs();
+	}
+	else
+	{
+		PlaybackTimeUs += (int64)((double)DeltaSeconds * 1000000.0);
+		if ((bLoop == true) && (PlaybackTimeUs > GhostLap->GetLapTimeUs()))
+		{
+			RestartLap();
+		}
+		LapTimeUs = PlaybackTimeUs;
+	}
+
+	FVehicleTelemetrySample From, To;
+	float Alpha = 0.0f;
+	if (GhostLap->Sample(LapTimeUs, Cursor, From, To, Alpha) == true)
+	{
+		ApplyKeyframes(From, To, Alpha, DeltaSeconds);
+	}
+}
+
+void AFGhostCar::ApplyKeyframes(const FVehicleTelemetrySample& From, const FVehicleTelemetrySample& To, float Alpha, float DeltaSeconds)
+{
+	const FVector Location = FMath::Lerp(From.Location, To.Location, Alpha);
+	const FQuat Rotation = FQuat::Slerp(From.Rotation.Quaternion(), To.Rotation.Quaternion(), Alpha);
+	SetActorLocationAndRotation(Location, Rotation.Rotator(), false);
+
+	// Wheels are rebuilt from the recorded speed and steering
+	const float Speed = FMath::Lerp(From.Speed, To.Speed, Alpha);
+	const float Steering = FMath::Lerp(From.Steering, To.Steering, Alpha);
+	if (WheelRadius > 0.0f)
+	{
+		WheelSpin = FMath::Fmod(WheelSpin + FMath::RadiansToDegrees(Speed * DeltaSeconds / WheelRadius), 360.0f);
+	}
+
+	for (int32 WheelIndex = 0; WheelIndex < ARRAY_COUNT(WheelBoneNames); ++WheelIndex)
+	{
+		// Front wheels are the first two
+		const float Steer = (WheelIndex < 2) ? Steering * MaxSteerAngle : 0.0f;
+		GhostMesh->SetBoneRotationByName(WheelBoneNames[WheelIndex], FRotator(-WheelSpin, Steer, 0.0f), EBoneSpaces::ComponentSpace);
+	}
+}
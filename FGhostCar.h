@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "GhostLap.h"
+#include "FGhostCar.generated.h"
+
+class UPoseableMeshComponent;
+class USkeletalMesh;
+class AFPawn;
+
+/**
+ * Replays a recorded lap by interpolating the telemetry keyframes.
+ * There is no physics, no collision, no animation blueprint, no cameras and no audio, only a posed
+ * mesh, so many ghosts can run next to the player.
+ */
+UCLASS(config=Game)
+class AFGhostCar : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** The car body, wheels are posed directly */
+	UPROPERTY(Category = Ghost, VisibleDefaultsOnly, BlueprintReadOnly)
+	TSubobjectPtr<UPoseableMeshComponent> GhostMesh;
+
+	/** Car mesh, the same asset the pawn has in FVehicleAssetBundle, set before the components register */
+	UPROPERTY(Category = Ghost, EditDefaultsOnly)
+	TAssetPtr<USkeletalMesh> CarMeshAsset;
+
+	/** Optional material to make the ghost look like one */
+	UPROPERTY(Category = Ghost, EditAnywhere, BlueprintReadWrite)
+	UMaterialInterface* GhostMaterial;
+
+	/** Radius of the wheels, used to spin them from the recorded speed */
+	UPROPERTY(Category = Ghost, EditAnywhere, BlueprintReadWrite)
+	float WheelRadius;
+
+	/** Steering angle of the front wheels at full lock */
+	UPROPERTY(Category = Ghost, EditAnywhere, BlueprintReadWrite)
+	float MaxSteerAngle;
+
+	/** Loop the lap when it ends (only when not following a pawn) */
+	UPROPERTY(Category = Ghost, EditAnywhere, BlueprintReadWrite)
+	bool bLoop;
+
+	/**
+	 * Start replaying a lap from a telemetry file.
+	 *
+	 * @param	TelemetryFile	file written by the telemetry recorder
+	 * @param	Lap				lap to replay (0 is the first lap)
+	 * @param	FollowPawn		if set the ghost runs on this pawn's lap time, otherwise on its own clock
+	 * @return false if the lap could not be read
+	 */
+	UFUNCTION(BlueprintCallable, Category = Ghost)
+	bool StartPlayback(const FString& TelemetryFile, int32 Lap, AFPawn* FollowPawn);
+
+	UFUNCTION(BlueprintCallable, Category = Ghost)
+	void StopPlayback();
+
+	/** Restart the lap from the beginning */
+	UFUNCTION(BlueprintCallable, Category = Ghost)
+	void RestartLap();
+
+	/** Add this class's soft referenced assets to a preload list */
+	static void GetPreloadAssets(UClass* Class, TArray<FStringAssetReference>& OutAssets);
+
+	// Begin UObject interface
+	virtual void PostInitProperties() override;
+	// End UObject interface
+
+	// Begin Actor interface
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End Actor interface
+
+	static const FName WheelBoneNames[4];
+
+private:
+	/** Pose the body and wheels between two keyframes */
+	void ApplyKeyframes(const FVehicleTelemetrySample& From, const FVehicleTelemetrySample& To, float Alpha, float DeltaSeconds);
+
+	FGhostLapPtr GhostLap;
+	FGhostLapCursor Cursor;
+
+	/** Pawn whose lap timer drives playback */
+	TWeakObjectPtr<AFPawn> FollowPawn;
+
+	/** Own clock when not following a pawn */
+	int64 PlaybackTimeUs;
+
+	/** Accumulated wheel spin in degrees */
+	float WheelSpin;
+};
@@ -3,9 +3,13 @@
 #include "F.h"
 #include "FHUD.h"
 #include "FPawn.h"
+#include "FLapTimerComponent.h"
+#include "FRaceSession.h"
+#include "VehicleStats.h"
+#include "VehicleProfiler.h"
+#include "VehicleAssetBundle.h"
 #include "Engine/Canvas.h"
 #include "Engine/Font.h"
-#include "CanvasItem.h"
 // Needed for VR Headset
 #include "Engine.h"
 #include "IHeadMountedDisplay.h"
@@ -15,48 +19,115 @@
 AFHUD::AFHUD(const class FPostConstructInitializeProperties& PCIP) 
 	: Super(PCIP)
 {
-	static ConstructorHelpers::FObjectFinder<UFont> Font(TEXT("/Engine/EngineFonts/RobotoDistanceField"));
-	HUDFont = Font.Object;
+	HUDFontAsset = TAssetPtr<UFont>(FStringAssetReference(TEXT("/Engine/EngineFonts/RobotoDistanceField.RobotoDistanceField")));
+	HUDFont = nullptr;
+
+	// Positions on a 1280x720 screen
+	HUDLayer.SetTextScale(1.4f);
+	LapTimerMilSecElement = HUDLayer.AddElement(FVector2D(110.f, 5.f), FLinearColor::White);
+	LapTimerSecondsElement = HUDLayer.AddElement(FVector2D(50.f, 5.f), FLinearColor::Blue);
+	LapTimerMinutesElement = HUDLayer.AddElement(FVector2D(10.f, 5.f), FLinearColor::Red);
+	BestLapElement = HUDLayer.AddElement(FVector2D(10.f, 40.f), FLinearColor::White);
+	SpeedElement = HUDLayer.AddElement(FVector2D(1105.f, 555.f), FLinearColor::White);
+	GearElement = HUDLayer.AddElement(FVector2D(1105.f, 600.f), FLinearColor::White);
+	PositionElement = HUDLayer.AddElement(FVector2D(1105.f, 5.f), FLinearColor::White);
+	GapElement = HUDLayer.AddElement(FVector2D(1105.f, 40.f), FLinearColor::Yellow);
+	LapDeltaElement = HUDLayer.AddElement(FVector2D(200.f, 5.f), FLinearColor::White);
+
+	ShownPosition = INDEX_NONE;
+	ShownNumCars = INDEX_NONE;
+	ShownGapHundredths = INDEX_NONE;
+	ShownLapDeltaMs = MIN_int32;
+}
+
+void AFHUD::GetPreloadAssets(TArray<FStringAssetReference>& OutAssets)
+{
+	OutAssets.AddUnique(GetDefault<AFHUD>()->HUDFontAsset.ToStringReference());
+}
+
+void AFHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FVehicleAssetBundle::Get().WhenLoaded(FSimpleDelegate::CreateUObject(this, &AFHUD::OnVehicleAssetsLoaded));
+}
+
+void AFHUD::OnVehicleAssetsLoaded()
+{
+	HUDFont = HUDFontAsset.Get();
 }
 
 void AFHUD::DrawHUD()
 {
-	Super::DrawHUD();
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleHUDDraw, DrawHUD);
 
-	// Calculate ratio from 720p
-	const float HUDXRatio = Canvas->SizeX / 1280.f;
-	const float HUDYRatio = Canvas->SizeY / 720.f;
+	Super::DrawHUD();
 
 	// We dont want the onscreen hud when using a HMD device	
 	if ((GEngine->HMDDevice.IsValid() == false ) || ((GEngine->HMDDevice.IsValid() == true) && (GEngine->HMDDevice->IsStereoEnabled() == false)))
 	{
 		// Get our vehicle so we can check if we are in car. If we are we don't want onscreen HUD
 		AFPawn* Vehicle = Cast<AFPawn>(GetOwningPawn());
-		if ((Vehicle != nullptr) && (Vehicle->bInCarCameraActive == false))
+		if ((Vehicle != nullptr) && (Vehicle->bInCarCameraActive == false) && (HUDFont != nullptr))
 		{
-			FVector2D ScaleVec(HUDYRatio * 1.4f, HUDYRatio * 1.4f);
+			// Only the elements whose text or color changed are laid out again
+			HUDLayer.SetText(LapTimerMilSecElement, Vehicle->LapTimerMilSecDisplayString);
+			HUDLayer.SetText(LapTimerSecondsElement, Vehicle->LapTimerSecondsDisplayString);
+			HUDLayer.SetText(LapTimerMinutesElement, Vehicle->LapTimerMinutesDisplayString);
 
-			FCanvasTextItem LapTimerMilSecTextItem(FVector2D(HUDXRatio * 110.f, HUDYRatio * 5), Vehicle->LapTimerMilSecDisplayString, HUDFont, FLinearColor::White);
-			LapTimerMilSecTextItem.Scale = ScaleVec;
-			Canvas->DrawItem(LapTimerMilSecTextItem);
+			// Against the best lap at this point of the track, next to the timer
+			AFRaceSession* RaceSession = AFRaceSession::Find(GetWorld());
+			float LapDelta = 0.0f;
+			const bool bHasLapDelta = (RaceSession != nullptr) && (RaceSession->GetDeltaToBestLap(Vehicle, LapDelta) == true);
+			HUDLayer.SetVisible(LapDeltaElement, bHasLapDelta);
+			const int32 LapDeltaMs = FMath::RoundToInt(LapDelta * 1000.0f);
+			if ((bHasLapDelta == true) && (LapDeltaMs != ShownLapDeltaMs))
+			{
+				ShownLapDeltaMs = LapDeltaMs;
+				const int32 AbsMs = FMath::Abs(LapDeltaMs);
+				HUDLayer.SetText(LapDeltaElement, FText::FromString(FString::Printf(TEXT("%c%d.%03d"), (LapDeltaMs >= 0) ? TEXT('+') : TEXT('-'), AbsMs / 1000, AbsMs % 1000)));
+				HUDLayer.SetColor(LapDeltaElement, (LapDeltaMs > 0) ? FLinearColor::Red : FLinearColor::Green);
+			}
 
-			FCanvasTextItem LapTimerSecondsTextItem(FVector2D(HUDXRatio * 50.f, HUDYRatio * 5), Vehicle->LapTimerSecondsDisplayString, HUDFont, FLinearColor::Blue);
-			LapTimerSecondsTextItem.Scale = ScaleVec;
-			Canvas->DrawItem(LapTimerSecondsTextItem);
-
-			FCanvasTextItem LapTimerMinutesTextItem(FVector2D(HUDXRatio * 10.f, HUDYRatio * 5), Vehicle->LapTimerMinutesDisplayString, HUDFont, FLinearColor::Red);
-			LapTimerMinutesTextItem.Scale = ScaleVec;
-			Canvas->DrawItem(LapTimerMinutesTextItem);
+			// Best lap, once the timer has one
+			const bool bHasBestLap = (Vehicle->LapTimer.IsValid() == true) && (Vehicle->LapTimer->GetLapCount() > 0);
+			HUDLayer.SetVisible(BestLapElement, bHasBestLap);
+			if (bHasBestLap == true)
+			{
+				HUDLayer.SetText(BestLapElement, Vehicle->BestLapDisplayString);
+			}
 
 			// Speed
-			FCanvasTextItem SpeedTextItem(FVector2D(HUDXRatio * 1105.f, HUDYRatio * 555), Vehicle->SpeedDisplayString, HUDFont, FLinearColor::White);
-			SpeedTextItem.Scale = ScaleVec;
-			Canvas->DrawItem(SpeedTextItem);
+			HUDLayer.SetText(SpeedElement, Vehicle->SpeedDisplayString);
 
 			// Gear
-			FCanvasTextItem GearTextItem(FVector2D(HUDXRatio * 1105.f, HUDYRatio * 600.f), Vehicle->GearDisplayString, HUDFont, Vehicle->bInReverseGear == false ? Vehicle->GearDisplayColor : Vehicle->GearDisplayReverseColor);
-			GearTextItem.Scale = ScaleVec;
-			Canvas->DrawItem(GearTextItem);
+			HUDLayer.SetText(GearElement, Vehicle->GearDisplayString);
+			HUDLayer.SetColor(GearElement, Vehicle->bInReverseGear == false ? Vehicle->GearDisplayColor : Vehicle->GearDisplayReverseColor);
+
+			// Race position and gap to the car ahead, only when racing
+			const int32 Position = (RaceSession != nullptr) ? RaceSession->GetPosition(Vehicle) : 0;
+			HUDLayer.SetVisible(PositionElement, Position > 0);
+			HUDLayer.SetVisible(GapElement, Position > 1);
+			if (Position > 0)
+			{
+				const int32 NumCars = RaceSession->GetNumCars();
+				if ((Position != ShownPosition) || (NumCars != ShownNumCars))
+				{
+					ShownPosition = Position;
+					ShownNumCars = NumCars;
+					HUDLayer.SetText(PositionElement, FText::Format(LOCTEXT("PositionFormat", "P{0}/{1}"), FText::AsNumber(Position), FText::AsNumber(NumCars)));
+				}
+
+				const int32 GapHundredths = FMath::RoundToInt(RaceSession->GetGapToCarAhead(Vehicle) * 100.0f);
+				if ((Position > 1) && (GapHundredths != ShownGapHundredths))
+				{
+					ShownGapHundredths = GapHundredths;
+					HUDLayer.SetText(GapElement, FText::FromString(FString::Printf(TEXT("+%d.%02d"), GapHundredths / 100, GapHundredths % 100)));
+				}
+			}
+
+			// Everything in one batch
+			HUDLayer.Draw(Canvas, HUDFont);
 		}
 	}
 }
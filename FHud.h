@@ -0,0 +1,53 @@
+// Copyright 1998-2014 Epic Games, Inc. All Rights Reserved.
+#pragma once
+#include "GameFramework/HUD.h"
+#include "VehicleHUDLayer.h"
+#include "FHud.generated.h"
+
+UCLASS(config = Game)
+class AFHUD : public AHUD
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Font of the onscreen text, loaded with FVehicleAssetBundle */
+	UPROPERTY(Category = HUD, EditDefaultsOnly)
+	TAssetPtr<UFont> HUDFontAsset;
+
+	/** HUDFontAsset once loaded, nothing is drawn before */
+	UPROPERTY()
+	UFont* HUDFont;
+
+	/** The assets of the class defaults, for FVehicleAssetBundle */
+	static void GetPreloadAssets(TArray<FStringAssetReference>& OutAssets);
+
+	// Begin Actor interface
+	virtual void BeginPlay() override;
+	// End Actor interface
+
+	// Begin HUD interface
+	virtual void DrawHUD() override;
+	// End HUD interface
+
+private:
+	void OnVehicleAssetsLoaded();
+
+	/** Retained onscreen text, only laid out again when it changes */
+	FVehicleHUDLayer HUDLayer;
+
+	/** Handles of the HUDLayer elements */
+	int32 LapTimerMilSecElement;
+	int32 LapTimerSecondsElement;
+	int32 LapTimerMinutesElement;
+	int32 BestLapElement;
+	int32 SpeedElement;
+	int32 GearElement;
+	int32 PositionElement;
+	int32 GapElement;
+	int32 LapDeltaElement;
+
+	/** What the race elements show, they are only formatted again when these change */
+	int32 ShownPosition;
+	int32 ShownNumCars;
+	int32 ShownGapHundredths;
+	int32 ShownLapDeltaMs;
+};
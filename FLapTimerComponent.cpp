@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FLapTimerComponent.h"
+
+UFLapTimerComponent::UFLapTimerComponent(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	// The owner advances us with its own delta
+	PrimaryComponentTick.bCanEverTick = false;
+	bWantsInitializeComponent = true;
+
+	bAutoStart = true;
+	ExpectedSplitsPerLap = 8;
+
+	bRunning = false;
+	ElapsedUs = 0;
+	RemainderUs = 0.0;
+	LapStartUs = 0;
+	BestLapUs = 0;
+	LastLapUs = 0;
+	LapCount = 0;
+	BestLapIndex = INDEX_NONE;
+}
+
+void UFLapTimerComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	// Reserve up front so recording splits during a race does not allocate
+	CurrentSplitsUs.Reserve(ExpectedSplitsPerLap);
+	BestSplitsUs.Reserve(ExpectedSplitsPerLap);
+
+	ResetTimer();
+	bRunning = bAutoStart;
+}
+
+void UFLapTimerComponent::ResetTimer()
+{
+	ElapsedUs = 0;
+	RemainderUs = 0.0;
+	LapStartUs = 0;
+	BestLapUs = 0;
+	LastLapUs = 0;
+	LapCount = 0;
+	BestLapIndex = INDEX_NONE;
+	CurrentSplitsUs.Reset();
+	BestSplitsUs.Reset();
+}
+
+void UFLapTimerComponent::StartTimer()
+{
+	bRunning = true;
+}
+
+void UFLapTimerComponent::StopTimer()
+{
+	bRunning = false;
+}
+
+void UFLapTimerComponent::RecordSplit()
+{
+	CurrentSplitsUs.Add(GetCurrentLapTimeUs());
+}
+
+void UFLapTimerComponent::CompleteLap()
+{
+	LastLapUs = GetCurrentLapTimeUs();
+
+	if ((BestLapUs == 0) || (LastLapUs < BestLapUs))
+	{
+		BestLapUs = LastLapUs;
+		BestLapIndex = LapCount;
+		// Copy into the existing allocation
+		BestSplitsUs.Reset();
+		BestSplitsUs.Append(CurrentSplitsUs);
+	}
+
+	++LapCount;
+	CurrentSplitsUs.Reset();
+	LapStartUs = ElapsedUs;
+}
+
+float UFLapTimerComponent::GetCurrentLapTime() const
+{
+	return (float)((double)GetCurrentLapTimeUs() / 1000000.0);
+}
+
+float UFLapTimerComponent::GetBestLapTime() const
+{
+	return (float)((double)BestLapUs / 1000000.0);
+}
+
+float UFLapTimerComponent::GetLastLapTime() const
+{
+	return (float)((double)LastLapUs / 1000000.0);
+}
+
+bool UFLapTimerComponent::GetLastSplitDeltaUs(int64& OutDeltaUs) const
+{
+	const int32 SplitIndex = CurrentSplitsUs.Num() - 1;
+	if ((SplitIndex < 0) || (BestSplitsUs.IsValidIndex(SplitIndex) == false))
+	{
+		return false;
+	}
+	OutDeltaUs = CurrentSplitsUs[SplitIndex] - BestSplitsUs[SplitIndex];
+	return true;
+}
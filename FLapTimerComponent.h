@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "FLapTimerComponent.generated.h"
+
+/**
+ * Per vehicle lap and split timer.
+ * Time only advances when the owner feeds it the simulation delta, so it stays in step with the
+ * physics clock (pause, time dilation and hitches included). Time is kept as integer microseconds.
+ * The component never ticks on its own which keeps it cheap with a full grid of cars.
+ */
+UCLASS(ClassGroup=Vehicle, meta=(BlueprintSpawnableComponent))
+class UFLapTimerComponent : public UActorComponent
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Start timing as soon as the owner starts feeding time */
+	UPROPERTY(Category = LapTimer, EditAnywhere, BlueprintReadWrite)
+	bool bAutoStart;
+
+	/** Splits per lap we reserve room for, more are still recorded but may allocate */
+	UPROPERTY(Category = LapTimer, EditAnywhere, BlueprintReadOnly)
+	int32 ExpectedSplitsPerLap;
+
+	// Begin ActorComponent interface
+	virtual void InitializeComponent() override;
+	// End ActorComponent interface
+
+	/** Advance the timer by one simulation step */
+	FORCEINLINE void Advance(float DeltaSeconds)
+	{
+		if (bRunning == true)
+		{
+			const double DeltaUs = (double)DeltaSeconds * 1000000.0 + RemainderUs;
+			const int64 WholeUs = (int64)DeltaUs;
+			RemainderUs = DeltaUs - (double)WholeUs;
+			ElapsedUs += WholeUs;
+		}
+	}
+
+	/** Clear all laps and splits and start a new lap at zero */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	void ResetTimer();
+
+	/** Start (or resume) the timer */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	void StartTimer();
+
+	/** Pause the timer */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	void StopTimer();
+
+	/** Record a split (sector) time for the current lap */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	void RecordSplit();
+
+	/** Finish the current lap and start the next one */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	void CompleteLap();
+
+	/** Time in the current lap in seconds */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	float GetCurrentLapTime() const;
+
+	/** Best completed lap in seconds, 0 if no lap was completed */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	float GetBestLapTime() const;
+
+	/** Last completed lap in seconds, 0 if no lap was completed */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	float GetLastLapTime() const;
+
+	/** Index of the best completed lap (0 is the first lap), INDEX_NONE if no lap was completed */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	int32 GetBestLapIndex() const { return BestLapIndex; }
+
+	/** Number of completed laps */
+	UFUNCTION(BlueprintCallable, Category = LapTimer)
+	int32 GetLapCount() const { return LapCount; }
+
+	/** Time since the timer was reset in microseconds */
+	int64 GetTotalTimeUs() const { return ElapsedUs; }
+
+	/** Time in the current lap in microseconds */
+	int64 GetCurrentLapTimeUs() const { return ElapsedUs - LapStartUs; }
+
+	/** Best completed lap in microseconds, 0 if no lap was completed */
+	int64 GetBestLapTimeUs() const { return BestLapUs; }
+
+	/** Last completed lap in microseconds, 0 if no lap was completed */
+	int64 GetLastLapTimeUs() const { return LastLapUs; }
+
+	/** Splits recorded in the current lap, measured from the start of the lap */
+	const TArray<int64>& GetCurrentSplitsUs() const { return CurrentSplitsUs; }
+
+	/** Splits of the best lap, measured from the start of the lap */
+	const TArray<int64>& GetBestSplitsUs() const { return BestSplitsUs; }
+
+	/**
+	 * Difference between the last split of this lap and the same split of the best lap.
+	 * @return false when there is nothing to compare against
+	 */
+	bool GetLastSplitDeltaUs(int64& OutDeltaUs) const;
+
+	bool IsRunning() const { return bRunning; }
+
+private:
+	bool bRunning;
+
+	/** Total time fed to the timer */
+	int64 ElapsedUs;
+	/** Sub microsecond part of the fed time, carried so nothing is lost over a long race */
+	double RemainderUs;
+
+	int64 LapStartUs;
+	int64 BestLapUs;
+	int64 LastLapUs;
+	int32 LapCount;
+	int32 BestLapIndex;
+
+	TArray<int64> CurrentSplitsUs;
+	TArray<int64> BestSplitsUs;
+};
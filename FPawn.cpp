@@ -5,12 +5,26 @@
 #include "FWheelFront.h"
 #include "FWheelRear.h"
 #include "FHud.h"
+#include "FLapTimerComponent.h"
+#include "FVehicleDashboardComponent.h"
+#include "FVehicleInCarTextComponent.h"
+#include "VehicleTelemetry.h"
+#include "VehicleLiveFeed.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Components/InputComponent.h"
 #include "Vehicles/WheeledVehicleMovementComponent4W.h"
 #include "Engine/SkeletalMesh.h"
+#include "FVehicleTuning.h"
+#include "FVehicleSurfaceMap.h"
+#include "VehicleStats.h"
+#include "VehicleProfiler.h"
+#include "PickUpManager.h"
+#include "VehicleAssetBundle.h"
+#include "FVehicleTickManager.h"
+#include "FRaceSession.h"
+#include "Net/UnrealNetwork.h"
 
 // Needed for VR Headset
 #include "Engine.h"
@@ -20,25 +34,33 @@ const FName AFPawn::LookUpBinding("LookUp");
 const FName AFPawn::LookRightBinding("LookRight");
 const FName AFPawn::EngineAudioRPM("RPM");
 
+DEFINE_STAT(STAT_VehiclePawnTick);
+DEFINE_STAT(STAT_VehicleUpdateHUDStrings);
+DEFINE_STAT(STAT_VehicleSetupInCarHUD);
+DEFINE_STAT(STAT_VehicleUpdatePhysicsMaterial);
+DEFINE_STAT(STAT_VehicleEnableIncarView);
+
 #define LOCTEXT_NAMESPACE "VehiclePawn"
 
 AFPawn::AFPawn(const class FPostConstructInitializeProperties& PCIP)
 	: Super(PCIP)
 {
-	// Car mesh
-	static ConstructorHelpers::FObjectFinder<USkeletalMesh> CarMesh(TEXT("/Game/Vehicle/Vehicle_SkelMesh.Vehicle_SkelMesh"));
-	Mesh->SetSkeletalMesh(CarMesh.Object);
-	
-	static ConstructorHelpers::FClassFinder<UObject> AnimBPClass(TEXT("/Game/Vehicle/VehicleAnimationBlueprint"));
+	// Car mesh and its animation, preloaded by FVehicleAssetBundle and set in PostInitProperties
+	CarMeshAsset = TAssetPtr<USkeletalMesh>(FStringAssetReference(TEXT("/Game/Vehicle/Vehicle_SkelMesh.Vehicle_SkelMesh")));
+	AnimClassAsset = TAssetSubclassOf<UAnimInstance>(FStringAssetReference(TEXT("/Game/Vehicle/VehicleAnimationBlueprint.VehicleAnimationBlueprint_C")));
 	Mesh->SetAnimationMode(EAnimationMode::AnimationBlueprint);
-	Mesh->SetAnimInstanceClass(AnimBPClass.Class);
+
+	SurfaceMap = nullptr;
+	FMemory::Memzero(WheelOffsets, sizeof(WheelOffsets));
+	PendingFrictionChange = FVehicleCoreOutput::NoFrictionChange;
+	PendingHUDFields = 0;
+	PendingHeadLook = FRotator::ZeroRotator;
 
 	// Setup friction materials
-	static ConstructorHelpers::FObjectFinder<UPhysicalMaterial> SlipperyMat(TEXT("/Game/PhysicsMaterials/Slippery.Slippery"));
-	SlipperyMaterial = SlipperyMat.Object;
-		
-	static ConstructorHelpers::FObjectFinder<UPhysicalMaterial> NonSlipperyMat(TEXT("/Game/PhysicsMaterials/NonSlippery.NonSlippery"));
-	NonSlipperyMaterial = NonSlipperyMat.Object;
+	SlipperyMaterialAsset = TAssetPtr<UPhysicalMaterial>(FStringAssetReference(TEXT("/Game/PhysicsMaterials/Slippery.Slippery")));
+	NonSlipperyMaterialAsset = TAssetPtr<UPhysicalMaterial>(FStringAssetReference(TEXT("/Game/PhysicsMaterials/NonSlippery.NonSlippery")));
+	SlipperyMaterial = nullptr;
+	NonSlipperyMaterial = nullptr;
 
 	UWheeledVehicleMovementComponent4W* Vehicle4W = CastChecked<UWheeledVehicleMovementComponent4W>(VehicleMovement);
 
@@ -62,42 +84,9 @@ AFPawn::AFPawn(const class FPostConstructInitializeProperties& PCIP)
 	Vehicle4W->WheelSetups[3].BoneName = FName("PhysWheel_BR");
 	Vehicle4W->WheelSetups[3].AdditionalOffset = FVector(0.f, 8.f, 0.f);
 
-	// Adjust the tire loading
-	Vehicle4W->MinNormalizedTireLoad = 0.0f;
-	Vehicle4W->MinNormalizedTireLoadFiltered = 0.2f;
-	Vehicle4W->MaxNormalizedTireLoad = 2.0f;
-	Vehicle4W->MaxNormalizedTireLoadFiltered = 2.0f;
-
-	// Engine 
-	// Torque setup
-	Vehicle4W->MaxEngineRPM = 5700.0f;
-	Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve()->Reset();
-	Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve()->AddKey(0.0f, 400.0f);
-	Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve()->AddKey(1890.0f, 500.0f);
-	Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve()->AddKey(5730.0f, 400.0f);
- 
-	// Adjust the steering 
-	Vehicle4W->SteeringCurve.GetRichCurve()->Reset();
-	Vehicle4W->SteeringCurve.GetRichCurve()->AddKey(0.0f, 1.0f);
-	Vehicle4W->SteeringCurve.GetRichCurve()->AddKey(40.0f, 0.7f);
-	Vehicle4W->SteeringCurve.GetRichCurve()->AddKey(120.0f, 0.6f);
-			
- 	// Transmission	
-	// We want 4wd
-	Vehicle4W->DifferentialSetup.DifferentialType = EVehicleDifferential4W::LimitedSlip_4W;
-	
-	// Drive the front wheels a little more than the rear
-	Vehicle4W->DifferentialSetup.FrontRearSplit = 0.65;
-
-	// Automatic gearbox
-	Vehicle4W->TransmissionSetup.bUseGearAutoBox = true;
-	
-	// Physics settings
-	// Adjust the center of mass - the buggy is quite low
-	Vehicle4W->COMOffset = FVector(8.0f, 0.0f, 0.0f);
-
-	// Set the inertia scale. This controls how the mass of the vehicle is distributed.
-	Vehicle4W->InertiaTensorScale = FVector(1.0f, 1.333f, 1.2f);
+	// Engine, steering, transmission and chassis come from the shared tuning asset
+	Tuning = UFVehicleTuning::LoadSharedAsset();
+	GetTuning()->ApplyTo(Vehicle4W);
 
 	// Create a spring arm component for our chase camera
 	SpringArm = PCIP.CreateDefaultSubobject<USpringArmComponent>(this, TEXT("SpringArm"));
@@ -129,50 +118,132 @@ AFPawn::AFPawn(const class FPostConstructInitializeProperties& PCIP)
 
 	// In car HUD
 	// Create text render component for in car speed display
-	InCarSpeed = PCIP.CreateDefaultSubobject<UTextRenderComponent>(this, TEXT("IncarSpeed"));
+	InCarSpeed = PCIP.CreateDefaultSubobject<UFVehicleInCarTextComponent>(this, TEXT("IncarSpeed"));
 	InCarSpeed->SetRelativeScale3D(FVector(0.1f, 0.1f, 0.1f));
 	InCarSpeed->SetRelativeLocation(FVector(35.0f, -6.0f, 20.0f));
 	InCarSpeed->SetRelativeRotation(FRotator(0.0f, 180.0f, 0.0f));
 	InCarSpeed->AttachTo(Mesh);
 
 	// Create text render component for in car gear display
-	InCarGear = PCIP.CreateDefaultSubobject<UTextRenderComponent>(this, TEXT("IncarGear"));
+	InCarGear = PCIP.CreateDefaultSubobject<UFVehicleInCarTextComponent>(this, TEXT("IncarGear"));
 	InCarGear->SetRelativeScale3D(FVector(0.1f, 0.1f, 0.1f));
 	InCarGear->SetRelativeLocation(FVector(35.0f, 5.0f, 20.0f));
 	InCarGear->SetRelativeRotation(FRotator(0.0f, 180.0f, 0.0f));
 	InCarGear->AttachTo(Mesh);
 	
-	InCarLapTimerMilsec = PCIP.CreateDefaultSubobject<UTextRenderComponent>(this, TEXT("InCarLapTimerMilSec"));
+	InCarLapTimerMilsec = PCIP.CreateDefaultSubobject<UFVehicleInCarTextComponent>(this, TEXT("InCarLapTimerMilSec"));
 	InCarLapTimerMilsec->SetRelativeScale3D(FVector(0.1f, 0.1f, 0.1f));
 	InCarLapTimerMilsec->SetRelativeLocation(FVector(35.0f, -6.0f, 20.0f));
 	InCarLapTimerMilsec->SetRelativeRotation(FRotator(0.0f, 180.0f, 0.0f));
 	InCarLapTimerMilsec->AttachTo(Mesh);
 
-	InCarLapTimerSeconds = PCIP.CreateDefaultSubobject<UTextRenderComponent>(this, TEXT("InCarLapTimerSeconds"));
+	InCarLapTimerSeconds = PCIP.CreateDefaultSubobject<UFVehicleInCarTextComponent>(this, TEXT("InCarLapTimerSeconds"));
 	InCarLapTimerSeconds->SetRelativeScale3D(FVector(0.1f, 0.1f, 0.1f));
 	InCarLapTimerSeconds->SetRelativeLocation(FVector(35.0f, -6.0f, 20.0f));
 	InCarLapTimerSeconds->SetRelativeRotation(FRotator(0.0f, 180.0f, 0.0f));
 	InCarLapTimerSeconds->AttachTo(Mesh);
 
-	InCarLapTimerMinutes = PCIP.CreateDefaultSubobject<UTextRenderComponent>(this, TEXT("InCarLapTimerMinutes"));
+	InCarLapTimerMinutes = PCIP.CreateDefaultSubobject<UFVehicleInCarTextComponent>(this, TEXT("InCarLapTimerMinutes"));
 	InCarLapTimerMinutes->SetRelativeScale3D(FVector(0.1f, 0.1f, 0.1f));
 	InCarLapTimerMinutes->SetRelativeLocation(FVector(35.0f, -6.0f, 20.0f));
 	InCarLapTimerMinutes->SetRelativeRotation(FRotator(0.0f, 180.0f, 0.0f));
 	InCarLapTimerMinutes->AttachTo(Mesh);
 
+	// Digital dashboard, its mesh and material are set once FVehicleAssetBundle has them loaded
+	DashboardMeshAsset = TAssetPtr<UStaticMesh>(FStringAssetReference(TEXT("/Engine/BasicShapes/Plane.Plane")));
+	DashboardMaterialAsset = TAssetPtr<UMaterialInterface>(FStringAssetReference(TEXT("/Game/Vehicle/Dashboard/M_DigitalDashboard.M_DigitalDashboard")));
+	Dashboard = PCIP.CreateDefaultSubobject<UFVehicleDashboardComponent>(this, TEXT("Dashboard"));
+	Dashboard->SetRelativeScale3D(FVector(0.1f, 0.05f, 1.0f));
+	Dashboard->SetRelativeLocation(FVector(35.0f, 0.0f, 20.0f));
+	Dashboard->SetRelativeRotation(FRotator(90.0f, 180.0f, 0.0f));
+	Dashboard->AttachTo(Mesh);
+
+	// Shown instead of the skeletal mesh far away, the skeletal mesh still drives the physics
+	ProxyMesh = PCIP.CreateDefaultSubobject<UStaticMeshComponent>(this, TEXT("ProxyMesh"));
+	ProxyMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	ProxyMesh->SetHiddenInGame(true);
+	ProxyMesh->AttachTo(Mesh);
+
+	// Lap timer, advanced from Tick with the simulation delta
+	LapTimer = PCIP.CreateDefaultSubobject<UFLapTimerComponent>(this, TEXT("LapTimer"));
 
 	// Setup the audio component and allocate it a sound cue
-	static ConstructorHelpers::FObjectFinder<USoundCue> SoundCue(TEXT("/Game/Sound/Engine_Loop_Cue.Engine_Loop_Cue"));
+	EngineSoundAsset = TAssetPtr<USoundCue>(FStringAssetReference(TEXT("/Game/Sound/Engine_Loop_Cue.Engine_Loop_Cue")));
 	EngineSoundComponent = PCIP.CreateDefaultSubobject<UAudioComponent>(this, TEXT("EngineSound"));
-	EngineSoundComponent->SetSound(SoundCue.Object);
 	EngineSoundComponent->AttachTo(Mesh);
 
 	// Colors for the in-car gear display. One for normal one for reverse
 	GearDisplayReverseColor = FColor(255, 0, 0, 255);
 	GearDisplayColor = FColor(255, 255, 255, 255);
 
-	bIsLowFriction = false;
 	bInReverseGear = false;
+	bUseTickManager = true;
+	bUseDashboard = true;
+	LastAudioRPM = -1.0f;
+	PendingInCarHUDFields = 0;
+	Significance = EVehicleSignificance::High;
+	bDormant = false;
+	ThrottleInput = 0.0f;
+	SteeringInput = 0.0f;
+	bHandbrakeInput = false;
+
+	// Our own compact state replaces the replicated movement
+	bReplicates = true;
+	bReplicateMovement = false;
+	NetUpdateFrequency = 30.0f;
+	NetSnapDistance = 300.0f;
+	NetCorrectionRate = 10.0f;
+	NetInputSequence = 0;
+	LastAppliedInputSequence = 0;
+	NetCorrection = FVector::ZeroVector;
+	FMemory::Memzero(LastWheelAngles, sizeof(LastWheelAngles));
+}
+
+void AFPawn::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Blueprints can pick a different tuning asset
+	if (Tuning != nullptr)
+	{
+		Tuning->ApplyTo(CastChecked<UWheeledVehicleMovementComponent4W>(VehicleMovement));
+	}
+
+	// The physics vehicle is built from the mesh when the components register, which is before BeginPlay
+	if (HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) == false)
+	{
+		ResolveCarMesh();
+	}
+}
+
+void AFPawn::ResolveCarMesh()
+{
+	// Leave what a Blueprint set on the component itself
+	if (Mesh->SkeletalMesh == nullptr)
+	{
+		USkeletalMesh* CarMesh = CarMeshAsset.Get();
+		if ((CarMesh == nullptr) && (CarMeshAsset.IsNull() == false))
+		{
+			// Spawned before the bundle got to it
+			CarMesh = LoadObject<USkeletalMesh>(nullptr, *CarMeshAsset.ToStringReference().ToString());
+		}
+		Mesh->SetSkeletalMesh(CarMesh);
+	}
+
+	if (Mesh->AnimBlueprintGeneratedClass == nullptr)
+	{
+		UClass* AnimClass = AnimClassAsset.Get();
+		if ((AnimClass == nullptr) && (AnimClassAsset.IsNull() == false))
+		{
+			AnimClass = LoadObject<UClass>(nullptr, *AnimClassAsset.ToStringReference().ToString());
+		}
+		Mesh->SetAnimInstanceClass(AnimClass);
+	}
+}
+
+const UFVehicleTuning* AFPawn::GetTuning() const
+{
+	return (Tuning != nullptr) ? Tuning : GetDefault<UFVehicleTuning>();
 }
 
 void AFPawn::SetupPlayerInputComponent(class UInputComponent* InputComponent)
@@ -195,22 +266,55 @@ void AFPawn::SetupPlayerInputComponent(class UInputComponent* InputComponent)
 void AFPawn::MoveForward(float Val)
 {
 	GetVehicleMovementComponent()->SetThrottleInput(Val);
-
+	ThrottleInput = Val;
 }
 
 void AFPawn::MoveRight(float Val)
 {
 	GetVehicleMovementComponent()->SetSteeringInput(Val);
+	SteeringInput = Val;
 }
 
 void AFPawn::OnHandbrakePressed()
 {
 	GetVehicleMovementComponent()->SetHandbrakeInput(true);
+	bHandbrakeInput = true;
 }
 
 void AFPawn::OnHandbrakeReleased()
 {
 	GetVehicleMovementComponent()->SetHandbrakeInput(false);
+	bHandbrakeInput = false;
+}
+
+void AFPawn::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	// Player input is dispatched from the controller's tick, tick after it so telemetry and the net input see this frame's
+	if (Cast<APlayerController>(NewController) != nullptr)
+	{
+		GetVehicleTickActor()->AddTickPrerequisiteActor(NewController);
+	}
+}
+
+void AFPawn::UnPossessed()
+{
+	if (Controller != nullptr)
+	{
+		GetVehicleTickActor()->RemoveTickPrerequisiteActor(Controller);
+	}
+
+	Super::UnPossessed();
+}
+
+AActor* AFPawn::GetVehicleTickActor()
+{
+	if (bUseTickManager == true)
+	{
+		return AFVehicleTickManager::Get(GetWorld());
+	}
+	return this;
 }
 
 void AFPawn::OnToggleCamera()
@@ -220,6 +324,8 @@ void AFPawn::OnToggleCamera()
 
 void AFPawn::EnableIncarView(const bool bState)
 {
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleEnableIncarView, EnableIncarView);
+
 	//if (bState != bInCarCameraActive)
 	//{
 	//	bInCarCameraActive = bState;
@@ -242,137 +348,745 @@ void AFPawn::EnableIncarView(const bool bState)
 		//	Camera->Activate();
 		//}
 		
-		InCarSpeed->SetVisibility(bInCarCameraActive);
-		InCarGear->SetVisibility(bInCarCameraActive);
+		InCarSpeed->SetVisibility((bInCarCameraActive == true) && (bUseDashboard == false));
+		InCarGear->SetVisibility((bInCarCameraActive == true) && (bUseDashboard == false));
+		Dashboard->SetVisibility((bInCarCameraActive == true) && (bUseDashboard == true));
 //	}
 }
 
 void AFPawn::Tick(float Delta)
+{
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehiclePawnTick, PawnTick);
+
+	// Only runs when not ticked by the vehicle tick manager
+	const uint32 StartCycles = FPlatformTime::Cycles();
+	FVehicleCoreInput CoreInput;
+	PreTickVehicle(Delta, CoreInput);
+
+	// Run the engine independent part of the tick
+	FVehicleCoreOutput CoreOutput;
+	Core.Tick(CoreInput, FVehicleFrameContext::Capture(), CoreOutput);
+
+	PostTickVehicle(Delta, CoreOutput);
+
+	AFVehicleTickManager::NoteSimulation(CoreInput.DeltaSeconds, FPlatformTime::Cycles() - StartCycles);
+}
+
+void AFPawn::PreTickVehicle(float Delta, FVehicleCoreInput& OutInput)
+{
+	AdvanceSimulation(Delta);
+
+	GatherCoreInput(OutInput);
+	OutInput.DeltaSeconds = Delta;
+}
+
+void AFPawn::PreTickVehicle(float Delta, FVehicleCoreBatch& Batch, int32 Index)
+{
+	AdvanceSimulation(Delta);
+
+	GatherCoreInput(Batch, Index);
+	Batch.DeltaSeconds[Index] = Delta;
+}
+
+void AFPawn::AdvanceSimulation(float Delta)
+{
+	FVehicleProfiler::Get().AddCount(FVehicleProfiler::VehiclesTicked, 1);
+
+	// Advance the lap timer with the same time as the physics so no race time is lost on a hitch
+	LapTimer->Advance(Delta);
+}
+
+void AFPawn::PostTickVehicle(float Delta, const FVehicleCoreOutput& CoreOutput)
 {
 	// Setup the flag to say we are in reverse gear
-	bInReverseGear = VehicleMovement->GetCurrentGear() < 0;
+	bInReverseGear = CoreOutput.bInReverseGear;
 	
+	// The slower parts of the tick run at their own rates, what they missed is kept until they run
+	const uint32 DueMask = SubsystemSchedule.Advance(Delta);
+	if (CoreOutput.FrictionChange != FVehicleCoreOutput::NoFrictionChange)
+	{
+		PendingFrictionChange = CoreOutput.FrictionChange;
+	}
+	PendingHUDFields |= CoreOutput.ChangedHUDFields;
+
 	// Update phsyics material
-	UpdatePhysicsMaterial();
+	if (FVehicleSubsystemSchedule::IsDue(DueMask, FVehicleSubsystemSchedule::Material) == true)
+	{
+		UpdatePhysicsMaterial(PendingFrictionChange);
+		PendingFrictionChange = FVehicleCoreOutput::NoFrictionChange;
+	}
 
-	// Update the strings used in the hud (incar and onscreen)
-	UpdateHUDStrings();
+	if (FVehicleSubsystemSchedule::IsDue(DueMask, FVehicleSubsystemSchedule::HUDText) == true)
+	{
+		// Update the strings used in the hud (incar and onscreen)
+		UpdateHUDStrings(PendingHUDFields);
+		PendingHUDFields = 0;
 
-	// Set the string in the incar hud
-	SetupInCarHUD();
+		// Set the string in the incar hud
+		SetupInCarHUD();
+	}
 
-	if ((GEngine->HMDDevice.IsValid() == false) || ((GEngine->HMDDevice.IsValid() == true ) && ( (GEngine->HMDDevice->IsHeadTrackingAllowed() == false) || (GEngine->IsStereoscopic3D() == false))))
+	if ( (InputComponent) && (CoreOutput.bApplyManualHeadLook == true) )
 	{
-		if ( (InputComponent) && (bInCarCameraActive == true ))
+		// Look input is read every frame so none is lost between camera updates
+		PendingHeadLook.Pitch += InputComponent->GetAxisValue(LookUpBinding);
+		PendingHeadLook.Yaw += InputComponent->GetAxisValue(LookRightBinding);
+	}
+	if (FVehicleSubsystemSchedule::IsDue(DueMask, FVehicleSubsystemSchedule::Camera) == true)
+	{
+		if (PendingHeadLook.IsZero() == false)
 		{
-			FRotator HeadRotation = InternalCamera->RelativeRotation;
-			HeadRotation.Pitch += InputComponent->GetAxisValue(LookUpBinding);
-			HeadRotation.Yaw += InputComponent->GetAxisValue(LookRightBinding);
-			InternalCamera->RelativeRotation = HeadRotation;
+			InternalCamera->RelativeRotation += PendingHeadLook;
+			PendingHeadLook = FRotator::ZeroRotator;
 		}
-	}	
+	}
 
 	// Pass the engine RPM to the sound component
-	float RPMToAudioScale = 2500.0f / VehicleMovement->GetEngineMaxRotationSpeed();
-	EngineSoundComponent->SetFloatParameter(EngineAudioRPM, VehicleMovement->GetEngineRotationSpeed()*RPMToAudioScale);
+	if ((FVehicleSubsystemSchedule::IsDue(DueMask, FVehicleSubsystemSchedule::Audio) == true) && (CoreOutput.AudioRPM != LastAudioRPM))
+	{
+		EngineSoundComponent->SetFloatParameter(EngineAudioRPM, CoreOutput.AudioRPM);
+		LastAudioRPM = CoreOutput.AudioRPM;
+	}
+
+	TickNetwork(Delta);
+
+	RecordTelemetry();
+
+	PublishLiveFeed();
+}
+
+void AFPawn::SetSignificance(EVehicleSignificance::Type InSignificance, float RateScale)
+{
+	SubsystemSchedule.SetRateScale(RateScale);
+	if (InSignificance == Significance)
+	{
+		return;
+	}
+	Significance = InSignificance;
+
+	// In-car text nobody can read, hidden on top of the in-car view switch
+	const bool bHideText = (Significance >= EVehicleSignificance::Medium);
+	InCarSpeed->SetHiddenInGame(bHideText);
+	InCarGear->SetHiddenInGame(bHideText);
+	InCarLapTimerMilsec->SetHiddenInGame(bHideText);
+	InCarLapTimerSeconds->SetHiddenInGame(bHideText);
+	InCarLapTimerMinutes->SetHiddenInGame(bHideText);
+	Dashboard->SetHiddenInGame(bHideText);
+
+	// Wheels stop turning visibly, the physics carries on
+	Mesh->bPauseAnims = (Significance >= EVehicleSignificance::Low);
+
+	// Far away the proxy is drawn and the engine is not heard
+	const bool bUseProxy = (Significance == EVehicleSignificance::Proxy) && (ProxyMesh->StaticMesh != nullptr);
+	ProxyMesh->SetHiddenInGame(bUseProxy == false);
+	Mesh->SetVisibility(bUseProxy == false);
+	if (Significance == EVehicleSignificance::Proxy)
+	{
+		EngineSoundComponent->Stop();
+	}
+	else if (EngineSoundComponent->IsPlaying() == false)
+	{
+		EngineSoundComponent->Play();
+		LastAudioRPM = -1.0f;
+	}
+}
+
+void AFPawn::GatherCoreInput(FVehicleCoreInput& OutInput) const
+{
+	OutInput.ForwardSpeed = VehicleMovement->GetForwardSpeed();
+	OutInput.CurrentGear = VehicleMovement->GetCurrentGear();
+	OutInput.EngineRotationSpeed = VehicleMovement->GetEngineRotationSpeed();
+	OutInput.EngineMaxRotationSpeed = VehicleMovement->GetEngineMaxRotationSpeed();
+	OutInput.UpZ = GetActorUpVector().Z;
+	OutInput.DeltaSeconds = 0.0f;
+	OutInput.NumWheels = ARRAY_COUNT(WheelOffsets);
+	OutInput.NumSlipperyWheels = (SurfaceMap != nullptr) ? SurfaceMap->CountSlipperyWheels(GetActorTransform(), WheelOffsets, ARRAY_COUNT(WheelOffsets)) : 0;
+	OutInput.bInCarCameraActive = bInCarCameraActive;
+	OutInput.bHasLapTimer = true;
+	OutInput.LapTimeUs = LapTimer->GetCurrentLapTimeUs();
+	OutInput.BestLapUs = LapTimer->GetBestLapTimeUs();
+}
+
+void AFPawn::GatherCoreInput(FVehicleCoreBatch& Batch, int32 Index) const
+{
+	Batch.ForwardSpeed[Index] = VehicleMovement->GetForwardSpeed();
+	Batch.CurrentGear[Index] = VehicleMovement->GetCurrentGear();
+	Batch.EngineRotationSpeed[Index] = VehicleMovement->GetEngineRotationSpeed();
+	Batch.EngineMaxRotationSpeed[Index] = VehicleMovement->GetEngineMaxRotationSpeed();
+	Batch.UpZ[Index] = GetActorUpVector().Z;
+	Batch.DeltaSeconds[Index] = 0.0f;
+	Batch.NumWheels[Index] = ARRAY_COUNT(WheelOffsets);
+	Batch.NumSlipperyWheels[Index] = (SurfaceMap != nullptr) ? SurfaceMap->CountSlipperyWheels(GetActorTransform(), WheelOffsets, ARRAY_COUNT(WheelOffsets)) : 0;
+	Batch.Flags[Index] = FVehicleCoreBatch::HasLapTimer | (bInCarCameraActive ? FVehicleCoreBatch::InCarCameraActive : 0);
+	Batch.LapTimeUs[Index] = LapTimer->GetCurrentLapTimeUs();
+	Batch.BestLapUs[Index] = LapTimer->GetBestLapTimeUs();
+}
+
+void AFPawn::GetPreloadAssets(UClass* Class, TArray<FStringAssetReference>& OutAssets)
+{
+	const AFPawn* Defaults = CastChecked<AFPawn>(Class->GetDefaultObject());
+	OutAssets.AddUnique(Defaults->CarMeshAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->AnimClassAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->SlipperyMaterialAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->NonSlipperyMaterialAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->EngineSoundAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->DashboardMeshAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->DashboardMaterialAsset.ToStringReference());
+}
+
+void AFPawn::OnVehicleAssetsLoaded()
+{
+	if (IsPendingKill() == true)
+	{
+		return;
+	}
+
+	SlipperyMaterial = SlipperyMaterialAsset.Get();
+	NonSlipperyMaterial = NonSlipperyMaterialAsset.Get();
+	Dashboard->SetStaticMesh(DashboardMeshAsset.Get());
+	Dashboard->SetDashboardMaterial(DashboardMaterialAsset.Get());
+
+	// Wheel contact points for the surface map, they do not move relative to the actor
+	UWheeledVehicleMovementComponent4W* Vehicle4W = CastChecked<UWheeledVehicleMovementComponent4W>(VehicleMovement);
+	const FTransform ActorTransform = GetActorTransform();
+	for (int32 WheelIndex = 0; WheelIndex < ARRAY_COUNT(WheelOffsets); ++WheelIndex)
+	{
+		WheelOffsets[WheelIndex] = ActorTransform.InverseTransformPosition(Mesh->GetBoneLocation(Vehicle4W->WheelSetups[WheelIndex].BoneName));
+	}
+
+	// Start an engine sound playing, a parked vehicle starts it when it comes out of the pool
+	EngineSoundComponent->SetSound(EngineSoundAsset.Get());
+	if (bDormant == false)
+	{
+		EngineSoundComponent->Play();
+	}
 }
 
 void AFPawn::BeginPlay()
 {
+	if (SurfaceMap != nullptr)
+	{
+		Core.FrictionHysteresis = SurfaceMap->GetFrictionHysteresis();
+	}
+
+	// Staggered against the vehicles that began play before us
+	SubsystemSchedule.Init(SubsystemRates);
+
 	// Enable in car view if HMD is attached
 	EnableIncarView(GEngine->HMDDevice.IsValid());
 
-	// Start an engine sound playing
-	EngineSoundComponent->Play();
+	// Materials and sound, straight away unless we spawned before the preload finished.
+	// A Blueprint subclass may point at assets the bundle was not asked for.
+	TArray<FStringAssetReference> ClassAssets;
+	GetPreloadAssets(GetClass(), ClassAssets);
+	FVehicleAssetBundle& AssetBundle = FVehicleAssetBundle::Get();
+	AssetBundle.AddAssets(ClassAssets);
+	AssetBundle.WhenLoaded(FSimpleDelegate::CreateUObject(this, &AFPawn::OnVehicleAssetsLoaded));
+
+	RegisterWithManagers();
 }
 
-void AFPawn::OnResetVR()
+void AFPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if (GEngine->HMDDevice.IsValid())
+	// Let the recorder finish our file
+	FVehicleTelemetryRecorder::Get().CloseChannel(TelemetryChannel);
+	TelemetryChannel.Reset();
+
+	UnregisterFromManagers();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AFPawn::RegisterWithManagers()
+{
+	// Pickups are collected by the manager from our movement
+	APickUpManager::Get(GetWorld())->RegisterCollector(this);
+
+	// Tick with the other vehicles, our own tick is turned off while registered
+	if (bUseTickManager == true)
 	{
-		GEngine->HMDDevice->ResetOrientationAndPosition();
-		InternalCamera->SetRelativeLocation(InternalCameraOrigin);
-		GetController()->SetControlRotation(FRotator());
+		AFVehicleTickManager::Get(GetWorld())->RegisterVehicle(this);
+	}
+
+	// Detail drops with distance from the local view
+	AFVehicleSignificanceManager::Get(GetWorld())->RegisterVehicle(this);
+
+	// Join the race when the level has one
+	AFRaceSession* RaceSession = AFRaceSession::Find(GetWorld());
+	if (RaceSession != nullptr)
+	{
+		RaceSession->RegisterCar(this);
 	}
 }
 
-void AFPawn::UpdateHUDStrings()
+void AFPawn::UnregisterFromManagers()
 {
-	float KPH = FMath::Abs(VehicleMovement->GetForwardSpeed()) * 0.036f;
-	int32 KPH_int = FMath::FloorToInt(KPH);
-	//
-	static float Tick = GetTickCount64();
-	float CurTick = GetTickCount64() - Tick;
-	
-	static float Minutes = 0;
-	static float Seconds = 0;
-	static float MilSec = 0;
+	APickUpManager* PickUpManager = APickUpManager::Find(GetWorld());
+	if (PickUpManager != nullptr)
+	{
+		PickUpManager->UnregisterCollector(this);
+	}
 
-	if (CurTick >= 1000)
+	if (bUseTickManager == true)
 	{
-		Tick = GetTickCount64();
-		CurTick = 0;
-		++Seconds;
+		AFVehicleTickManager* TickManager = AFVehicleTickManager::Find(GetWorld());
+		if (TickManager != nullptr)
+		{
+			TickManager->UnregisterVehicle(this);
+		}
 	}
 
-	if (Seconds >= 60)
+	AFRaceSession* RaceSession = AFRaceSession::Find(GetWorld());
+	if (RaceSession != nullptr)
 	{
-		++Minutes;
-		Seconds = 0;
+		RaceSession->UnregisterCar(this);
 	}
 
-	// Using FText because this is display text that should be localizable
-	SpeedDisplayString = FText::Format(LOCTEXT("SpeedFormat", "{0} km/h"), FText::AsNumber(KPH_int));
-	
-	LapTimerMilSecDisplayString = FText::Format(LOCTEXT("LapTimerFormat", "{0}"), FText::AsNumber(CurTick));
-	LapTimerSecondsDisplayString = FText::Format(LOCTEXT("LapTimerFormat", "{0}"), FText::AsNumber(Seconds));
-	LapTimerMinutesDisplayString = FText::Format(LOCTEXT("LapTimerFormat", "{0}"), FText::AsNumber(Minutes));
+	AFVehicleSignificanceManager* SignificanceManager = AFVehicleSignificanceManager::Find(GetWorld());
+	if (SignificanceManager != nullptr)
+	{
+		SignificanceManager->UnregisterVehicle(this);
+	}
+}
+
+void AFPawn::SetDormant(bool bNewDormant)
+{
+	if (bNewDormant == bDormant)
+	{
+		return;
+	}
+	bDormant = bNewDormant;
+
+	if (bDormant == true)
+	{
+		UnregisterFromManagers();
+		SetActorTickEnabled(false);
+		VehicleMovement->SetComponentTickEnabled(false);
+		EngineSoundComponent->Stop();
+
+		// A parked car records nothing, its file is finished and the next use opens a new one
+		FVehicleTelemetryRecorder::Get().CloseChannel(TelemetryChannel);
+		TelemetryChannel.Reset();
+	}
+
+	// Asleep without gravity so the parked body stays where it was put
+	SetActorHiddenInGame(bDormant);
+	SetActorEnableCollision(bDormant == false);
+	Mesh->SetEnableGravity(bDormant == false);
+	if (bDormant == true)
+	{
+		Mesh->PutAllRigidBodiesToSleep();
+	}
+	else
+	{
+		Mesh->WakeAllRigidBodies();
+	}
 
-	if (bInReverseGear == true)
+	if (bDormant == false)
 	{
-		GearDisplayString = FText(LOCTEXT("ReverseGear", "R"));
+		SetActorTickEnabled(true);
+		VehicleMovement->SetComponentTickEnabled(true);
+		if (EngineSoundComponent->Sound != nullptr)
+		{
+			EngineSoundComponent->Play();
+		}
+		RegisterWithManagers();
+	}
+}
+
+void AFPawn::ResetVehicleState()
+{
+	// At rest with no input
+	Mesh->SetPhysicsLinearVelocity(FVector::ZeroVector);
+	Mesh->SetPhysicsAngularVelocity(FVector::ZeroVector);
+	VehicleMovement->SetThrottleInput(0.0f);
+	VehicleMovement->SetSteeringInput(0.0f);
+	VehicleMovement->SetHandbrakeInput(false);
+	VehicleMovement->SetTargetGear(1, true);
+	ThrottleInput = 0.0f;
+	SteeringInput = 0.0f;
+	bHandbrakeInput = false;
+
+	LapTimer->ResetTimer();
+	if (LapTimer->bAutoStart == true)
+	{
+		LapTimer->StartTimer();
 	}
 	else
 	{
-		int32 Gear = VehicleMovement->GetCurrentGear();
-		GearDisplayString = (Gear == 0) ? LOCTEXT("N", "N") : FText::AsNumber(Gear);
-	}	
+		LapTimer->StopTimer();
+	}
+
+	// Back on grip, the core reports every HUD string as changed on the next tick
+	Core.Reset();
+	bInReverseGear = false;
+	PendingFrictionChange = FVehicleCoreOutput::NoFrictionChange;
+	if (NonSlipperyMaterial != nullptr)
+	{
+		Mesh->SetPhysMaterialOverride(NonSlipperyMaterial);
+	}
+	SpeedDisplayString = FText::GetEmpty();
+	GearDisplayString = FText::GetEmpty();
+	LapTimerMinutesDisplayString = FText::GetEmpty();
+	LapTimerSecondsDisplayString = FText::GetEmpty();
+	LapTimerMilSecDisplayString = FText::GetEmpty();
+	BestLapDisplayString = FText::GetEmpty();
+	PendingHUDFields = 0;
+	PendingInCarHUDFields = 0;
+	PendingHeadLook = FRotator::ZeroRotator;
+	LastAudioRPM = -1.0f;
+	NetCorrection = FVector::ZeroVector;
+	SubsystemSchedule.ForceAll();
 }
 
-void AFPawn::SetupInCarHUD()
+void AFPawn::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	APlayerController* PlayerController = Cast<APlayerController>(GetController());
-	if ((PlayerController != nullptr) && (InCarSpeed.IsValid() == true) && (InCarGear.IsValid()==true) )
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owner needs it too, to reconcile its prediction
+	DOREPLIFETIME(AFPawn, NetState);
+}
+
+void AFPawn::TickNetwork(float Delta)
+{
+	if (GetNetMode() == NM_Standalone)
 	{
-		// Setup the text render component strings
-		InCarSpeed->SetText(SpeedDisplayString.ToString());
-		InCarGear->SetText(GearDisplayString.ToString());
-		
-		if (bInReverseGear == false)
+		return;
+	}
+
+	if (Role == ROLE_Authority)
+	{
+		FVehicleNetSnapshot NewState;
+		NewState.InputSequence = LastAppliedInputSequence;
+		NewState.SetState(GetActorLocation(), GetActorRotation(), Mesh->GetPhysicsLinearVelocity(), Mesh->GetPhysicsAngularVelocity());
+
+		for (int32 WheelIndex = 0; WheelIndex < FVehicleNetSnapshot::NumWheels; ++WheelIndex)
+		{
+			const float WheelAngle = VehicleMovement->Wheels.IsValidIndex(WheelIndex) ? VehicleMovement->Wheels[WheelIndex]->GetRotationAngle() : 0.0f;
+			const float WheelSpeed = (Delta > 0.0f) ? FRotator::NormalizeAxis(WheelAngle - LastWheelAngles[WheelIndex]) / Delta : 0.0f;
+			NewState.WheelSpeed[WheelIndex] = FMath::RoundToInt(WheelSpeed);
+			LastWheelAngles[WheelIndex] = WheelAngle;
+		}
+
+		NewState.Gear = VehicleMovement->GetCurrentGear();
+		NewState.Throttle = FVehicleNetSnapshot::QuantizeInput(ThrottleInput);
+		NewState.Steering = FVehicleNetSnapshot::QuantizeInput(SteeringInput);
+		NewState.bHandbrake = bHandbrakeInput ? 1 : 0;
+
+		// A new id only when something changed, so a parked car costs nothing
+		if (NewState.IsStateEqual(NetState.Snapshot) == false)
+		{
+			NewState.StateId = NetState.Snapshot.StateId + 1;
+			NetState.Snapshot = NewState;
+		}
+		return;
+	}
+
+	if (IsLocallyControlled() == true)
+	{
+		// Predict locally from our own input and tell the server what we did
+		FVehicleNetInput Input;
+		Input.Sequence = ++NetInputSequence;
+		Input.Throttle = (int8)FVehicleNetSnapshot::QuantizeInput(ThrottleInput);
+		Input.Steering = (int8)FVehicleNetSnapshot::QuantizeInput(SteeringInput);
+		Input.bHandbrake = bHandbrakeInput;
+		ServerSetInput(Input);
+
+		if (NetPredictions.Num() == 0)
 		{
-			InCarGear->SetTextRenderColor(GearDisplayColor);
+			NetPredictions.AddZeroed(128);
+		}
+		FVehicleNetPrediction& Prediction = NetPredictions[Input.Sequence % NetPredictions.Num()];
+		Prediction.Sequence = Input.Sequence;
+		Prediction.Location = GetActorLocation();
+		Prediction.Rotation = GetActorQuat();
+		Prediction.LinearVelocity = Mesh->GetPhysicsLinearVelocity();
+	}
+
+	ApplyNetCorrection(Delta);
+}
+
+bool AFPawn::ServerSetInput_Validate(FVehicleNetInput Input)
+{
+	return true;
+}
+
+void AFPawn::ServerSetInput_Implementation(FVehicleNetInput Input)
+{
+	// Unreliable, so drop anything older than what we applied
+	if ((int16)(Input.Sequence - LastAppliedInputSequence) <= 0)
+	{
+		return;
+	}
+	LastAppliedInputSequence = Input.Sequence;
+
+	MoveForward(FVehicleNetSnapshot::DequantizeInput(Input.Throttle));
+	MoveRight(FVehicleNetSnapshot::DequantizeInput(Input.Steering));
+	if (Input.bHandbrake != bHandbrakeInput)
+	{
+		if (Input.bHandbrake == true)
+		{
+			OnHandbrakePressed();
 		}
 		else
 		{
-			InCarGear->SetTextRenderColor(GearDisplayReverseColor);
+			OnHandbrakeReleased();
 		}
 	}
 }
 
-void AFPawn::UpdatePhysicsMaterial()
+void AFPawn::OnRep_NetState()
+{
+	if ((Role == ROLE_Authority) || (NetState.bMissedBaseline == true))
+	{
+		return;
+	}
+	ReconcileWithServer(NetState.Snapshot);
+}
+
+void AFPawn::ReconcileWithServer(const FVehicleNetSnapshot& ServerState)
 {
-	if (GetActorUpVector().Z < 0)
+	const FVector ServerLocation = ServerState.GetLocation();
+	const FQuat ServerRotation = ServerState.GetRotation().Quaternion();
+	const FVector ServerVelocity = ServerState.GetLinearVelocity();
+
+	if (IsLocallyControlled() == true)
 	{
-		if (bIsLowFriction == true)
+		// Compare with what we predicted for the input the server last applied
+		if (NetPredictions.Num() == 0)
+		{
+			return;
+		}
+		FVehicleNetPrediction& Prediction = NetPredictions[ServerState.InputSequence % NetPredictions.Num()];
+		if (Prediction.Sequence != ServerState.InputSequence)
+		{
+			return;
+		}
+
+		const FVector Error = ServerLocation - Prediction.Location;
+		if (Error.SizeSquared() > FMath::Square(NetSnapDistance))
 		{
-			Mesh->SetPhysMaterialOverride(NonSlipperyMaterial);
-			bIsLowFriction = false;
+			// Too far off, move to the server state plus what we simulated since
+			const FQuat RotationSince = Prediction.Rotation.Inverse() * GetActorQuat();
+			SetActorLocationAndRotation(ServerLocation + (GetActorLocation() - Prediction.Location), (ServerRotation * RotationSince).Rotator(), false);
+			Mesh->SetPhysicsLinearVelocity(ServerVelocity + (Mesh->GetPhysicsLinearVelocity() - Prediction.LinearVelocity));
+			NetCorrection = FVector::ZeroVector;
 		}
 		else
 		{
-			Mesh->SetPhysMaterialOverride(SlipperyMaterial);
-			bIsLowFriction = true;
+			NetCorrection += Error;
+		}
+
+		// This and later predictions now contain the error, the next snapshot only sees what is left
+		const uint16 AckedSequence = ServerState.InputSequence;
+		for (FVehicleNetPrediction& Later : NetPredictions)
+		{
+			if ((int16)(Later.Sequence - AckedSequence) >= 0)
+			{
+				Later.Location += Error;
+			}
+		}
+		return;
+	}
+
+	// Other players: drive the local simulation with their inputs and pull it towards the server
+	VehicleMovement->SetThrottleInput(FVehicleNetSnapshot::DequantizeInput(ServerState.Throttle));
+	VehicleMovement->SetSteeringInput(FVehicleNetSnapshot::DequantizeInput(ServerState.Steering));
+	VehicleMovement->SetHandbrakeInput(ServerState.bHandbrake != 0);
+
+	// Only what the correction still being applied doesn't already cover
+	const FVector Error = ServerLocation - (GetActorLocation() + NetCorrection);
+	if ((ServerLocation - GetActorLocation()).SizeSquared() > FMath::Square(NetSnapDistance))
+	{
+		SetActorLocationAndRotation(ServerLocation, ServerRotation.Rotator(), false);
+		NetCorrection = FVector::ZeroVector;
+	}
+	else
+	{
+		SetActorRotation(FQuat::Slerp(GetActorQuat(), ServerRotation, 0.5f).Rotator());
+		NetCorrection += Error;
+	}
+	Mesh->SetPhysicsLinearVelocity(ServerVelocity);
+	Mesh->SetPhysicsAngularVelocity(ServerState.GetAngularVelocity());
+}
+
+void AFPawn::ApplyNetCorrection(float Delta)
+{
+	if (NetCorrection.IsNearlyZero(0.5f) == true)
+	{
+		return;
+	}
+
+	const FVector Step = NetCorrection * FMath::Min(NetCorrectionRate * Delta, 1.0f);
+	SetActorLocation(GetActorLocation() + Step, false);
+	NetCorrection -= Step;
+}
+
+void AFPawn::OnResetVR()
+{
+	if (GEngine->HMDDevice.IsValid())
+	{
+		GEngine->HMDDevice->ResetOrientationAndPosition();
+		InternalCamera->SetRelativeLocation(InternalCameraOrigin);
+		GetController()->SetControlRotation(FRotator());
+	}
+}
+
+void AFPawn::UpdateHUDStrings(uint32 ChangedFields)
+{
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleUpdateHUDStrings, UpdateHUDStrings);
+
+	// Using FText because this is display text that should be localizable. The core only
+	// reformats a string when its displayed value changes.
+	const FVehicleHUDTextCache& HUDText = Core.HUDText;
+	if (ChangedFields & FVehicleHUDTextCache::Speed)
+	{
+		SpeedDisplayString = HUDText.SpeedText;
+	}
+	if (ChangedFields & FVehicleHUDTextCache::Gear)
+	{
+		GearDisplayString = HUDText.GearText;
+	}
+	if (ChangedFields & FVehicleHUDTextCache::LapMinutes)
+	{
+		LapTimerMinutesDisplayString = HUDText.LapMinutesText;
+	}
+	if (ChangedFields & FVehicleHUDTextCache::LapSeconds)
+	{
+		LapTimerSecondsDisplayString = HUDText.LapSecondsText;
+	}
+	if (ChangedFields & FVehicleHUDTextCache::LapMilSec)
+	{
+		LapTimerMilSecDisplayString = HUDText.LapMilSecText;
+	}
+	if (ChangedFields & FVehicleHUDTextCache::BestLap)
+	{
+		BestLapDisplayString = HUDText.BestLapText;
+	}
+	PendingInCarHUDFields |= ChangedFields;
+}
+
+void AFPawn::SetupInCarHUD()
+{
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleSetupInCarHUD, SetupInCarHUD);
+
+	APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	if (PlayerController == nullptr)
+	{
+		return;
+	}
+
+	if (bUseDashboard == true)
+	{
+		// Material parameter writes, the dashboard keeps its mesh and render state
+		const FVehicleHUDTextCache& HUDText = Core.HUDText;
+		if (PendingInCarHUDFields & FVehicleHUDTextCache::Speed)
+		{
+			Dashboard->SetSpeed(HUDText.GetShownKPH());
 		}
+
+		if (PendingInCarHUDFields & FVehicleHUDTextCache::Gear)
+		{
+			Dashboard->SetGear(HUDText.GetShownGear());
+			Dashboard->SetGearColor((bInReverseGear == false) ? GearDisplayColor : GearDisplayReverseColor);
+		}
+
+		if (PendingInCarHUDFields & (FVehicleHUDTextCache::LapMinutes | FVehicleHUDTextCache::LapSeconds | FVehicleHUDTextCache::LapMilSec))
+		{
+			Dashboard->SetLapTime(HUDText.GetShownMinutes(), HUDText.GetShownSeconds(), HUDText.GetShownMilSec());
+		}
+		PendingInCarHUDFields = 0;
+	}
+	else if ((InCarSpeed.IsValid() == true) && (InCarGear.IsValid()==true) )
+	{
+		// Setup the text render component strings. Only push what changed, each SetText rebuilds the text mesh
+		if (PendingInCarHUDFields & FVehicleHUDTextCache::Speed)
+		{
+			InCarSpeed->SetText(SpeedDisplayString.ToString());
+		}
+		
+		if (PendingInCarHUDFields & FVehicleHUDTextCache::Gear)
+		{
+			InCarGear->SetText(GearDisplayString.ToString());
+
+			if (bInReverseGear == false)
+			{
+				InCarGear->SetTextRenderColor(GearDisplayColor);
+			}
+			else
+			{
+				InCarGear->SetTextRenderColor(GearDisplayReverseColor);
+			}
+		}
+		PendingInCarHUDFields = 0;
+	}
+}
+
+void AFPawn::RecordTelemetry()
+{
+	if (TelemetryChannel.IsValid() == false)
+	{
+		FVehicleTelemetryRecorder& Recorder = FVehicleTelemetryRecorder::Get();
+		if (Recorder.IsRecording() == false)
+		{
+			return;
+		}
+		TelemetryChannel = Recorder.OpenChannel(GetName());
+	}
+	else if (TelemetryChannel->IsOpen() == false)
+	{
+		// The session was stopped
+		TelemetryChannel.Reset();
+		return;
+	}
+
+	FVehicleTelemetrySample Sample;
+	Sample.TimeUs = LapTimer->GetTotalTimeUs();
+	Sample.Speed = VehicleMovement->GetForwardSpeed();
+	Sample.RPM = VehicleMovement->GetEngineRotationSpeed();
+	Sample.Gear = VehicleMovement->GetCurrentGear();
+	Sample.Throttle = ThrottleInput;
+	Sample.Steering = SteeringInput;
+	Sample.bHandbrake = bHandbrakeInput;
+	Sample.Lap = LapTimer->GetLapCount();
+	Sample.Location = GetActorLocation();
+	Sample.Rotation = GetActorRotation();
+	TelemetryChannel->Push(Sample);
+}
+
+void AFPawn::PublishLiveFeed()
+{
+	FVehicleLiveFeed& LiveFeed = FVehicleLiveFeed::Get();
+	if (LiveFeed.IsOpen() == false)
+	{
+		return;
+	}
+
+	VehicleLiveFeedFormat::FSample Sample;
+	FVehicleLiveFeed::FillSample(this, Sample);
+	Sample.Throttle = ThrottleInput;
+	Sample.Steering = SteeringInput;
+	Sample.bHandbrake = bHandbrakeInput ? 1 : 0;
+	Sample.LapTimeUs = LapTimer->GetCurrentLapTimeUs();
+	Sample.LastLapUs = LapTimer->GetLastLapTimeUs();
+	Sample.BestLapUs = LapTimer->GetBestLapTimeUs();
+	Sample.Lap = LapTimer->GetLapCount();
+	LiveFeed.Publish(Sample);
+}
+
+void AFPawn::UpdatePhysicsMaterial(FVehicleCoreOutput::EFrictionChange FrictionChange)
+{
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleUpdatePhysicsMaterial, UpdatePhysicsMaterial);
+
+	if (FrictionChange == FVehicleCoreOutput::ToNonSlippery)
+	{
+		Mesh->SetPhysMaterialOverride(NonSlipperyMaterial);
+		FVehicleProfiler::Get().AddCount(FVehicleProfiler::MaterialSwaps, 1);
+	}
+	else if (FrictionChange == FVehicleCoreOutput::ToSlippery)
+	{
+		Mesh->SetPhysMaterialOverride(SlipperyMaterial);
+		FVehicleProfiler::Get().AddCount(FVehicleProfiler::MaterialSwaps, 1);
 	}
 }
 
@@ -1,13 +1,24 @@
 // Copyright 1998-2014 Epic Games, Inc. All Rights Reserved.
 #pragma once
 #include "GameFramework/WheeledVehicle.h"
+#include "VehicleCore.h"
+#include "VehicleNetState.h"
+#include "VehicleSubsystemSchedule.h"
+#include "FVehicleSignificanceManager.h"
 #include "FPawn.generated.h"
 
 class UPhysicalMaterial;
+class USoundCue;
+class UAnimInstance;
 class UCameraComponent;
 class USpringArmComponent;
-class UTextRenderComponent;
+class UFVehicleInCarTextComponent;
 class UInputComponent;
+class UFVehicleTuning;
+class UFVehicleSurfaceMap;
+class UFLapTimerComponent;
+class UFVehicleDashboardComponent;
+class FVehicleTelemetryChannel;
 
 UCLASS(config=Game)
 class AFPawn : public AWheeledVehicle
@@ -28,24 +39,36 @@ class AFPawn : public AWheeledVehicle
 
 	/** Text component for the In-Car speed */
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
-	TSubobjectPtr<UTextRenderComponent> InCarSpeed;
+	TSubobjectPtr<UFVehicleInCarTextComponent> InCarSpeed;
 
 	/** Text component for the In-Car gear */
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
-	TSubobjectPtr<UTextRenderComponent> InCarGear;
+	TSubobjectPtr<UFVehicleInCarTextComponent> InCarGear;
 
 
 
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
-	TSubobjectPtr<UTextRenderComponent> InCarLapTimerMilsec;
+	TSubobjectPtr<UFVehicleInCarTextComponent> InCarLapTimerMilsec;
 
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
-	TSubobjectPtr<UTextRenderComponent> InCarLapTimerSeconds;
+	TSubobjectPtr<UFVehicleInCarTextComponent> InCarLapTimerSeconds;
 
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
-	TSubobjectPtr<UTextRenderComponent> InCarLapTimerMinutes;
+	TSubobjectPtr<UFVehicleInCarTextComponent> InCarLapTimerMinutes;
 
+	/** Material driven in-car display, used instead of the text components when bUseDashboard is set */
+	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
+	TSubobjectPtr<UFVehicleDashboardComponent> Dashboard;
+
+
+
+	/** Cheap stand in for the car at the Proxy significance tier, unused without a mesh */
+	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
+	TSubobjectPtr<UStaticMeshComponent> ProxyMesh;
 
+	/** Lap and split timer driven by the simulation delta */
+	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
+	TSubobjectPtr<UFLapTimerComponent> LapTimer;
 
 	/** Audio component for the engine sound */
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
@@ -69,6 +92,10 @@ class AFPawn : public AWheeledVehicle
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
 	FText LapTimerMilSecDisplayString;
 
+	/** The best lap as a string, empty until a lap is completed */
+	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
+	FText BestLapDisplayString;
+
 
 
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly)
@@ -87,18 +114,128 @@ class AFPawn : public AWheeledVehicle
 	UPROPERTY(Category = Camera, VisibleDefaultsOnly, BlueprintReadOnly)
 	bool bInReverseGear;
 
+	/** Let AFVehicleTickManager tick us with the other vehicles, our own Tick is used when off */
+	UPROPERTY(Category = Vehicle, EditAnywhere, BlueprintReadOnly)
+	bool bUseTickManager;
+
+	/** Show the in-car values on Dashboard, the text components are used when off */
+	UPROPERTY(Category = Display, EditAnywhere, BlueprintReadOnly)
+	bool bUseDashboard;
+
+	/** Update rates of the HUD, audio, material and camera parts of the tick, staggered across vehicles */
+	UPROPERTY(Category = Vehicle, EditAnywhere)
+	FVehicleSubsystemRates SubsystemRates;
+
+	/** Car mesh, preloaded with FVehicleAssetBundle and set before the components register */
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<USkeletalMesh> CarMeshAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetSubclassOf<UAnimInstance> AnimClassAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<UPhysicalMaterial> SlipperyMaterialAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<UPhysicalMaterial> NonSlipperyMaterialAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<USoundCue> EngineSoundAsset;
+
+	/** Quad the dashboard is drawn on and the glyph atlas material drawing it */
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<UStaticMesh> DashboardMeshAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<UMaterialInterface> DashboardMaterialAsset;
+
+	/** The assets of a class's defaults, for FVehicleAssetBundle */
+	static void GetPreloadAssets(UClass* Class, TArray<FStringAssetReference>& OutAssets);
+
+	/** Engine, steering and chassis setup, the built in defaults are used when not set */
+	UPROPERTY(Category = Vehicle, EditDefaultsOnly, BlueprintReadOnly)
+	UFVehicleTuning* Tuning;
+
+	/** The tuning in use, never null */
+	const UFVehicleTuning* GetTuning() const;
+
+	/** Baked track surfaces the wheels are looked up in, grip everywhere when not set */
+	UPROPERTY(Category = Vehicle, EditAnywhere, BlueprintReadOnly)
+	UFVehicleSurfaceMap* SurfaceMap;
+
+	/** Vehicle state from the server, quantized and delta compressed against what the client acked */
+	UPROPERTY(ReplicatedUsing = OnRep_NetState)
+	FVehicleReplicatedState NetState;
+
+	/** Position errors above this are snapped instead of smoothed */
+	UPROPERTY(Category = Network, EditDefaultsOnly, BlueprintReadOnly)
+	float NetSnapDistance;
+
+	/** Share of the remaining correction applied per second */
+	UPROPERTY(Category = Network, EditDefaultsOnly, BlueprintReadOnly)
+	float NetCorrectionRate;
+
+	UFUNCTION()
+	void OnRep_NetState();
+
+	/** Owner input for one tick, unreliable, stale sequences are ignored */
+	UFUNCTION(unreliable, server, WithValidation)
+	void ServerSetInput(FVehicleNetInput Input);
+
+	/** Physics material switches so far, should only move when the car really changes surface */
+	UFUNCTION(Category = Vehicle, BlueprintCallable)
+	int32 GetFrictionChangeCount() const { return Core.NumFrictionChanges; }
+
 	/** Initial offset of incar camera */
 	FVector InternalCameraOrigin;
 
 	// Begin Pawn interface
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void UnPossessed() override;
 	// End Pawn interface
 
+	// Begin UObject interface
+	virtual void PostInitProperties() override;
+	// End UObject interface
+
 	// Begin Actor interface
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual void Tick(float Delta) override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	// End Actor interface
 
+	/**
+	 * First half of a tick: advance the lap timer and read what the core needs.
+	 * Called by Tick, or by AFVehicleTickManager for all registered vehicles in one pass, writing
+	 * straight into entry Index of its batch.
+	 */
+	void PreTickVehicle(float Delta, FVehicleCoreInput& OutInput);
+	void PreTickVehicle(float Delta, FVehicleCoreBatch& Batch, int32 Index);
+
+	/** Second half of a tick: apply what the core decided to the components */
+	void PostTickVehicle(float Delta, const FVehicleCoreOutput& Output);
+
+	FVehicleCore& GetVehicleCore() { return Core; }
+
+	/**
+	 * Switch to the detail of a significance tier, called by AFVehicleSignificanceManager
+	 * @param	RateScale	share of SubsystemRates to run at
+	 */
+	void SetSignificance(EVehicleSignificance::Type InSignificance, float RateScale);
+
+	UFUNCTION(Category = Vehicle, BlueprintCallable)
+	TEnumAsByte<EVehicleSignificance::Type> GetSignificance() const { return Significance; }
+
+	/** Park the vehicle out of play for AFVehiclePool: hidden, no collision, physics asleep, not ticked, or bring it back */
+	void SetDormant(bool bNewDormant);
+
+	bool IsDormant() const { return bDormant; }
+
+	/** Make the vehicle as good as newly spawned: at rest, first gear, lap timer and HUD strings cleared */
+	void ResetVehicleState();
+
 	/** Handle pressing forwards */
 	void MoveForward(float Val);
 
@@ -106,7 +243,7 @@ class AFPawn : public AWheeledVehicle
 	void SetupInCarHUD();
 
 	/** Update the physics material used by the vehicle mesh */
-	void UpdatePhysicsMaterial();
+	void UpdatePhysicsMaterial(FVehicleCoreOutput::EFrictionChange FrictionChange);
 
 	/** Handle pressing right */
 	void MoveRight(float Val);
@@ -132,10 +269,87 @@ private:
 	void EnableIncarView( const bool bState );
 
 	/** Update the gear and speed strings */
-	void UpdateHUDStrings();
+	void UpdateHUDStrings(uint32 ChangedFields);
+
+	/** Join the tick, significance, pickup and race managers, and leave them */
+	void RegisterWithManagers();
+	void UnregisterFromManagers();
+
+	/** Parked in AFVehiclePool */
+	bool bDormant;
+
+	/** Set the car mesh and its animation, loading them if the bundle does not have them yet */
+	void ResolveCarMesh();
+
+	/** Apply the bundle's materials and sound */
+	void OnVehicleAssetsLoaded();
+
+	/** Advance the lap timer by the frame delta the physics runs with */
+	void AdvanceSimulation(float Delta);
+
+	/** Read what the vehicle core needs from the movement component */
+	void GatherCoreInput(FVehicleCoreInput& OutInput) const;
+	void GatherCoreInput(FVehicleCoreBatch& Batch, int32 Index) const;
+
+	/** Queue this tick's state to the telemetry recorder when it is recording */
+	void RecordTelemetry();
+
+	/** Copy this tick's state to the shared memory live feed when it is open */
+	void PublishLiveFeed();
+
+	/** Server: update the snapshot, owning client: send input and record the prediction */
+	void TickNetwork(float Delta);
+
+	/** Correct the local simulation towards a snapshot from the server */
+	void ReconcileWithServer(const FVehicleNetSnapshot& ServerState);
+
+	/** Move the vehicle by part of the pending correction */
+	void ApplyNetCorrection(float Delta);
+
+	/** Owning client: sequence of the last input sent */
+	uint16 NetInputSequence;
+	/** Server: sequence of the last input applied */
+	uint16 LastAppliedInputSequence;
+	/** Owning client: what we predicted for recent inputs, indexed by sequence % size */
+	TArray<FVehicleNetPrediction> NetPredictions;
+	/** Position error still to be smoothed out */
+	FVector NetCorrection;
+	/** Server: wheel angles of the last tick, for the wheel speeds */
+	float LastWheelAngles[FVehicleNetSnapshot::NumWheels];
+
+	/** The actor whose tick runs ours, the tick manager or ourselves */
+	AActor* GetVehicleTickActor();
+
+	/** Last driver inputs, kept for telemetry */
+	float ThrottleInput;
+	float SteeringInput;
+	bool bHandbrakeInput;
+
+	/** Our stream to the telemetry recorder, only valid while recording */
+	TSharedPtr<FVehicleTelemetryChannel, ESPMode::ThreadSafe> TelemetryChannel;
+
+	/** Engine independent tick logic and the cached HUD strings */
+	FVehicleCore Core;
+	/** Last value sent to the engine sound, the parameter is only pushed when it changes */
+	float LastAudioRPM;
+
+	/** Which subsystems run this frame, from SubsystemRates */
+	FVehicleSubsystemSchedule SubsystemSchedule;
+	/** Friction switch the core asked for that the material update has not applied yet */
+	FVehicleCoreOutput::EFrictionChange PendingFrictionChange;
+	/** HUD fields changed since the HUD strings last updated */
+	uint32 PendingHUDFields;
+	/** Look input since the camera last updated */
+	FRotator PendingHeadLook;
+	/** Detail tier we are running at */
+	TEnumAsByte<EVehicleSignificance::Type> Significance;
+
+	/** Fields changed since they were last pushed to the in-car text components (FVehicleHUDTextCache::EField) */
+	uint32 PendingInCarHUDFields;
+
+	/** Wheel positions relative to the actor, read from the bones in BeginPlay */
+	FVector WheelOffsets[4];
 
-	/* Are we on a 'slippery' surface */
-	bool bIsLowFriction;
 	/** Slippery Material instance */
 	UPhysicalMaterial* SlipperyMaterial;
 	/** Non Slippery Material instance */
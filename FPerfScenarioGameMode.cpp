@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FPerfScenarioGameMode.h"
+#include "FPawn.h"
+#include "FVehiclePool.h"
+#include "FHud.h"
+#include "PickUp.h"
+#include "VehicleProfiler.h"
+#include "GameFramework/SpectatorPawn.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPerfScenario, Log, All);
+
+namespace
+{
+	/** Vehicles per grid row and the spacing of the grid */
+	const int32 GridColumns = 8;
+	const float GridSpacing = 800.0f;
+}
+
+AFPerfScenarioGameMode::AFPerfScenarioGameMode(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Nobody drives, the local player only watches
+	DefaultPawnClass = ASpectatorPawn::StaticClass();
+	HUDClass = AFHUD::StaticClass();
+
+	NumVehicles = 32;
+	NumPickUps = 300;
+	ScenarioSeconds = 60.0f;
+	WarmupSeconds = 3.0f;
+	RegressionThresholdPercent = 10.0f;
+	VehicleClass = AFPawn::StaticClass();
+	PickUpClass = APickUp::StaticClass();
+
+	ScenarioTime = 0.0f;
+	bMeasuring = false;
+	bFinished = false;
+	LastFrameTime = 0.0;
+}
+
+void AFPerfScenarioGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("PerfVehicles="), NumVehicles);
+	FParse::Value(CommandLine, TEXT("PerfPickUps="), NumPickUps);
+	FParse::Value(CommandLine, TEXT("PerfSeconds="), ScenarioSeconds);
+	FParse::Value(CommandLine, TEXT("PerfWarmup="), WarmupSeconds);
+	FParse::Value(CommandLine, TEXT("PerfThreshold="), RegressionThresholdPercent);
+	FParse::Value(CommandLine, TEXT("PerfBaseline="), BaselinePath);
+	if (FParse::Value(CommandLine, TEXT("PerfReport="), ReportPath) == false)
+	{
+		ReportPath = FPaths::GameSavedDir() / TEXT("Profiling") / FString::Printf(TEXT("PerfScenario-%s.json"), *FDateTime::Now().ToString());
+	}
+	NumVehicles = FMath::Max(NumVehicles, 1);
+	NumPickUps = FMath::Max(NumPickUps, 0);
+
+	if (FApp::UseFixedTimeStep() == false)
+	{
+		UE_LOG(LogPerfScenario, Warning, TEXT("No fixed time step, run with -benchmark -fps=60 for repeatable results"));
+	}
+
+	SpawnScenario();
+
+	const int32 NumFrames = FMath::CeilToInt(ScenarioSeconds * 120.0f);
+	GameThreadSamples.Reserve(NumFrames);
+	FrameSamples.Reserve(NumFrames);
+
+	UE_LOG(LogPerfScenario, Display, TEXT("Perf scenario: %d vehicles, %d pickups, %.0f s after %.0f s warm up"), Vehicles.Num(), NumPickUps, ScenarioSeconds, WarmupSeconds);
+}
+
+void AFPerfScenarioGameMode::SpawnScenario()
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bNoCollisionFail = true;
+
+	// Grid around the player start, in rows behind it
+	AActor* Start = FindPlayerStart(nullptr);
+	const FVector Origin = (Start != nullptr) ? Start->GetActorLocation() : FVector::ZeroVector;
+	const FRotator Rotation = (Start != nullptr) ? FRotator(0.0f, Start->GetActorRotation().Yaw, 0.0f) : FRotator::ZeroRotator;
+	const FVector Forward = Rotation.Vector();
+	const FVector Right = FRotationMatrix(Rotation).GetScaledAxis(EAxis::Y);
+
+	// The grid is filled from the pool, spawned up front the same way a race level would
+	AFVehiclePool* Pool = AFVehiclePool::Get(GetWorld());
+	Pool->PoolClass = VehicleClass;
+	Pool->PrewarmPool(NumVehicles - Pool->GetNumFreeInPool());
+
+	for (int32 Index = 0; Index < NumVehicles; ++Index)
+	{
+		const float Column = (Index % GridColumns) - (GridColumns - 1) * 0.5f;
+		const float Row = Index / GridColumns;
+		const FVector Location = Origin + Right * Column * GridSpacing - Forward * Row * GridSpacing + FVector(0.0f, 0.0f, 100.0f);
+
+		AFPawn* Vehicle = Pool->AcquireVehicle(Location, Rotation);
+		if (Vehicle != nullptr)
+		{
+			// The movement component only takes raw input from a local controller
+			Vehicle->SpawnDefaultController();
+			Vehicles.Add(Vehicle);
+		}
+	}
+
+	// Same layout every run
+	FRandomStream Random(0x5EED);
+	const float Extent = GridColumns * GridSpacing;
+	for (int32 Index = 0; Index < NumPickUps; ++Index)
+	{
+		const FVector Location = Origin + Right * Random.FRandRange(-Extent, Extent) + Forward * Random.FRandRange(-Extent, Extent) + FVector(0.0f, 0.0f, 50.0f);
+		GetWorld()->SpawnActor<APickUp>(PickUpClass, Location, FRotator::ZeroRotator, SpawnParams);
+	}
+}
+
+void AFPerfScenarioGameMode::DriveVehicles(float Time)
+{
+	for (int32 Index = 0; Index < Vehicles.Num(); ++Index)
+	{
+		AFPawn* Vehicle = Vehicles[Index].Get();
+		if (Vehicle == nullptr)
+		{
+			continue;
+		}
+
+		// Each car weaves on its own phase and pulls the handbrake for half a second every ten
+		const float Phase = Index * 0.7f;
+		Vehicle->MoveForward(0.6f + 0.4f * FMath::Sin(Time * 0.5f + Phase));
+		Vehicle->MoveRight(0.5f * FMath::Sin(Time * 0.9f + Phase * 1.7f));
+		const bool bHandbrake = (FMath::Fmod(Time + Phase, 10.0f) < 0.5f);
+		if (bHandbrake == true)
+		{
+			Vehicle->OnHandbrakePressed();
+		}
+		else
+		{
+			Vehicle->OnHandbrakeReleased();
+		}
+	}
+}
+
+void AFPerfScenarioGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished == true)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (bMeasuring == true)
+	{
+		// The game thread time of the last full frame
+		GameThreadSamples.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+		FrameSamples.Add((float)((Now - LastFrameTime) * 1000.0));
+	}
+	LastFrameTime = Now;
+
+	ScenarioTime += DeltaSeconds;
+	if ((bMeasuring == false) && (ScenarioTime >= WarmupSeconds))
+	{
+		bMeasuring = true;
+		FVehicleProfiler::Get().StartCapture(FPaths::GetBaseFilename(ReportPath));
+	}
+	if (ScenarioTime >= WarmupSeconds + ScenarioSeconds)
+	{
+		FinishScenario();
+		return;
+	}
+
+	DriveVehicles(ScenarioTime);
+}
+
+bool AFPerfScenarioGameMode::CheckRegression(const FString& Baseline, const TCHAR* Key, float Value, float MinValue, FString& Regressions) const
+{
+	float BaselineValue = 0.0f;
+	if (FParse::Value(*Baseline, *FString::Printf(TEXT("\"%s\":"), Key), BaselineValue) == false)
+	{
+		return true;
+	}
+
+	// Tiny measures are mostly noise, they only fail once they are big enough to matter
+	const float Limit = FMath::Max(BaselineValue, MinValue) * (1.0f + RegressionThresholdPercent / 100.0f);
+	if (Value <= Limit)
+	{
+		return true;
+	}
+
+	Regressions += FString::Printf(TEXT("%s\"%s\""), (Regressions.Len() > 0) ? TEXT(", ") : TEXT(""), Key);
+	UE_LOG(LogPerfScenario, Error, TEXT("Regression: %s %.3f, baseline %.3f, limit %.3f"), Key, Value, BaselineValue, Limit);
+	return false;
+}
+
+FString AFPerfScenarioGameMode::BuildReport(bool bPassed, const FString& Regressions) const
+{
+	const FVehicleProfiler& Profiler = FVehicleProfiler::Get();
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	FString Report = TEXT("{\n");
+	Report += FString::Printf(TEXT("\t\"Vehicles\": %d,\n\t\"PickUps\": %d,\n\t\"Seconds\": %.1f,\n\t\"Frames\": %d,\n"), Vehicles.Num(), NumPickUps, ScenarioSeconds, GameThreadSamples.Num());
+	Report += FString::Printf(TEXT("\t\"GameThreadP50Ms\": %.3f,\n\t\"GameThreadP95Ms\": %.3f,\n\t\"GameThreadP99Ms\": %.3f,\n"),
+		FVehicleProfiler::GetPercentile(GameThreadSamples, 50.0f), FVehicleProfiler::GetPercentile(GameThreadSamples, 95.0f), FVehicleProfiler::GetPercentile(GameThreadSamples, 99.0f));
+	Report += FString::Printf(TEXT("\t\"FrameP50Ms\": %.3f,\n\t\"FrameP95Ms\": %.3f,\n\t\"FrameP99Ms\": %.3f,\n"),
+		FVehicleProfiler::GetPercentile(FrameSamples, 50.0f), FVehicleProfiler::GetPercentile(FrameSamples, 95.0f), FVehicleProfiler::GetPercentile(FrameSamples, 99.0f));
+	Report += FString::Printf(TEXT("\t\"PeakUsedPhysicalMB\": %.1f,\n"), MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+
+	Report += TEXT("\t\"Scopes\": {\n");
+	for (int32 Scope = 0; Scope < FVehicleProfiler::NumScopes; ++Scope)
+	{
+		const TArray<float>& Samples = Profiler.GetScopeSamples((FVehicleProfiler::EScope)Scope);
+		const TCHAR* Name = FVehicleProfiler::GetScopeName((FVehicleProfiler::EScope)Scope);
+		Report += FString::Printf(TEXT("\t\t\"%sP50Ms\": %.4f,\n\t\t\"%sP95Ms\": %.4f,\n\t\t\"%sP99Ms\": %.4f%s\n"),
+			Name, FVehicleProfiler::GetPercentile(Samples, 50.0f),
+			Name, FVehicleProfiler::GetPercentile(Samples, 95.0f),
+			Name, FVehicleProfiler::GetPercentile(Samples, 99.0f),
+			(Scope + 1 < FVehicleProfiler::NumScopes) ? TEXT(",") : TEXT(""));
+	}
+	Report += TEXT("\t},\n");
+
+	Report += FString::Printf(TEXT("\t\"Baseline\": \"%s\",\n\t\"ThresholdPercent\": %.1f,\n\t\"Regressions\": [%s],\n\t\"Passed\": %s\n}\n"),
+		*BaselinePath.ReplaceCharWithEscapedChar(), RegressionThresholdPercent, *Regressions, bPassed ? TEXT("true") : TEXT("false"));
+	return Report;
+}
+
+void AFPerfScenarioGameMode::FinishScenario()
+{
+	bFinished = true;
+	FVehicleProfiler& Profiler = FVehicleProfiler::Get();
+	Profiler.StopCapture();
+
+	bool bPassed = true;
+	FString Regressions;
+	FString Baseline;
+	if (BaselinePath.Len() > 0)
+	{
+		if (FFileHelper::LoadFileToString(Baseline, *BaselinePath) == true)
+		{
+			const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+			bPassed &= CheckRegression(Baseline, TEXT("GameThreadP50Ms"), FVehicleProfiler::GetPercentile(GameThreadSamples, 50.0f), 0.5f, Regressions);
+			bPassed &= CheckRegression(Baseline, TEXT("GameThreadP95Ms"), FVehicleProfiler::GetPercentile(GameThreadSamples, 95.0f), 0.5f, Regressions);
+			bPassed &= CheckRegression(Baseline, TEXT("GameThreadP99Ms"), FVehicleProfiler::GetPercentile(GameThreadSamples, 99.0f), 0.5f, Regressions);
+			bPassed &= CheckRegression(Baseline, TEXT("PeakUsedPhysicalMB"), MemoryStats.PeakUsedPhysical / (1024.0f * 1024.0f), 16.0f, Regressions);
+			for (int32 Scope = 0; Scope < FVehicleProfiler::NumScopes; ++Scope)
+			{
+				const FString Key = FString::Printf(TEXT("%sP95Ms"), FVehicleProfiler::GetScopeName((FVehicleProfiler::EScope)Scope));
+				bPassed &= CheckRegression(Baseline, *Key, FVehicleProfiler::GetPercentile(Profiler.GetScopeSamples((FVehicleProfiler::EScope)Scope), 95.0f), 0.05f, Regressions);
+			}
+		}
+		else
+		{
+			UE_LOG(LogPerfScenario, Error, TEXT("Could not read the baseline %s"), *BaselinePath);
+			bPassed = false;
+		}
+	}
+
+	const FString Report = BuildReport(bPassed, Regressions);
+	FFileHelper::SaveStringToFile(Report, *ReportPath);
+	UE_LOG(LogPerfScenario, Display, TEXT("Wrote %s"), *ReportPath);
+
+	// Automation treats the error as a failed run
+	if (bPassed == true)
+	{
+		UE_LOG(LogPerfScenario, Display, TEXT("Perf scenario passed"));
+	}
+	else
+	{
+		UE_LOG(LogPerfScenario, Error, TEXT("Perf scenario failed: %s"), *Regressions);
+	}
+
+	FPlatformMisc::RequestExit(false);
+}
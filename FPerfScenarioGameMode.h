@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/GameMode.h"
+#include "FPerfScenarioGameMode.generated.h"
+
+class AFPawn;
+class APickUp;
+
+/**
+ * Repeatable performance run without a GPU.
+ * Spawns vehicles and pickups, drives the vehicles with scripted inputs for a fixed simulated
+ * time and writes a JSON report of game thread frame times, peak memory and the vehicle scopes
+ * of FVehicleProfiler. Given a baseline report it fails when a measure got worse than the
+ * threshold allows.
+ *
+ *	UE4Editor <Project> <Map>?game=/Script/F.FPerfScenarioGameMode -game -nullrhi -benchmark -fps=60
+ *		-PerfVehicles=32 -PerfPickUps=300 -PerfSeconds=60 -PerfBaseline=<report.json> -PerfThreshold=10
+ */
+UCLASS()
+class AFPerfScenarioGameMode : public AGameMode
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Vehicles to spawn, -PerfVehicles= */
+	UPROPERTY(Category = Scenario, EditDefaultsOnly)
+	int32 NumVehicles;
+
+	/** Pickups to scatter, -PerfPickUps= */
+	UPROPERTY(Category = Scenario, EditDefaultsOnly)
+	int32 NumPickUps;
+
+	/** Simulated seconds measured, -PerfSeconds= */
+	UPROPERTY(Category = Scenario, EditDefaultsOnly)
+	float ScenarioSeconds;
+
+	/** Simulated seconds run before measuring, -PerfWarmup= */
+	UPROPERTY(Category = Scenario, EditDefaultsOnly)
+	float WarmupSeconds;
+
+	/** Allowed regression against the baseline in percent, -PerfThreshold= */
+	UPROPERTY(Category = Scenario, EditDefaultsOnly)
+	float RegressionThresholdPercent;
+
+	UPROPERTY(Category = Scenario, EditDefaultsOnly)
+	TSubclassOf<AFPawn> VehicleClass;
+
+	UPROPERTY(Category = Scenario, EditDefaultsOnly)
+	TSubclassOf<APickUp> PickUpClass;
+
+	// Begin Actor interface
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+	// End Actor interface
+
+private:
+	/** Vehicles on a grid, pickups scattered around it */
+	void SpawnScenario();
+
+	/** Throttle, steering and handbrake of every vehicle at a scenario time */
+	void DriveVehicles(float Time);
+
+	/** Write the report, compare with the baseline and quit */
+	void FinishScenario();
+
+	/** Report as JSON */
+	FString BuildReport(bool bPassed, const FString& Regressions) const;
+
+	/** Compare a measure with the baseline report, adding to Regressions when it got worse */
+	bool CheckRegression(const FString& Baseline, const TCHAR* Key, float Value, float MinValue, FString& Regressions) const;
+
+	TArray<TWeakObjectPtr<AFPawn>> Vehicles;
+
+	/** Simulated seconds since the scenario started */
+	float ScenarioTime;
+	bool bMeasuring;
+	bool bFinished;
+
+	/** Game thread milliseconds of every measured frame */
+	TArray<float> GameThreadSamples;
+	/** Wall clock milliseconds of every measured frame */
+	TArray<float> FrameSamples;
+	double LastFrameTime;
+
+	FString BaselinePath;
+	FString ReportPath;
+};
@@ -0,0 +1,328 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FRaceSession.h"
+#include "FRacingLine.h"
+#include "FPawn.h"
+#include "FLapTimerComponent.h"
+#include "VehicleStats.h"
+
+DEFINE_STAT(STAT_VehicleRaceSession);
+DEFINE_STAT(STAT_VehicleRacePositionSwaps);
+
+AFRaceSession::AFRaceSession(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	// After the cars have moved
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	RacingLine = nullptr;
+	NumLaps = 3;
+	CheckpointFractions.Add(1.0f / 3.0f);
+	CheckpointFractions.Add(2.0f / 3.0f);
+	DeltaSampleSpacing = 500.0f;
+	MaxStepDistance = 2000.0f;
+	LapLength = 0.0f;
+	NumFinished = 0;
+}
+
+AFRaceSession* AFRaceSession::Find(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	TActorIterator<AFRaceSession> It(World);
+	return It ? *It : nullptr;
+}
+
+void AFRaceSession::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (RacingLine == nullptr)
+	{
+		RacingLine = AFRacingLine::Find(GetWorld());
+	}
+
+	// Cars that began play before us, parked pool cars join when they are handed out
+	for (TActorIterator<AFPawn> It(GetWorld()); It; ++It)
+	{
+		if (It->IsDormant() == false)
+		{
+			RegisterCar(*It);
+		}
+	}
+}
+
+void AFRaceSession::RegisterCar(AFPawn* Car)
+{
+	if ((Car == nullptr) || (FindCar(Car) != INDEX_NONE))
+	{
+		return;
+	}
+
+	FRaceCar RaceCar;
+	RaceCar.Car = Car;
+	RaceCar.Cursor = INDEX_NONE;
+	RaceCar.LapDistance = 0.0f;
+	RaceCar.RaceDistance = 0.0f;
+	RaceCar.NextGate = 0;
+	RaceCar.LapsCompleted = 0;
+	RaceCar.bStarted = false;
+	RaceCar.bFinished = false;
+	RaceCar.SortKey = 0.0;
+	RaceCar.Speed = 0.0f;
+
+	const int32 Index = Cars.Add(RaceCar);
+	Standings.Add(Index);
+	Positions.Add(Standings.Num() - 1);
+}
+
+void AFRaceSession::UnregisterCar(AFPawn* Car)
+{
+	const int32 Index = FindCar(Car);
+	if (Index != INDEX_NONE)
+	{
+		RemoveCarAt(Index);
+	}
+}
+
+void AFRaceSession::RemoveCarAt(int32 Index)
+{
+	// Keep the others in their order
+	Cars.RemoveAt(Index);
+	Standings.Remove(Index);
+	for (int32& CarIndex : Standings)
+	{
+		if (CarIndex > Index)
+		{
+			--CarIndex;
+		}
+	}
+	Positions.SetNum(Cars.Num());
+	for (int32 Position = 0; Position < Standings.Num(); ++Position)
+	{
+		Positions[Standings[Position]] = Position;
+	}
+}
+
+int32 AFRaceSession::FindCar(const AFPawn* Car) const
+{
+	for (int32 Index = 0; Index < Cars.Num(); ++Index)
+	{
+		if (Cars[Index].Car.Get() == Car)
+		{
+			return Index;
+		}
+	}
+	return INDEX_NONE;
+}
+
+float AFRaceSession::GetGateDistance(int32 Gate) const
+{
+	// Gate 0 is the line, the checkpoints follow
+	return (Gate == 0) ? 0.0f : CheckpointFractions[Gate - 1] * LapLength;
+}
+
+void AFRaceSession::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VehicleRaceSession);
+
+	Super::Tick(DeltaSeconds);
+
+	if (RacingLine == nullptr)
+	{
+		return;
+	}
+
+	const FVehicleRacingLine& Line = RacingLine->GetLine();
+	if (Line.Num() < 2)
+	{
+		RacingLine->BuildLine();
+		return;
+	}
+	LapLength = Line.Num() * Line.Spacing;
+
+	for (int32 Index = Cars.Num() - 1; Index >= 0; --Index)
+	{
+		if (Cars[Index].Car.IsValid() == false)
+		{
+			RemoveCarAt(Index);
+		}
+	}
+
+	for (FRaceCar& RaceCar : Cars)
+	{
+		UpdateCar(RaceCar);
+	}
+
+	SortStandings();
+}
+
+void AFRaceSession::UpdateCar(FRaceCar& RaceCar)
+{
+	AFPawn* Car = RaceCar.Car.Get();
+	const FVehicleRacingLine& Line = RacingLine->GetLine();
+	const FVector Location = Car->GetActorLocation();
+	RaceCar.Speed = Car->VehicleMovement->GetForwardSpeed();
+
+	// Short walk from last frame's point, then onto the segment either side of it
+	const bool bFirstUpdate = (RaceCar.Cursor == INDEX_NONE);
+	const int32 Nearest = bFirstUpdate ? Line.FindNearestFull(Location) : Line.FindNearest(Location, RaceCar.Cursor);
+	RaceCar.Cursor = Nearest;
+
+	const FVector& Point = Line.Points[Nearest];
+	const FVector Ahead = Line.Points[Line.Wrap(Nearest + 1)] - Point;
+	const float Along = FVector::DotProduct(Location - Point, Ahead) / FMath::Max(Ahead.SizeSquared(), KINDA_SMALL_NUMBER);
+	const float LapDistance = (Nearest + FMath::Clamp(Along, -1.0f, 1.0f)) * Line.Spacing;
+
+	if (bFirstUpdate == true)
+	{
+		RaceCar.LapDelta.Init(LapLength, DeltaSampleSpacing);
+
+		// On the grid behind the line the race distance starts negative
+		RaceCar.LapDistance = LapDistance;
+		RaceCar.RaceDistance = (LapDistance > LapLength * 0.5f) ? LapDistance - LapLength : LapDistance;
+		RaceCar.bStarted = (RaceCar.RaceDistance >= 0.0f);
+		RaceCar.NextGate = 0;
+		if (RaceCar.bStarted == true)
+		{
+			// Joined mid lap, the next gate is the first one still ahead
+			while ((RaceCar.NextGate < CheckpointFractions.Num()) && (GetGateDistance(RaceCar.NextGate + 1) <= LapDistance))
+			{
+				++RaceCar.NextGate;
+			}
+			RaceCar.NextGate = (RaceCar.NextGate < CheckpointFractions.Num()) ? RaceCar.NextGate + 1 : 0;
+		}
+		return;
+	}
+
+	float Step = LapDistance - RaceCar.LapDistance;
+	if (Step < -LapLength * 0.5f)
+	{
+		Step += LapLength;
+	}
+	else if (Step > LapLength * 0.5f)
+	{
+		Step -= LapLength;
+	}
+	RaceCar.LapDistance = LapDistance;
+	if ((RaceCar.bFinished == true) || (FMath::Abs(Step) > MaxStepDistance))
+	{
+		return;
+	}
+	RaceCar.RaceDistance += Step;
+
+	UFLapTimerComponent* LapTimer = Car->LapTimer.Get();
+	if (RaceCar.bStarted == true)
+	{
+		RaceCar.LapDelta.Update(RaceCar.RaceDistance - RaceCar.LapsCompleted * LapLength, LapTimer->GetCurrentLapTimeUs() / 1000000.0f);
+	}
+
+	// Gates have to be passed in order, so cutting the track does not count a lap
+	const float LapStart = RaceCar.LapsCompleted * LapLength;
+	const float GateDistance = (RaceCar.NextGate == 0) ? LapStart + LapLength * (RaceCar.bStarted ? 1.0f : 0.0f) : LapStart + GetGateDistance(RaceCar.NextGate);
+	if (RaceCar.RaceDistance < GateDistance)
+	{
+		return;
+	}
+
+	if (RaceCar.NextGate != 0)
+	{
+		LapTimer->RecordSplit();
+		RaceCar.NextGate = (RaceCar.NextGate < CheckpointFractions.Num()) ? RaceCar.NextGate + 1 : 0;
+	}
+	else if (RaceCar.bStarted == false)
+	{
+		// Crossed the line from the grid, the first lap starts now
+		RaceCar.bStarted = true;
+		LapTimer->ResetTimer();
+		LapTimer->StartTimer();
+		RaceCar.LapDelta.Init(LapLength, DeltaSampleSpacing);
+		RaceCar.LapDelta.StartLap();
+		RaceCar.NextGate = (CheckpointFractions.Num() > 0) ? 1 : 0;
+	}
+	else
+	{
+		LapTimer->CompleteLap();
+		RaceCar.LapDelta.CompleteLap(LapTimer->GetLastLapTimeUs() / 1000000.0f, LapTimer->GetLastLapTimeUs() == LapTimer->GetBestLapTimeUs());
+		++RaceCar.LapsCompleted;
+		RaceCar.NextGate = (CheckpointFractions.Num() > 0) ? 1 : 0;
+		if (RaceCar.LapsCompleted >= NumLaps)
+		{
+			RaceCar.bFinished = true;
+			LapTimer->StopTimer();
+			++NumFinished;
+			// Finishers stay ahead of everyone still racing, in the order they finished
+			RaceCar.SortKey = 1.0e12 - NumFinished;
+		}
+	}
+}
+
+void AFRaceSession::SortStandings()
+{
+	for (FRaceCar& RaceCar : Cars)
+	{
+		if (RaceCar.bFinished == false)
+		{
+			RaceCar.SortKey = RaceCar.RaceDistance;
+		}
+	}
+
+	// Nearly sorted from last frame, so this is close to a single pass
+	for (int32 Position = 1; Position < Standings.Num(); ++Position)
+	{
+		const int32 CarIndex = Standings[Position];
+		const double Key = Cars[CarIndex].SortKey;
+		int32 Insert = Position;
+		while ((Insert > 0) && (Cars[Standings[Insert - 1]].SortKey < Key))
+		{
+			Standings[Insert] = Standings[Insert - 1];
+			Positions[Standings[Insert]] = Insert;
+			--Insert;
+			INC_DWORD_STAT(STAT_VehicleRacePositionSwaps);
+		}
+		Standings[Insert] = CarIndex;
+		Positions[CarIndex] = Insert;
+	}
+}
+
+int32 AFRaceSession::GetPosition(AFPawn* Car) const
+{
+	const int32 Index = FindCar(Car);
+	return (Index != INDEX_NONE) ? Positions[Index] + 1 : 0;
+}
+
+float AFRaceSession::GetGapToCarAhead(AFPawn* Car) const
+{
+	const int32 Index = FindCar(Car);
+	if ((Index == INDEX_NONE) || (Positions[Index] == 0))
+	{
+		return 0.0f;
+	}
+
+	const FRaceCar& RaceCar = Cars[Index];
+	const FRaceCar& Ahead = Cars[Standings[Positions[Index] - 1]];
+	return (Ahead.RaceDistance - RaceCar.RaceDistance) / FMath::Max(RaceCar.Speed, 500.0f);
+}
+
+bool AFRaceSession::GetDeltaToBestLap(AFPawn* Car, float& OutDelta) const
+{
+	OutDelta = 0.0f;
+	const int32 Index = FindCar(Car);
+	return (Index != INDEX_NONE) && (Cars[Index].bFinished == false) && Cars[Index].LapDelta.GetDelta(OutDelta);
+}
+
+int32 AFRaceSession::GetLapsCompleted(AFPawn* Car) const
+{
+	const int32 Index = FindCar(Car);
+	return (Index != INDEX_NONE) ? Cars[Index].LapsCompleted : 0;
+}
+
+AFPawn* AFRaceSession::GetCarAtPosition(int32 Position) const
+{
+	return Standings.IsValidIndex(Position - 1) ? Cars[Standings[Position - 1]].Car.Get() : nullptr;
+}
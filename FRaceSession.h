@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "VehicleLapDelta.h"
+#include "FRaceSession.generated.h"
+
+class AFPawn;
+class AFRacingLine;
+
+/**
+ * Runs a race: lap counting through checkpoint gates, each car's distance along the track and
+ * the live standings.
+ * Distance comes from the racing line, each car keeps the line point it was nearest to last frame
+ * and only searches from there. Standings are kept sorted with an insertion sort, which costs
+ * next to nothing when the order has not changed.
+ */
+UCLASS()
+class AFRaceSession : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** The track, the first racing line in the level when not set. Its start is the finish line */
+	UPROPERTY(Category = Race, EditAnywhere, BlueprintReadOnly)
+	AFRacingLine* RacingLine;
+
+	/** Laps to finish */
+	UPROPERTY(Category = Race, EditAnywhere, BlueprintReadOnly)
+	int32 NumLaps;
+
+	/** Checkpoint gates as a share of the lap (0-1), in order. Each one records a split */
+	UPROPERTY(Category = Race, EditAnywhere, BlueprintReadOnly)
+	TArray<float> CheckpointFractions;
+
+	/** Track distance between the samples of the reference lap for the live delta */
+	UPROPERTY(Category = Race, EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "1"))
+	float DeltaSampleSpacing;
+
+	/** Movement along the line above this in one frame is ignored (resets, teleports) */
+	UPROPERTY(Category = Race, EditAnywhere, BlueprintReadOnly)
+	float MaxStepDistance;
+
+	/** The session of a world if there is one */
+	static AFRaceSession* Find(UWorld* World);
+
+	/** Add a car to the race */
+	void RegisterCar(AFPawn* Car);
+
+	void UnregisterCar(AFPawn* Car);
+
+	/** Race position, 1 is the leader, 0 if not racing */
+	UFUNCTION(Category = Race, BlueprintCallable)
+	int32 GetPosition(AFPawn* Car) const;
+
+	/** Seconds to the car ahead at the current speed, 0 for the leader */
+	UFUNCTION(Category = Race, BlueprintCallable)
+	float GetGapToCarAhead(AFPawn* Car) const;
+
+	/** Seconds behind (positive) or ahead of the car's best lap at this point of the lap, false before it has one */
+	UFUNCTION(Category = Race, BlueprintCallable)
+	bool GetDeltaToBestLap(AFPawn* Car, float& OutDelta) const;
+
+	/** Laps completed */
+	UFUNCTION(Category = Race, BlueprintCallable)
+	int32 GetLapsCompleted(AFPawn* Car) const;
+
+	UFUNCTION(Category = Race, BlueprintCallable)
+	int32 GetNumCars() const { return Cars.Num(); }
+
+	/** Car at a race position (1 based) */
+	UFUNCTION(Category = Race, BlueprintCallable)
+	AFPawn* GetCarAtPosition(int32 Position) const;
+
+	// Begin Actor interface
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+	// End Actor interface
+
+private:
+	struct FRaceCar
+	{
+		TWeakObjectPtr<AFPawn> Car;
+		/** Nearest racing line point last frame */
+		int32 Cursor;
+		/** Distance into the current lap */
+		float LapDistance;
+		/** Distance since the start, negative on the grid behind the line */
+		float RaceDistance;
+		/** Gate to pass next, 0 is the finish line */
+		int32 NextGate;
+		int32 LapsCompleted;
+		/** Crossed the line the first time, the lap timer runs from there */
+		bool bStarted;
+		bool bFinished;
+		/** What the standings sort on */
+		double SortKey;
+		float Speed;
+		/** Time against the best lap */
+		FVehicleLapDelta LapDelta;
+	};
+
+	/** Move a car along the line and run its gates */
+	void UpdateCar(FRaceCar& RaceCar);
+
+	/** Distance of a gate from the start of the lap */
+	float GetGateDistance(int32 Gate) const;
+
+	/** Insertion sort of Standings on SortKey, highest first */
+	void SortStandings();
+
+	int32 FindCar(const AFPawn* Car) const;
+
+	void RemoveCarAt(int32 Index);
+
+	TArray<FRaceCar> Cars;
+	/** Indices into Cars, leader first */
+	TArray<int32> Standings;
+	/** Standings index of each car */
+	TArray<int32> Positions;
+
+	float LapLength;
+	int32 NumFinished;
+};
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FRacingLine.h"
+#include "Components/SplineComponent.h"
+
+AFRacingLine::AFRacingLine(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	Spline = PCIP.CreateDefaultSubobject<USplineComponent>(this, TEXT("Spline"));
+	RootComponent = Spline;
+
+	bClosedLoop = true;
+	SampleSpacing = 100.0f;
+
+	const FVehicleRacingLineLimits DefaultLimits;
+	MaxLateralAccel = DefaultLimits.MaxLateralAccel;
+	MaxBrakeDecel = DefaultLimits.MaxBrakeDecel;
+	MaxAccel = DefaultLimits.MaxAccel;
+	MaxSpeed = DefaultLimits.MaxSpeed;
+}
+
+void AFRacingLine::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BuildLine();
+}
+
+void AFRacingLine::BuildLine()
+{
+	const float Length = Spline->GetSplineLength();
+	const float Spacing = FMath::Max(SampleSpacing, 10.0f);
+	const int32 NumPoints = FMath::Max(FMath::FloorToInt(Length / Spacing), 2);
+
+	TArray<FVector> Points;
+	Points.Reserve(NumPoints);
+	for (int32 Index = 0; Index < NumPoints; ++Index)
+	{
+		Points.Add(Spline->GetWorldLocationAtDistanceAlongSpline(Index * Spacing));
+	}
+
+	FVehicleRacingLineLimits Limits;
+	Limits.MaxLateralAccel = MaxLateralAccel;
+	Limits.MaxBrakeDecel = MaxBrakeDecel;
+	Limits.MaxAccel = MaxAccel;
+	Limits.MaxSpeed = MaxSpeed;
+	Line.Build(Points, Spacing, bClosedLoop, Limits);
+}
+
+AFRacingLine* AFRacingLine::Find(UWorld* World)
+{
+	TActorIterator<AFRacingLine> It(World);
+	return It ? *It : nullptr;
+}
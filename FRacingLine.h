@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "VehicleRacingLine.h"
+#include "FRacingLine.generated.h"
+
+class USplineComponent;
+
+/**
+ * The line the AI drivers follow. Edit the spline in the level, it is resampled with its speed
+ * profile when play begins.
+ */
+UCLASS()
+class AFRacingLine : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	UPROPERTY(Category = RacingLine, VisibleAnywhere, BlueprintReadOnly)
+	TSubobjectPtr<USplineComponent> Spline;
+
+	/** The end joins the start */
+	UPROPERTY(Category = RacingLine, EditAnywhere, BlueprintReadOnly)
+	bool bClosedLoop;
+
+	/** Distance between the resampled points */
+	UPROPERTY(Category = RacingLine, EditAnywhere, BlueprintReadOnly)
+	float SampleSpacing;
+
+	/** Sideways grip in cm/s^2 */
+	UPROPERTY(Category = SpeedProfile, EditAnywhere, BlueprintReadOnly)
+	float MaxLateralAccel;
+
+	/** Braking in cm/s^2 */
+	UPROPERTY(Category = SpeedProfile, EditAnywhere, BlueprintReadOnly)
+	float MaxBrakeDecel;
+
+	/** Acceleration in cm/s^2 */
+	UPROPERTY(Category = SpeedProfile, EditAnywhere, BlueprintReadOnly)
+	float MaxAccel;
+
+	/** Top speed in cm/s */
+	UPROPERTY(Category = SpeedProfile, EditAnywhere, BlueprintReadOnly)
+	float MaxSpeed;
+
+	/** Resample the spline and rebuild the speed profile */
+	UFUNCTION(Category = RacingLine, BlueprintCallable)
+	void BuildLine();
+
+	const FVehicleRacingLine& GetLine() const { return Line; }
+
+	/** First racing line in a world, null if there is none */
+	static AFRacingLine* Find(UWorld* World);
+
+	// Begin Actor interface
+	virtual void BeginPlay() override;
+	// End Actor interface
+
+private:
+	FVehicleRacingLine Line;
+};
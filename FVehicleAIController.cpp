@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleAIController.h"
+#include "FVehicleAIManager.h"
+#include "FRacingLine.h"
+#include "FPawn.h"
+
+AFVehicleAIController::AFVehicleAIController(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	// Driven by AFVehicleAIManager
+	PrimaryActorTick.bCanEverTick = false;
+
+	RacingLine = nullptr;
+
+	const FVehicleAIDriverParams DefaultParams;
+	MinLookahead = DefaultParams.MinLookahead;
+	LookaheadTime = DefaultParams.LookaheadTime;
+	SpeedScale = DefaultParams.SpeedScale;
+}
+
+void AFVehicleAIController::Possess(APawn* InPawn)
+{
+	Super::Possess(InPawn);
+
+	AFPawn* Vehicle = Cast<AFPawn>(InPawn);
+	if (Vehicle == nullptr)
+	{
+		return;
+	}
+
+	if (RacingLine == nullptr)
+	{
+		RacingLine = AFRacingLine::Find(GetWorld());
+	}
+
+	FVehicleAIDriverParams Params;
+	Params.MinLookahead = MinLookahead;
+	Params.LookaheadTime = LookaheadTime;
+	Params.SpeedScale = SpeedScale;
+	AFVehicleAIManager::Get(GetWorld())->RegisterDriver(Vehicle, RacingLine, Params);
+}
+
+void AFVehicleAIController::UnPossess()
+{
+	AFPawn* Vehicle = Cast<AFPawn>(GetPawn());
+	AFVehicleAIManager* Manager = AFVehicleAIManager::Find(GetWorld());
+	if ((Vehicle != nullptr) && (Manager != nullptr))
+	{
+		Manager->UnregisterDriver(Vehicle);
+	}
+
+	Super::UnPossess();
+}
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "AIController.h"
+#include "FVehicleAIController.generated.h"
+
+class AFRacingLine;
+
+/**
+ * Drives an AFPawn along a racing line. The controller itself does not tick: its pawn is handed
+ * to AFVehicleAIManager, which works out the controls of all AI cars in one batch.
+ */
+UCLASS()
+class AFVehicleAIController : public AAIController
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Line to follow, the first one in the level when not set */
+	UPROPERTY(Category = Driving, EditAnywhere, BlueprintReadWrite)
+	AFRacingLine* RacingLine;
+
+	/** Distance ahead of the car steered at */
+	UPROPERTY(Category = Driving, EditAnywhere, BlueprintReadWrite)
+	float MinLookahead;
+
+	/** Extra lookahead per cm/s of speed */
+	UPROPERTY(Category = Driving, EditAnywhere, BlueprintReadWrite)
+	float LookaheadTime;
+
+	/** Share of the racing line speed driven at, below 1 for slower opponents */
+	UPROPERTY(Category = Driving, EditAnywhere, BlueprintReadWrite)
+	float SpeedScale;
+
+	// Begin Controller interface
+	virtual void Possess(APawn* InPawn) override;
+	virtual void UnPossess() override;
+	// End Controller interface
+};
@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleAIManager.h"
+#include "FRacingLine.h"
+#include "FPawn.h"
+#include "FVehicleTuning.h"
+#include "FVehicleTickManager.h"
+
+namespace
+{
+	/** Computes the controls of a range of drivers on a worker thread */
+	class FVehicleAIDriverTask
+	{
+	public:
+		FVehicleAIDriverTask(FVehicleAIDriverBatch* InBatch, int32 InStart, int32 InEnd)
+			: Batch(InBatch)
+			, Start(InStart)
+			, End(InEnd)
+		{
+		}
+
+		FORCEINLINE TStatId GetStatId() const
+		{
+			RETURN_QUICK_DECLARE_CYCLE_STAT(FVehicleAIDriverTask, STATGROUP_TaskGraphTasks);
+		}
+
+		static ENamedThreads::Type GetDesiredThread()
+		{
+			return ENamedThreads::AnyThread;
+		}
+
+		static ESubsequentsMode::Type GetSubsequentsMode()
+		{
+			return ESubsequentsMode::TrackSubsequents;
+		}
+
+		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+		{
+			Batch->Compute(Start, End);
+		}
+
+	private:
+		FVehicleAIDriverBatch* Batch;
+		int32 Start;
+		int32 End;
+	};
+}
+
+AFVehicleAIManager::AFVehicleAIManager(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	// Before the vehicles simulate with the new controls
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	DriversPerTask = 8;
+}
+
+AFVehicleAIManager* AFVehicleAIManager::Find(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AFVehicleAIManager> It(World); It; ++It)
+	{
+		if (It->IsPendingKill() == false)
+		{
+			return *It;
+		}
+	}
+	return nullptr;
+}
+
+AFVehicleAIManager* AFVehicleAIManager::Get(UWorld* World)
+{
+	AFVehicleAIManager* Manager = Find(World);
+	if (Manager == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.bNoCollisionFail = true;
+		Manager = World->SpawnActor<AFVehicleAIManager>(SpawnParams);
+	}
+	return Manager;
+}
+
+void AFVehicleAIManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The controls are applied through the input calls, the managed vehicles have to tick after them
+	AFVehicleTickManager::Get(GetWorld())->AddTickPrerequisiteActor(this);
+}
+
+void AFVehicleAIManager::RegisterDriver(AFPawn* Vehicle, AFRacingLine* RacingLine, const FVehicleAIDriverParams& Params)
+{
+	check(Vehicle != nullptr);
+	UnregisterDriver(Vehicle);
+
+	Vehicles.Add(Vehicle);
+	RacingLines.Add(RacingLine);
+	Batch.Add(Params, (RacingLine != nullptr) ? &RacingLine->GetLine() : nullptr);
+	SpeedsKPH.Add(0.0f);
+
+	// Same for vehicles ticking themselves
+	Vehicle->AddTickPrerequisiteActor(this);
+}
+
+void AFVehicleAIManager::UnregisterDriver(AFPawn* Vehicle)
+{
+	for (int32 Index = 0; Index < Vehicles.Num(); ++Index)
+	{
+		if (Vehicles[Index].Get() == Vehicle)
+		{
+			Vehicle->RemoveTickPrerequisiteActor(this);
+			RemoveAt(Index);
+			return;
+		}
+	}
+}
+
+void AFVehicleAIManager::RemoveAt(int32 Index)
+{
+	Vehicles.RemoveAtSwap(Index);
+	RacingLines.RemoveAtSwap(Index);
+	Batch.RemoveAtSwap(Index);
+	SpeedsKPH.RemoveAtSwap(Index);
+}
+
+void AFVehicleAIManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Drop drivers whose car is gone, those without a line stay put until they get one
+	for (int32 Index = Vehicles.Num() - 1; Index >= 0; --Index)
+	{
+		if (Vehicles[Index].IsValid() == false)
+		{
+			RemoveAt(Index);
+		}
+		else if (RacingLines[Index].IsValid() == false)
+		{
+			Batch.Line[Index] = nullptr;
+		}
+	}
+
+	const int32 NumDrivers = Vehicles.Num();
+	if (NumDrivers == 0)
+	{
+		return;
+	}
+
+	// Read the cars on the game thread
+	for (int32 Index = 0; Index < NumDrivers; ++Index)
+	{
+		AFPawn* Vehicle = Vehicles[Index].Get();
+		const FTransform Transform = Vehicle->GetActorTransform();
+		Batch.Location[Index] = Transform.GetLocation();
+		Batch.Forward[Index] = Transform.GetUnitAxis(EAxis::X);
+		Batch.Right[Index] = Transform.GetUnitAxis(EAxis::Y);
+		Batch.Speed[Index] = Vehicle->GetVehicleMovementComponent()->GetForwardSpeed();
+		SpeedsKPH[Index] = FMath::Abs(Batch.Speed[Index]) * 0.036f;
+
+		// A line may still be empty if it began play after the controller possessed
+		AFRacingLine* RacingLine = RacingLines[Index].Get();
+		if ((RacingLine != nullptr) && (RacingLine->GetLine().Num() == 0))
+		{
+			RacingLine->BuildLine();
+		}
+	}
+
+	// Steering left at each speed, one table lookup pass per run of cars sharing a tuning
+	for (int32 RunStart = 0; RunStart < NumDrivers;)
+	{
+		const UFVehicleTuning* Tuning = Vehicles[RunStart]->GetTuning();
+		int32 RunEnd = RunStart + 1;
+		while ((RunEnd < NumDrivers) && (Vehicles[RunEnd]->GetTuning() == Tuning))
+		{
+			++RunEnd;
+		}
+		Tuning->GetSteeringScaleBatch(&SpeedsKPH[RunStart], &Batch.SteeringScale[RunStart], RunEnd - RunStart);
+		RunStart = RunEnd;
+	}
+
+	ComputeDrivers();
+
+	// Apply through the same calls as player input
+	for (int32 Index = 0; Index < NumDrivers; ++Index)
+	{
+		AFPawn* Vehicle = Vehicles[Index].Get();
+		Vehicle->MoveForward(Batch.Throttle[Index]);
+		Vehicle->MoveRight(Batch.Steering[Index]);
+		if (Batch.bHandbrake[Index] != 0)
+		{
+			Vehicle->OnHandbrakePressed();
+		}
+		else
+		{
+			Vehicle->OnHandbrakeReleased();
+		}
+	}
+}
+
+void AFVehicleAIManager::ComputeDrivers()
+{
+	const int32 NumDrivers = Batch.Num();
+	const int32 ChunkSize = FMath::Max(DriversPerTask, 1);
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumDrivers, ChunkSize);
+	if (NumChunks <= 1)
+	{
+		Batch.Compute(0, NumDrivers);
+		return;
+	}
+
+	// Hand all but the first range to the workers and do that one here
+	FGraphEventArray Tasks;
+	Tasks.Reserve(NumChunks - 1);
+	for (int32 Chunk = 1; Chunk < NumChunks; ++Chunk)
+	{
+		const int32 Start = Chunk * ChunkSize;
+		const int32 End = FMath::Min(Start + ChunkSize, NumDrivers);
+		Tasks.Add(TGraphTask<FVehicleAIDriverTask>::CreateTask().ConstructAndDispatchWhenReady(&Batch, Start, End));
+	}
+
+	Batch.Compute(0, FMath::Min(ChunkSize, NumDrivers));
+	FTaskGraphInterface::Get().WaitUntilTasksComplete(Tasks, ENamedThreads::GameThread);
+}
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "VehicleAIDriver.h"
+#include "FVehicleAIManager.generated.h"
+
+class AFPawn;
+class AFRacingLine;
+
+/**
+ * Drives every AI car in one batch per frame.
+ * The car state is read on the game thread, the controls are worked out for ranges of drivers
+ * on the task graph workers, and the results go back through the pawns' MoveForward/MoveRight
+ * and handbrake calls, the same path player input takes.
+ */
+UCLASS()
+class AFVehicleAIManager : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Drivers per task, fewer than this run on the game thread only */
+	UPROPERTY(Category = AI, EditAnywhere, BlueprintReadWrite)
+	int32 DriversPerTask;
+
+	/** The manager of a world, spawned on first use */
+	static AFVehicleAIManager* Get(UWorld* World);
+
+	/** The manager of a world if there is one */
+	static AFVehicleAIManager* Find(UWorld* World);
+
+	/** Start driving a vehicle along a racing line, it stays put while it has no line */
+	void RegisterDriver(AFPawn* Vehicle, AFRacingLine* RacingLine, const FVehicleAIDriverParams& Params);
+
+	void UnregisterDriver(AFPawn* Vehicle);
+
+	int32 GetNumDrivers() const { return Vehicles.Num(); }
+
+	// Begin Actor interface
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+	// End Actor interface
+
+private:
+	void RemoveAt(int32 Index);
+
+	/** Work out the controls of every driver, in parallel when there are enough */
+	void ComputeDrivers();
+
+	/** Driven vehicles, in the same order as the batch */
+	TArray<TWeakObjectPtr<AFPawn>> Vehicles;
+	TArray<TWeakObjectPtr<AFRacingLine>> RacingLines;
+	FVehicleAIDriverBatch Batch;
+
+	/** Speeds in km/h for the steering lookups */
+	TArray<float> SpeedsKPH;
+};
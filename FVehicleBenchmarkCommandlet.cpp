@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleBenchmarkCommandlet.h"
+#include "VehicleCore.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVehicleBenchmark, Log, All);
+
+namespace
+{
+	/** Forwards to the real allocator and counts allocations while a benchmark is measuring */
+	class FCountingMalloc : public FMalloc
+	{
+	public:
+		FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+			, NumAllocs(0)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			FPlatformAtomics::InterlockedIncrement(&NumAllocs);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				FPlatformAtomics::InterlockedIncrement(&NumAllocs);
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return TEXT("VehicleBenchmarkCounting");
+		}
+
+		FMalloc* Inner;
+		volatile int32 NumAllocs;
+	};
+
+	/** Value at a percentile of sorted samples */
+	double Percentile(const TArray<double>& Sorted, double Percent)
+	{
+		if (Sorted.Num() == 0)
+		{
+			return 0.0;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Percent / 100.0 * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	}
+
+	/** Drive one simulated vehicle: accelerate through the gears, brake, and roll over now and then */
+	void SimulateInput(FVehicleCoreInput& Input, int32 VehicleIndex, int32 Tick, float DeltaSeconds)
+	{
+		// Each car runs the same 20 second cycle with its own phase
+		const float CycleTime = FMath::Fmod((Tick + VehicleIndex * 37) * DeltaSeconds, 20.0f);
+		const float Speed = (CycleTime < 15.0f) ? CycleTime * 250.0f : (20.0f - CycleTime) * 750.0f;
+
+		Input.ForwardSpeed = (VehicleIndex % 8 == 0) ? -Speed * 0.2f : Speed;
+		Input.CurrentGear = (Input.ForwardSpeed < 0.0f) ? -1 : FMath::Clamp(FMath::FloorToInt(Speed / 800.0f), 0, 5);
+		Input.EngineMaxRotationSpeed = 5700.0f;
+		Input.EngineRotationSpeed = 1000.0f + FMath::Fmod(Speed, 800.0f) * 5.0f;
+		Input.UpZ = ((Tick + VehicleIndex) % 600 < 3) ? -0.5f : 1.0f;
+		Input.DeltaSeconds = DeltaSeconds;
+		// Crosses a slippery patch a wheel at a time every cycle
+		Input.NumWheels = 4;
+		Input.NumSlipperyWheels = FMath::Clamp(FMath::FloorToInt((CycleTime - 5.0f) * 4.0f), 0, 4) - FMath::Clamp(FMath::FloorToInt((CycleTime - 8.0f) * 4.0f), 0, 4);
+		Input.bInCarCameraActive = (VehicleIndex == 0);
+		Input.bHasLapTimer = true;
+		Input.LapTimeUs = (int64)Tick * (int64)(DeltaSeconds * 1000000.0f);
+		Input.BestLapUs = 0;
+	}
+}
+
+UFVehicleBenchmarkCommandlet::UFVehicleBenchmarkCommandlet(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	LogToConsole = true;
+}
+
+int32 UFVehicleBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 NumVehicles = 64;
+	int32 NumTicks = 10000;
+	float TickRate = 60.0f;
+	FParse::Value(*Params, TEXT("Vehicles="), NumVehicles);
+	FParse::Value(*Params, TEXT("Ticks="), NumTicks);
+	FParse::Value(*Params, TEXT("Hz="), TickRate);
+	NumVehicles = FMath::Max(NumVehicles, 1);
+	NumTicks = FMath::Max(NumTicks, 1);
+	const float DeltaSeconds = 1.0f / FMath::Max(TickRate, 1.0f);
+
+	FVehicleFrameContext Frame;
+	Frame.bHMDValid = FParse::Param(*Params, TEXT("HMD"));
+	Frame.bHeadTrackingAllowed = Frame.bHMDValid;
+	Frame.bStereoscopic3D = Frame.bHMDValid;
+	Frame.bStereoEnabled = Frame.bHMDValid;
+
+	TArray<FVehicleCore> Vehicles;
+	TArray<FVehicleCoreInput> Inputs;
+	TArray<FVehicleCoreOutput> Outputs;
+	Vehicles.Empty(NumVehicles);
+	for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+	{
+		Vehicles.Add(FVehicleCore());
+	}
+	Inputs.AddZeroed(NumVehicles);
+	Outputs.AddZeroed(NumVehicles);
+
+	TArray<double> NsPerVehicle;
+	NsPerVehicle.AddUninitialized(NumTicks);
+
+	// Warm up one simulated second so the shared HUD tables are built outside the measurement
+	const int32 NumWarmupTicks = FMath::CeilToInt(TickRate);
+	for (int32 Tick = -NumWarmupTicks; Tick < 0; ++Tick)
+	{
+		for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+		{
+			SimulateInput(Inputs[VehicleIndex], VehicleIndex, Tick + NumWarmupTicks, DeltaSeconds);
+			Vehicles[VehicleIndex].Tick(Inputs[VehicleIndex], Frame, Outputs[VehicleIndex]);
+		}
+	}
+
+	FCountingMalloc* CountingMalloc = new FCountingMalloc(GMalloc);
+	FMalloc* OriginalMalloc = GMalloc;
+	GMalloc = CountingMalloc;
+
+	int32 TotalAllocs = 0;
+	int32 MaxAllocs = 0;
+	for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+	{
+		for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+		{
+			SimulateInput(Inputs[VehicleIndex], VehicleIndex, Tick + NumWarmupTicks, DeltaSeconds);
+		}
+
+		const int32 AllocsBefore = CountingMalloc->NumAllocs;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+		{
+			Vehicles[VehicleIndex].Tick(Inputs[VehicleIndex], Frame, Outputs[VehicleIndex]);
+		}
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+		const int32 TickAllocs = CountingMalloc->NumAllocs - AllocsBefore;
+
+		NsPerVehicle[Tick] = FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1000000000.0 / NumVehicles;
+		TotalAllocs += TickAllocs;
+		MaxAllocs = FMath::Max(MaxAllocs, TickAllocs);
+	}
+
+	GMalloc = OriginalMalloc;
+	delete CountingMalloc;
+
+	double TotalNs = 0.0;
+	for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+	{
+		TotalNs += NsPerVehicle[Tick];
+	}
+	NsPerVehicle.Sort();
+
+	UE_LOG(LogVehicleBenchmark, Display, TEXT("Vehicle core benchmark: %d vehicles, %d ticks at %.0f Hz%s"), NumVehicles, NumTicks, TickRate, Frame.bHMDValid ? TEXT(", HMD") : TEXT(""));
+	UE_LOG(LogVehicleBenchmark, Display, TEXT("  ns/vehicle/tick  mean %.1f  p50 %.1f  p99 %.1f  max %.1f"),
+		TotalNs / NumTicks, Percentile(NsPerVehicle, 50.0), Percentile(NsPerVehicle, 99.0), NsPerVehicle.Last());
+	UE_LOG(LogVehicleBenchmark, Display, TEXT("  allocations/tick  mean %.2f  max %d"), (double)TotalAllocs / NumTicks, MaxAllocs);
+	return 0;
+}
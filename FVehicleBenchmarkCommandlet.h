@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "FVehicleBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs the engine independent vehicle tick (FVehicleCore) for a number of simulated vehicles at a
+ * fixed step and reports the cost. Needs no world, renderer or HMD.
+ *
+ *	UE4Editor-Cmd <Project> -run=FVehicleBenchmark -nullrhi [-Vehicles=64] [-Ticks=10000] [-Hz=60] [-HMD]
+ *
+ * Reports ns per vehicle per tick (mean, p50, p99) and heap allocations per tick.
+ */
+UCLASS()
+class UFVehicleBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+};
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleDashboardComponent.h"
+#include "VehicleProfiler.h"
+#include "VehicleStats.h"
+
+DEFINE_STAT(STAT_VehicleInCarRenderStates);
+
+const FName UFVehicleDashboardComponent::SpeedParameter("Speed");
+const FName UFVehicleDashboardComponent::GearParameter("Gear");
+const FName UFVehicleDashboardComponent::LapMinutesParameter("LapMinutes");
+const FName UFVehicleDashboardComponent::LapSecondsParameter("LapSeconds");
+const FName UFVehicleDashboardComponent::LapMilSecParameter("LapMilSec");
+const FName UFVehicleDashboardComponent::GearColorParameter("GearColor");
+
+namespace
+{
+	/** Render states created since the last flush, render states can be created off the game thread */
+	static FThreadSafeCounter PendingRenderStates;
+
+	/** Render states flushed since the start of the current one second window */
+	static uint32 RenderStatesInWindow = 0;
+	static double WindowStartTime = 0.0;
+
+	struct FDashboardStatsStartup
+	{
+		FDashboardStatsStartup()
+		{
+			FVehicleProfiler::OnEndFrame().AddStatic(&UFVehicleDashboardComponent::FlushRenderStateStats);
+		}
+	};
+
+	FDashboardStatsStartup DashboardStatsStartup;
+}
+
+UFVehicleDashboardComponent::UFVehicleDashboardComponent(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CastShadow = false;
+	bGenerateOverlapEvents = false;
+	DashboardInstance = nullptr;
+	Speed = INDEX_NONE;
+	Gear = INDEX_NONE;
+	LapMinutes = INDEX_NONE;
+	LapSeconds = INDEX_NONE;
+	LapMilSec = INDEX_NONE;
+	GearColor = FLinearColor::White;
+	NumParameterWrites = 0;
+}
+
+void UFVehicleDashboardComponent::SetDashboardMaterial(UMaterialInterface* Material)
+{
+	if (Material == nullptr)
+	{
+		DashboardInstance = nullptr;
+		return;
+	}
+
+	// Recreates the render state once, the parameter writes after it do not
+	DashboardInstance = UMaterialInstanceDynamic::Create(Material, this);
+	SetMaterial(0, DashboardInstance);
+	NumParameterWrites = 0;
+
+	DashboardInstance->SetScalarParameterValue(SpeedParameter, Speed);
+	DashboardInstance->SetScalarParameterValue(GearParameter, Gear);
+	DashboardInstance->SetScalarParameterValue(LapMinutesParameter, LapMinutes);
+	DashboardInstance->SetScalarParameterValue(LapSecondsParameter, LapSeconds);
+	DashboardInstance->SetScalarParameterValue(LapMilSecParameter, LapMilSec);
+	DashboardInstance->SetVectorParameterValue(GearColorParameter, GearColor);
+}
+
+void UFVehicleDashboardComponent::SetSpeed(int32 KPH)
+{
+	SetScalar(SpeedParameter, Speed, KPH);
+}
+
+void UFVehicleDashboardComponent::SetGear(int32 InGear)
+{
+	SetScalar(GearParameter, Gear, InGear);
+}
+
+void UFVehicleDashboardComponent::SetLapTime(int32 Minutes, int32 Seconds, int32 MilSec)
+{
+	SetScalar(LapMinutesParameter, LapMinutes, Minutes);
+	SetScalar(LapSecondsParameter, LapSeconds, Seconds);
+	SetScalar(LapMilSecParameter, LapMilSec, MilSec);
+}
+
+void UFVehicleDashboardComponent::SetGearColor(const FLinearColor& Color)
+{
+	if (Color == GearColor)
+	{
+		return;
+	}
+
+	GearColor = Color;
+	if (DashboardInstance != nullptr)
+	{
+		DashboardInstance->SetVectorParameterValue(GearColorParameter, Color);
+		++NumParameterWrites;
+	}
+}
+
+void UFVehicleDashboardComponent::SetScalar(const FName& Name, float& Current, float Value)
+{
+	if (Value == Current)
+	{
+		return;
+	}
+
+	Current = Value;
+	if (DashboardInstance != nullptr)
+	{
+		DashboardInstance->SetScalarParameterValue(Name, Value);
+		++NumParameterWrites;
+	}
+}
+
+void UFVehicleDashboardComponent::CreateRenderState_Concurrent()
+{
+	Super::CreateRenderState_Concurrent();
+
+	NoteRenderStateCreated();
+}
+
+void UFVehicleDashboardComponent::NoteRenderStateCreated()
+{
+	PendingRenderStates.Increment();
+}
+
+void UFVehicleDashboardComponent::FlushRenderStateStats()
+{
+	check(IsInGameThread());
+
+	const int32 NumCreated = PendingRenderStates.Reset();
+	RenderStatesInWindow += NumCreated;
+	FVehicleProfiler::Get().AddCount(FVehicleProfiler::InCarRenderStates, NumCreated);
+
+	const double Now = FApp::GetCurrentTime();
+	if (Now - WindowStartTime >= 1.0)
+	{
+		SET_DWORD_STAT(STAT_VehicleInCarRenderStates, RenderStatesInWindow);
+		RenderStatesInWindow = 0;
+		WindowStartTime = Now;
+	}
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/StaticMeshComponent.h"
+#include "FVehicleDashboardComponent.generated.h"
+
+class UMaterialInstanceDynamic;
+
+/**
+ * In-car digital display drawn by one material from a glyph atlas. Speed, gear, lap time and the
+ * gear color are material parameters, so a changed value is a parameter write on the dynamic
+ * instance. Text render components rebuild their mesh and render state on every change instead.
+ */
+UCLASS(ClassGroup=Vehicle, meta=(BlueprintSpawnableComponent))
+class UFVehicleDashboardComponent : public UStaticMeshComponent
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Scalar parameters read by the dashboard material, whole numbers */
+	static const FName SpeedParameter;
+	/** -1 in reverse, 0 in neutral */
+	static const FName GearParameter;
+	static const FName LapMinutesParameter;
+	static const FName LapSecondsParameter;
+	static const FName LapMilSecParameter;
+	/** Vector parameter */
+	static const FName GearColorParameter;
+
+	/** Draw with a dynamic instance of a dashboard material, every value is written to it again */
+	UFUNCTION(Category = Dashboard, BlueprintCallable)
+	void SetDashboardMaterial(UMaterialInterface* Material);
+
+	UFUNCTION(Category = Dashboard, BlueprintCallable)
+	void SetSpeed(int32 KPH);
+
+	UFUNCTION(Category = Dashboard, BlueprintCallable)
+	void SetGear(int32 Gear);
+
+	UFUNCTION(Category = Dashboard, BlueprintCallable)
+	void SetLapTime(int32 Minutes, int32 Seconds, int32 MilSec);
+
+	UFUNCTION(Category = Dashboard, BlueprintCallable)
+	void SetGearColor(const FLinearColor& Color);
+
+	/** Parameters written since the material was set, unchanged values are not written */
+	UFUNCTION(Category = Dashboard, BlueprintCallable)
+	int32 GetNumParameterWrites() const { return NumParameterWrites; }
+
+	/** Count an in-car display render state (re)creation, safe from any thread */
+	static void NoteRenderStateCreated();
+
+	/** Report the counted render states, from FVehicleProfiler::OnEndFrame, per second in STAT_VehicleInCarRenderStates */
+	static void FlushRenderStateStats();
+
+protected:
+	// Begin ActorComponent interface
+	virtual void CreateRenderState_Concurrent() override;
+	// End ActorComponent interface
+
+private:
+	/** Write a scalar parameter if it changed */
+	void SetScalar(const FName& Name, float& Current, float Value);
+
+	UPROPERTY(Transient)
+	UMaterialInstanceDynamic* DashboardInstance;
+
+	/** Values last written to the instance */
+	float Speed;
+	float Gear;
+	float LapMinutes;
+	float LapSeconds;
+	float LapMilSec;
+	FLinearColor GearColor;
+
+	int32 NumParameterWrites;
+};
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleInCarTextComponent.h"
+#include "FVehicleDashboardComponent.h"
+
+UFVehicleInCarTextComponent::UFVehicleInCarTextComponent(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+}
+
+void UFVehicleInCarTextComponent::CreateRenderState_Concurrent()
+{
+	Super::CreateRenderState_Concurrent();
+
+	UFVehicleDashboardComponent::NoteRenderStateCreated();
+}
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/TextRenderComponent.h"
+#include "FVehicleInCarTextComponent.generated.h"
+
+/**
+ * Text render component for the in-car displays. Counts its render state (re)creations with the
+ * dashboard's, so both ways of drawing the in-car values are measured at the same place.
+ */
+UCLASS(ClassGroup=Vehicle, meta=(BlueprintSpawnableComponent))
+class UFVehicleInCarTextComponent : public UTextRenderComponent
+{
+	GENERATED_UCLASS_BODY()
+
+protected:
+	// Begin ActorComponent interface
+	virtual void CreateRenderState_Concurrent() override;
+	// End ActorComponent interface
+};
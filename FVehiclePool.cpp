@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehiclePool.h"
+#include "FPawn.h"
+#include "FVehicleTickManager.h"
+#include "VehicleStats.h"
+
+DEFINE_STAT(STAT_VehiclePoolAcquire);
+
+DEFINE_LOG_CATEGORY_STATIC(LogVehiclePool, Log, All);
+
+AFVehiclePool::AFVehiclePool(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	PoolClass = AFPawn::StaticClass();
+	PrewarmCount = 0;
+	DormantLocation = FVector(0.0f, 0.0f, -100000.0f);
+	PoolSize = 0;
+	PoolAllocations = 0;
+	NumAcquires = 0;
+	TotalAcquireTime = 0.0;
+	MaxAcquireTime = 0.0;
+	TotalMissTime = 0.0;
+	PrewarmTime = 0.0;
+}
+
+AFVehiclePool* AFVehiclePool::Find(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AFVehiclePool> It(World); It; ++It)
+	{
+		if (It->IsPendingKill() == false)
+		{
+			return *It;
+		}
+	}
+	return nullptr;
+}
+
+AFVehiclePool* AFVehiclePool::Get(UWorld* World)
+{
+	check(World != nullptr);
+	AFVehiclePool* Pool = Find(World);
+	if (Pool == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.bNoCollisionFail = true;
+		Pool = World->SpawnActor<AFVehiclePool>(SpawnParams);
+	}
+	return Pool;
+}
+
+void AFVehiclePool::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Placed in the level, the vehicles are spawned with it while the level loads
+	PrewarmPool(PrewarmCount);
+}
+
+void AFVehiclePool::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	LogStats();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AFVehiclePool::PrewarmPool(int32 Count)
+{
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	FreePool.Reserve(PoolSize + Count);
+	UsedPool.Reserve(PoolSize + Count);
+	AFVehicleTickManager::Get(GetWorld())->ReserveVehicles(Count);
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		AFPawn* Vehicle = SpawnPooledVehicle();
+		if (Vehicle != nullptr)
+		{
+			FreePool.Add(Vehicle);
+		}
+	}
+	PrewarmTime += FPlatformTime::Seconds() - StartTime;
+}
+
+AFPawn* AFVehiclePool::AcquireVehicle(const FVector& Location, const FRotator& Rotation, AController* Controller)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VehiclePoolAcquire);
+	const double StartTime = FPlatformTime::Seconds();
+
+	AFPawn* Vehicle = nullptr;
+	while ((Vehicle == nullptr) && (FreePool.Num() > 0))
+	{
+		// Destroyed by someone else while parked
+		Vehicle = FreePool.Pop();
+		if ((Vehicle != nullptr) && (Vehicle->IsPendingKill() == true))
+		{
+			Vehicle = nullptr;
+			--PoolSize;
+		}
+	}
+
+	if (Vehicle == nullptr)
+	{
+		Vehicle = SpawnPooledVehicle();
+		if (Vehicle == nullptr)
+		{
+			return nullptr;
+		}
+		++PoolAllocations;
+		TotalMissTime += FPlatformTime::Seconds() - StartTime;
+		UE_LOG(LogVehiclePool, Warning, TEXT("Vehicle pool empty, spawned %s (%d spawned during play)"), *Vehicle->GetName(), PoolAllocations);
+	}
+
+	UsedPool.Add(Vehicle);
+	Vehicle->SetActorLocationAndRotation(Location, Rotation);
+	Vehicle->ResetVehicleState();
+	Vehicle->SetDormant(false);
+	if (Controller != nullptr)
+	{
+		Controller->Possess(Vehicle);
+	}
+
+	const double AcquireTime = FPlatformTime::Seconds() - StartTime;
+	++NumAcquires;
+	TotalAcquireTime += AcquireTime;
+	MaxAcquireTime = FMath::Max(MaxAcquireTime, AcquireTime);
+	return Vehicle;
+}
+
+void AFVehiclePool::ReleaseVehicle(AFPawn* Vehicle)
+{
+	if ((Vehicle == nullptr) || (UsedPool.RemoveSingleSwap(Vehicle) == 0))
+	{
+		return;
+	}
+
+	if (Vehicle->Controller != nullptr)
+	{
+		Vehicle->Controller->UnPossess();
+	}
+	Vehicle->SetDormant(true);
+	Vehicle->SetActorLocation(DormantLocation);
+	FreePool.Add(Vehicle);
+}
+
+void AFVehiclePool::LogStats() const
+{
+	UE_LOG(LogVehiclePool, Log, TEXT("Vehicle pool: %d vehicles, %d free, %d spawned during play, prewarm %.1f ms"), PoolSize, FreePool.Num(), PoolAllocations, PrewarmTime * 1000.0);
+	if (NumAcquires > 0)
+	{
+		UE_LOG(LogVehiclePool, Log, TEXT("  acquire: %d, avg %.3f ms, max %.3f ms, %.1f ms spawning on pool misses"),
+			NumAcquires, TotalAcquireTime * 1000.0 / NumAcquires, MaxAcquireTime * 1000.0, TotalMissTime * 1000.0);
+	}
+}
+
+AFPawn* AFVehiclePool::SpawnPooledVehicle()
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bNoCollisionFail = true;
+	AFPawn* Vehicle = GetWorld()->SpawnActor<AFPawn>(PoolClass, DormantLocation, FRotator::ZeroRotator, SpawnParams);
+	if (Vehicle == nullptr)
+	{
+		return nullptr;
+	}
+	++PoolSize;
+
+	// BeginPlay registered it with the managers, pooled vehicles only join them when acquired
+	Vehicle->SetDormant(true);
+	return Vehicle;
+}
+
+namespace
+{
+	void LogPoolStats(UWorld* World)
+	{
+		AFVehiclePool* Pool = AFVehiclePool::Find(World);
+		if (Pool == nullptr)
+		{
+			UE_LOG(LogVehiclePool, Display, TEXT("No vehicle pool"));
+			return;
+		}
+		Pool->LogStats();
+	}
+
+	FAutoConsoleCommandWithWorld PoolStatsCommand(
+		TEXT("Vehicle.Pool.Stats"),
+		TEXT("Log the vehicle pool size and the time spent acquiring vehicles"),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&LogPoolStats));
+}
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "FVehiclePool.generated.h"
+
+class AFPawn;
+
+/**
+ * Vehicles spawned while the level loads and parked dormant until they are needed. Acquiring one
+ * moves it into place and resets it instead of spawning, so respawns and grid filling do not pay
+ * for actor, component and physics creation during play. Released vehicles go back to the pool
+ * instead of being destroyed.
+ */
+UCLASS()
+class AFVehiclePool : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Vehicle spawned by the pool */
+	UPROPERTY(Category = Pool, EditAnywhere, BlueprintReadWrite)
+	TSubclassOf<AFPawn> PoolClass;
+
+	/** Vehicles spawned in BeginPlay, set on a pool placed in the level so they are spawned while it loads */
+	UPROPERTY(Category = Pool, EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	int32 PrewarmCount;
+
+	/** Where dormant vehicles are parked, out of sight and away from the track */
+	UPROPERTY(Category = Pool, EditAnywhere, BlueprintReadOnly)
+	FVector DormantLocation;
+
+	/** The pool of a world, spawned on first use */
+	static AFVehiclePool* Get(UWorld* World);
+
+	/** The pool of a world if there is one */
+	static AFVehiclePool* Find(UWorld* World);
+
+	/** Spawn dormant vehicles up front so the pool does not have to during play */
+	UFUNCTION(Category = Pool, BlueprintCallable)
+	void PrewarmPool(int32 Count);
+
+	/**
+	 * Place a vehicle from the pool, only spawns when the pool is empty.
+	 *
+	 * @param	Location	where to put it
+	 * @param	Rotation	which way it faces
+	 * @param	Controller	optional controller to possess it
+	 */
+	UFUNCTION(Category = Pool, BlueprintCallable)
+	AFPawn* AcquireVehicle(const FVector& Location, const FRotator& Rotation, AController* Controller = nullptr);
+
+	/** Take a vehicle out of play and back into the pool, its controller is left unpossessed */
+	UFUNCTION(Category = Pool, BlueprintCallable)
+	void ReleaseVehicle(AFPawn* Vehicle);
+
+	/** Vehicles created by the pool, in use or not */
+	UFUNCTION(Category = Pool, BlueprintCallable)
+	int32 GetPoolSize() const { return PoolSize; }
+
+	/** Vehicles spawned because the pool was empty, should stay 0 during a race */
+	UFUNCTION(Category = Pool, BlueprintCallable)
+	int32 GetPoolAllocations() const { return PoolAllocations; }
+
+	UFUNCTION(Category = Pool, BlueprintCallable)
+	int32 GetNumFreeInPool() const { return FreePool.Num(); }
+
+	/** Log pool size and the time spent in the spawn path */
+	void LogStats() const;
+
+	// Begin Actor interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End Actor interface
+
+private:
+	/** Spawn a vehicle at the dormant location and park it */
+	AFPawn* SpawnPooledVehicle();
+
+	UPROPERTY(Transient)
+	TArray<AFPawn*> FreePool;
+
+	UPROPERTY(Transient)
+	TArray<AFPawn*> UsedPool;
+
+	int32 PoolSize;
+	int32 PoolAllocations;
+
+	/** Spawn path timings in seconds */
+	int32 NumAcquires;
+	double TotalAcquireTime;
+	double MaxAcquireTime;
+	double TotalMissTime;
+	double PrewarmTime;
+};
@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleSignificanceManager.h"
+#include "FPawn.h"
+#include "VehicleStats.h"
+
+DEFINE_STAT(STAT_VehicleSignificance);
+DEFINE_STAT(STAT_VehicleSignificanceChanges);
+
+AFVehicleSignificanceManager::AFVehicleSignificanceManager(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	// Before the vehicles tick, so they run at the rates picked this frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	MediumScreenSize = 0.25f;
+	LowScreenSize = 0.08f;
+	ProxyScreenSize = 0.025f;
+	Hysteresis = 0.2f;
+	BehindViewScale = 0.25f;
+
+	TierRateScales[EVehicleSignificance::High] = 1.0f;
+	TierRateScales[EVehicleSignificance::Medium] = 0.5f;
+	TierRateScales[EVehicleSignificance::Low] = 0.25f;
+	TierRateScales[EVehicleSignificance::Proxy] = 0.1f;
+}
+
+AFVehicleSignificanceManager* AFVehicleSignificanceManager::Find(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AFVehicleSignificanceManager> It(World); It; ++It)
+	{
+		if (It->IsPendingKill() == false)
+		{
+			return *It;
+		}
+	}
+	return nullptr;
+}
+
+AFVehicleSignificanceManager* AFVehicleSignificanceManager::Get(UWorld* World)
+{
+	AFVehicleSignificanceManager* Manager = Find(World);
+	if (Manager == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.bNoCollisionFail = true;
+		Manager = World->SpawnActor<AFVehicleSignificanceManager>(SpawnParams);
+	}
+	return Manager;
+}
+
+void AFVehicleSignificanceManager::RegisterVehicle(AFPawn* Vehicle)
+{
+	check(Vehicle != nullptr);
+	for (const TWeakObjectPtr<AFPawn>& Existing : Vehicles)
+	{
+		if (Existing.Get() == Vehicle)
+		{
+			return;
+		}
+	}
+
+	// Everyone starts at full detail and is scored down on the next tick
+	Vehicles.Add(Vehicle);
+	Tiers.Add(EVehicleSignificance::High);
+}
+
+void AFVehicleSignificanceManager::UnregisterVehicle(AFPawn* Vehicle)
+{
+	for (int32 Index = 0; Index < Vehicles.Num(); ++Index)
+	{
+		if (Vehicles[Index].Get() == Vehicle)
+		{
+			RemoveAt(Index);
+			return;
+		}
+	}
+}
+
+void AFVehicleSignificanceManager::RemoveAt(int32 Index)
+{
+	Vehicles.RemoveAtSwap(Index);
+	Tiers.RemoveAtSwap(Index);
+}
+
+int32 AFVehicleSignificanceManager::GetNumInTier(EVehicleSignificance::Type Tier) const
+{
+	int32 Count = 0;
+	for (const TEnumAsByte<EVehicleSignificance::Type>& VehicleTier : Tiers)
+	{
+		if (VehicleTier == Tier)
+		{
+			++Count;
+		}
+	}
+	return Count;
+}
+
+float AFVehicleSignificanceManager::GetTierThreshold(int32 Tier) const
+{
+	switch (Tier)
+	{
+	case EVehicleSignificance::High:
+		return MediumScreenSize;
+	case EVehicleSignificance::Medium:
+		return LowScreenSize;
+	case EVehicleSignificance::Low:
+		return ProxyScreenSize;
+	default:
+		return 0.0f;
+	}
+}
+
+EVehicleSignificance::Type AFVehicleSignificanceManager::PickTier(float Score, EVehicleSignificance::Type Current) const
+{
+	// Down a tier when clearly below the current tier's bound
+	int32 Tier = Current;
+	while ((Tier < EVehicleSignificance::Proxy) && (Score < GetTierThreshold(Tier) * (1.0f - Hysteresis)))
+	{
+		++Tier;
+	}
+	// Up a tier when clearly above the bound of the tier above
+	while ((Tier > EVehicleSignificance::High) && (Score > GetTierThreshold(Tier - 1) * (1.0f + Hysteresis)))
+	{
+		--Tier;
+	}
+	return (EVehicleSignificance::Type)Tier;
+}
+
+void AFVehicleSignificanceManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VehicleSignificance);
+
+	Super::Tick(DeltaSeconds);
+
+	for (int32 Index = Vehicles.Num() - 1; Index >= 0; --Index)
+	{
+		if (Vehicles[Index].IsValid() == false)
+		{
+			RemoveAt(Index);
+		}
+	}
+
+	// The local view, without one everything stays as it is
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if ((PlayerController == nullptr) || (PlayerController->PlayerCameraManager == nullptr))
+	{
+		return;
+	}
+	const FVector ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	const FVector ViewDirection = PlayerController->PlayerCameraManager->GetCameraRotation().Vector();
+	const float HalfFOV = FMath::DegreesToRadians(FMath::Clamp(PlayerController->PlayerCameraManager->GetFOVAngle(), 10.0f, 170.0f) * 0.5f);
+	const float InvTanHalfFOV = 1.0f / FMath::Tan(HalfFOV);
+	const APawn* ViewPawn = PlayerController->GetPawn();
+
+	for (int32 Index = 0; Index < Vehicles.Num(); ++Index)
+	{
+		AFPawn* Vehicle = Vehicles[Index].Get();
+
+		EVehicleSignificance::Type Tier = EVehicleSignificance::High;
+		if (Vehicle != ViewPawn)
+		{
+			// Share of the view the bounding sphere covers
+			const FBoxSphereBounds& Bounds = Vehicle->Mesh->Bounds;
+			const FVector ToVehicle = Bounds.Origin - ViewLocation;
+			const float Distance = FMath::Max(ToVehicle.Size(), 1.0f);
+			float Score = Bounds.SphereRadius * InvTanHalfFOV / Distance;
+			if (FVector::DotProduct(ToVehicle, ViewDirection) < -Bounds.SphereRadius)
+			{
+				Score *= BehindViewScale;
+			}
+			Tier = PickTier(Score, Tiers[Index]);
+		}
+
+		if (Tier != Tiers[Index])
+		{
+			Tiers[Index] = Tier;
+			Vehicle->SetSignificance(Tier, TierRateScales[Tier]);
+			INC_DWORD_STAT(STAT_VehicleSignificanceChanges);
+		}
+	}
+}
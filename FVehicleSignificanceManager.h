@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "FVehicleSignificanceManager.generated.h"
+
+class AFPawn;
+
+/** How much of a vehicle is worth updating, from most to least */
+UENUM(BlueprintType)
+namespace EVehicleSignificance
+{
+	enum Type
+	{
+		/** Everything at full rate */
+		High,
+		/** Subsystems at half rate, in-car text hidden */
+		Medium,
+		/** Quarter rate, animation paused */
+		Low,
+		/** Proxy static mesh instead of the skeletal mesh, engine sound stopped */
+		Proxy,
+		Num UMETA(Hidden),
+	};
+}
+
+/**
+ * Scores every registered vehicle by its size on screen from the local view and moves it between
+ * significance tiers. A vehicle has to score clearly past a threshold before it changes tier, so
+ * cars at a tier boundary do not flicker between the two.
+ */
+UCLASS()
+class AFVehicleSignificanceManager : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Share of the view height a car has to cover to stay at each tier (Medium, Low, Proxy) */
+	UPROPERTY(Category = Significance, EditAnywhere, BlueprintReadOnly)
+	float MediumScreenSize;
+
+	UPROPERTY(Category = Significance, EditAnywhere, BlueprintReadOnly)
+	float LowScreenSize;
+
+	UPROPERTY(Category = Significance, EditAnywhere, BlueprintReadOnly)
+	float ProxyScreenSize;
+
+	/** How far past a threshold a score has to go to change tier, as a share of the threshold */
+	UPROPERTY(Category = Significance, EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	float Hysteresis;
+
+	/** Score multiplier for cars behind the view */
+	UPROPERTY(Category = Significance, EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0", ClampMax = "1"))
+	float BehindViewScale;
+
+	/** Subsystem rate scale of each tier */
+	UPROPERTY(Category = Significance, EditAnywhere, BlueprintReadOnly)
+	float TierRateScales[EVehicleSignificance::Num];
+
+	/** The manager of a world, spawned on first use */
+	static AFVehicleSignificanceManager* Get(UWorld* World);
+
+	/** The manager of a world if there is one */
+	static AFVehicleSignificanceManager* Find(UWorld* World);
+
+	void RegisterVehicle(AFPawn* Vehicle);
+
+	void UnregisterVehicle(AFPawn* Vehicle);
+
+	/** Vehicles in a tier */
+	int32 GetNumInTier(EVehicleSignificance::Type Tier) const;
+
+	// Begin Actor interface
+	virtual void Tick(float DeltaSeconds) override;
+	// End Actor interface
+
+private:
+	/** Tier for a score, staying in the current one unless the score is clearly past its bounds */
+	EVehicleSignificance::Type PickTier(float Score, EVehicleSignificance::Type Current) const;
+
+	/** Screen size of a tier's lower bound, 0 for the last tier */
+	float GetTierThreshold(int32 Tier) const;
+
+	void RemoveAt(int32 Index);
+
+	TArray<TWeakObjectPtr<AFPawn>> Vehicles;
+	TArray<TEnumAsByte<EVehicleSignificance::Type>> Tiers;
+};
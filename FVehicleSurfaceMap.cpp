@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleSurfaceMap.h"
+#include "FPawn.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVehicleSurface, Log, All);
+
+UFVehicleSurfaceMap::UFVehicleSurfaceMap(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	Origin = FVector2D(-50000.0f, -50000.0f);
+	CellSize = 100.0f;
+	SizeX = 1000;
+	SizeY = 1000;
+	DefaultSurface = EVehicleSurface::Grip;
+	SlipperyFriction = 0.5f;
+	BakeTraceHeight = 100000.0f;
+
+	const FVehicleFrictionHysteresis DefaultHysteresis;
+	EnterSlipperyWheels = DefaultHysteresis.EnterWheels;
+	ExitSlipperyWheels = DefaultHysteresis.ExitWheels;
+	HoldTime = DefaultHysteresis.HoldTime;
+
+	InvCellSize = 1.0f / CellSize;
+}
+
+void UFVehicleSurfaceMap::PostInitProperties()
+{
+	Super::PostInitProperties();
+	InvCellSize = 1.0f / FMath::Max(CellSize, 1.0f);
+}
+
+void UFVehicleSurfaceMap::PostLoad()
+{
+	Super::PostLoad();
+	InvCellSize = 1.0f / FMath::Max(CellSize, 1.0f);
+}
+
+#if WITH_EDITOR
+void UFVehicleSurfaceMap::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	InvCellSize = 1.0f / FMath::Max(CellSize, 1.0f);
+}
+#endif
+
+int32 UFVehicleSurfaceMap::CountSlipperyWheels(const FTransform& ActorTransform, const FVector* WheelOffsets, int32 NumWheels) const
+{
+	int32 NumSlippery = 0;
+	for (int32 WheelIndex = 0; WheelIndex < NumWheels; ++WheelIndex)
+	{
+		if (GetSurface(ActorTransform.TransformPosition(WheelOffsets[WheelIndex])) == EVehicleSurface::Slippery)
+		{
+			++NumSlippery;
+		}
+	}
+	return NumSlippery;
+}
+
+FVehicleFrictionHysteresis UFVehicleSurfaceMap::GetFrictionHysteresis() const
+{
+	FVehicleFrictionHysteresis Hysteresis;
+	Hysteresis.EnterWheels = EnterSlipperyWheels;
+	Hysteresis.ExitWheels = FMath::Min(ExitSlipperyWheels, EnterSlipperyWheels - 1);
+	Hysteresis.HoldTime = HoldTime;
+	return Hysteresis;
+}
+
+int32 UFVehicleSurfaceMap::Bake(UWorld* World)
+{
+	check(World != nullptr);
+
+	Cells.Init(DefaultSurface, SizeX * SizeY);
+
+	// Only the ground, ignore anything that moves
+	FCollisionQueryParams Params(FName(TEXT("VehicleSurfaceBake")), false);
+	Params.bReturnPhysicalMaterial = true;
+	for (TActorIterator<APawn> It(World); It; ++It)
+	{
+		Params.AddIgnoredActor(*It);
+	}
+
+	int32 NumSlippery = 0;
+	for (int32 CellY = 0; CellY < SizeY; ++CellY)
+	{
+		for (int32 CellX = 0; CellX < SizeX; ++CellX)
+		{
+			const float X = Origin.X + (CellX + 0.5f) * CellSize;
+			const float Y = Origin.Y + (CellY + 0.5f) * CellSize;
+
+			FHitResult Hit;
+			if (World->LineTraceSingle(Hit, FVector(X, Y, BakeTraceHeight), FVector(X, Y, -BakeTraceHeight), ECC_Visibility, Params) == false)
+			{
+				continue;
+			}
+
+			const UPhysicalMaterial* PhysMaterial = Hit.PhysMaterial.Get();
+			if ((PhysMaterial != nullptr) && (PhysMaterial->Friction < SlipperyFriction))
+			{
+				Cells[CellY * SizeX + CellX] = EVehicleSurface::Slippery;
+				++NumSlippery;
+			}
+		}
+	}
+
+	MarkPackageDirty();
+	UE_LOG(LogVehicleSurface, Log, TEXT("Baked %s: %d x %d cells, %d slippery"), *GetName(), SizeX, SizeY, NumSlippery);
+	return Cells.Num();
+}
+
+namespace
+{
+	/** Vehicle.SurfaceMap.Bake: bake the surface maps used by the vehicles in the world */
+	void BakeSurfaceMaps(UWorld* World)
+	{
+		TArray<UFVehicleSurfaceMap*> Baked;
+		for (TActorIterator<AFPawn> It(World); It; ++It)
+		{
+			UFVehicleSurfaceMap* SurfaceMap = It->SurfaceMap;
+			if ((SurfaceMap != nullptr) && (Baked.Contains(SurfaceMap) == false))
+			{
+				SurfaceMap->Bake(World);
+				Baked.Add(SurfaceMap);
+			}
+		}
+
+		if (Baked.Num() == 0)
+		{
+			UE_LOG(LogVehicleSurface, Warning, TEXT("No vehicle in the level uses a surface map"));
+		}
+	}
+
+	FAutoConsoleCommandWithWorld BakeSurfaceMapsCommand(
+		TEXT("Vehicle.SurfaceMap.Bake"),
+		TEXT("Bake the surface maps used by the vehicles in the level, save the assets afterwards"),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&BakeSurfaceMaps));
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "VehicleCore.h"
+#include "FVehicleSurfaceMap.generated.h"
+
+UENUM(BlueprintType)
+namespace EVehicleSurface
+{
+	enum Type
+	{
+		Grip,
+		Slippery,
+	};
+}
+
+/**
+ * Surface type of a track baked into a 2D grid, so the vehicles can look up what their wheels
+ * are on without tracing every frame.
+ * Set Origin, CellSize and the size to cover the track, then run Vehicle.SurfaceMap.Bake in the
+ * editor with the level open and save the asset.
+ */
+UCLASS(BlueprintType)
+class UFVehicleSurfaceMap : public UDataAsset
+{
+	GENERATED_UCLASS_BODY()
+
+	/** World XY of the corner of cell (0, 0) */
+	UPROPERTY(Category = Grid, EditAnywhere)
+	FVector2D Origin;
+
+	UPROPERTY(Category = Grid, EditAnywhere, meta=(ClampMin = "10.0"))
+	float CellSize;
+
+	UPROPERTY(Category = Grid, EditAnywhere, meta=(ClampMin = "1"))
+	int32 SizeX;
+
+	UPROPERTY(Category = Grid, EditAnywhere, meta=(ClampMin = "1"))
+	int32 SizeY;
+
+	/** Surface outside the grid */
+	UPROPERTY(Category = Grid, EditAnywhere)
+	TEnumAsByte<EVehicleSurface::Type> DefaultSurface;
+
+	/** Ground with a physical material friction below this bakes as slippery */
+	UPROPERTY(Category = Bake, EditAnywhere)
+	float SlipperyFriction;
+
+	/** Traces start this far above and end this far below Z = 0 */
+	UPROPERTY(Category = Bake, EditAnywhere)
+	float BakeTraceHeight;
+
+	/** Go slippery when at least this many wheels are on a slippery surface */
+	UPROPERTY(Category = Friction, EditAnywhere)
+	int32 EnterSlipperyWheels;
+
+	/** Back to grip when at most this many wheels are */
+	UPROPERTY(Category = Friction, EditAnywhere)
+	int32 ExitSlipperyWheels;
+
+	/** How long the new surface has to hold before the material is switched */
+	UPROPERTY(Category = Friction, EditAnywhere)
+	float HoldTime;
+
+	/** One EVehicleSurface per cell, row major in X */
+	UPROPERTY()
+	TArray<uint8> Cells;
+
+	/** Surface at a world location */
+	FORCEINLINE EVehicleSurface::Type GetSurface(const FVector& Location) const
+	{
+		const int32 CellX = FMath::FloorToInt((Location.X - Origin.X) * InvCellSize);
+		const int32 CellY = FMath::FloorToInt((Location.Y - Origin.Y) * InvCellSize);
+		if ((CellX < 0) || (CellY < 0) || (CellX >= SizeX) || (CellY >= SizeY) || (Cells.Num() != SizeX * SizeY))
+		{
+			return DefaultSurface;
+		}
+		return (EVehicleSurface::Type)Cells[CellY * SizeX + CellX];
+	}
+
+	/**
+	 * Count the wheels on a slippery surface.
+	 *
+	 * @param	ActorTransform	transform of the vehicle
+	 * @param	WheelOffsets	wheel contact points relative to the vehicle
+	 */
+	int32 CountSlipperyWheels(const FTransform& ActorTransform, const FVector* WheelOffsets, int32 NumWheels) const;
+
+	/** Hysteresis for FVehicleCore */
+	FVehicleFrictionHysteresis GetFrictionHysteresis() const;
+
+	/** Trace down at the centre of each cell and store the surface found, returns the cells baked */
+	int32 Bake(UWorld* World);
+
+	// Begin UObject interface
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	// End UObject interface
+
+private:
+	float InvCellSize;
+};
@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleTickManager.h"
+#include "FPawn.h"
+#include "VehicleStats.h"
+#include "VehicleProfiler.h"
+
+DEFINE_STAT(STAT_VehicleTickManager);
+DEFINE_STAT(STAT_VehicleSimCost);
+
+namespace
+{
+	/** Simulation cost of the current frame, and since the start of the current one second window */
+	static double CostInFrame = 0.0;
+	static double SimulatedInFrame = 0.0;
+	static double CostInWindow = 0.0;
+	static double SimulatedInWindow = 0.0;
+	static double WindowStartTime = 0.0;
+
+	struct FSimulationStatsStartup
+	{
+		FSimulationStatsStartup()
+		{
+			FVehicleProfiler::OnEndFrame().AddStatic(&AFVehicleTickManager::FlushSimulationStats);
+		}
+	};
+
+	FSimulationStatsStartup SimulationStatsStartup;
+}
+
+AFVehicleTickManager::AFVehicleTickManager(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	// Same group the pawns tick in on their own
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+}
+
+AFVehicleTickManager* AFVehicleTickManager::Find(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AFVehicleTickManager> It(World); It; ++It)
+	{
+		if (It->IsPendingKill() == false)
+		{
+			return *It;
+		}
+	}
+	return nullptr;
+}
+
+AFVehicleTickManager* AFVehicleTickManager::Get(UWorld* World)
+{
+	AFVehicleTickManager* Manager = Find(World);
+	if (Manager == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.bNoCollisionFail = true;
+		Manager = World->SpawnActor<AFVehicleTickManager>(SpawnParams);
+	}
+	return Manager;
+}
+
+void AFVehicleTickManager::RegisterVehicle(AFPawn* Vehicle)
+{
+	check(Vehicle != nullptr);
+	for (const TWeakObjectPtr<AFPawn>& Existing : Vehicles)
+	{
+		if (Existing.Get() == Vehicle)
+		{
+			return;
+		}
+	}
+
+	Vehicles.Add(Vehicle);
+	Cores.Add(&Vehicle->GetVehicleCore());
+	Batch.Add();
+	Outputs.AddZeroed();
+
+	Vehicle->SetActorTickEnabled(false);
+}
+
+void AFVehicleTickManager::ReserveVehicles(int32 NumAdditional)
+{
+	const int32 NumVehicles = Vehicles.Num() + NumAdditional;
+	Vehicles.Reserve(NumVehicles);
+	Cores.Reserve(NumVehicles);
+	Batch.Reserve(NumVehicles);
+	Outputs.Reserve(NumVehicles);
+}
+
+void AFVehicleTickManager::UnregisterVehicle(AFPawn* Vehicle)
+{
+	for (int32 Index = 0; Index < Vehicles.Num(); ++Index)
+	{
+		if (Vehicles[Index].Get() == Vehicle)
+		{
+			RemoveAt(Index);
+			Vehicle->SetActorTickEnabled(true);
+			return;
+		}
+	}
+}
+
+void AFVehicleTickManager::RemoveAt(int32 Index)
+{
+	Vehicles.RemoveAtSwap(Index);
+	Cores.RemoveAtSwap(Index);
+	Batch.RemoveAtSwap(Index);
+	Outputs.RemoveAtSwap(Index);
+}
+
+void AFVehicleTickManager::Tick(float DeltaSeconds)
+{
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleTickManager, TickManager);
+
+	Super::Tick(DeltaSeconds);
+
+	// Drop vehicles destroyed without unregistering
+	for (int32 Index = Vehicles.Num() - 1; Index >= 0; --Index)
+	{
+		if (Vehicles[Index].IsValid() == false)
+		{
+			RemoveAt(Index);
+		}
+	}
+
+	const int32 NumVehicles = Vehicles.Num();
+	if (NumVehicles == 0)
+	{
+		return;
+	}
+
+	// Same for every vehicle this frame
+	const FVehicleFrameContext Frame = FVehicleFrameContext::Capture();
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
+	// Gather from the components
+	float SimulatedSeconds = 0.0f;
+	for (int32 Index = 0; Index < NumVehicles; ++Index)
+	{
+		Vehicles[Index]->PreTickVehicle(DeltaSeconds, Batch, Index);
+		SimulatedSeconds += Batch.DeltaSeconds[Index];
+	}
+
+	// Engine independent part over the packed state
+	Batch.Tick(Frame, Cores.GetData(), Outputs.GetData());
+
+	// Apply back to the components
+	for (int32 Index = 0; Index < NumVehicles; ++Index)
+	{
+		Vehicles[Index]->PostTickVehicle(DeltaSeconds, Outputs[Index]);
+	}
+
+	NoteSimulation(SimulatedSeconds, FPlatformTime::Cycles() - StartCycles);
+}
+
+void AFVehicleTickManager::NoteSimulation(float SimulatedSeconds, uint32 Cycles)
+{
+	CostInFrame += FPlatformTime::ToMilliseconds(Cycles);
+	SimulatedInFrame += SimulatedSeconds;
+}
+
+void AFVehicleTickManager::FlushSimulationStats()
+{
+	CostInWindow += CostInFrame;
+	SimulatedInWindow += SimulatedInFrame;
+	CostInFrame = 0.0;
+	SimulatedInFrame = 0.0;
+
+	const double Now = FApp::GetCurrentTime();
+	if (Now - WindowStartTime >= 1.0)
+	{
+		SET_FLOAT_STAT(STAT_VehicleSimCost, (SimulatedInWindow > 0.0) ? CostInWindow / SimulatedInWindow : 0.0);
+		CostInWindow = 0.0;
+		SimulatedInWindow = 0.0;
+		WindowStartTime = Now;
+	}
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "VehicleCore.h"
+#include "FVehicleTickManager.generated.h"
+
+class AFPawn;
+
+/**
+ * Ticks every registered vehicle in one pass instead of one actor tick each.
+ * The frame context (HMD and stereo state) is captured once per frame, the core inputs of all
+ * vehicles are written straight into FVehicleCoreBatch and the cores run over those arrays before
+ * the results are applied back to the pawns. Registered pawns have their own tick turned off.
+ */
+UCLASS()
+class AFVehicleTickManager : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** The manager of a world, spawned on first use */
+	static AFVehicleTickManager* Get(UWorld* World);
+
+	/** The manager of a world if there is one */
+	static AFVehicleTickManager* Find(UWorld* World);
+
+	/** Start ticking a vehicle from here, its own tick is disabled */
+	void RegisterVehicle(AFPawn* Vehicle);
+
+	/** Make room for this many more vehicles, so filling a grid doesn't grow every array one by one */
+	void ReserveVehicles(int32 NumAdditional);
+
+	/** Stop ticking a vehicle from here, its own tick is enabled again */
+	void UnregisterVehicle(AFPawn* Vehicle);
+
+	int32 GetNumVehicles() const { return Vehicles.Num(); }
+
+	/**
+	 * Add vehicle ticks to the frame's totals, reported once a second in STAT_VehicleSimCost as game
+	 * thread time per simulated vehicle second.
+	 *
+	 * @param	SimulatedSeconds	time simulated, summed over vehicles
+	 * @param	Cycles				game thread cycles it took
+	 */
+	static void NoteSimulation(float SimulatedSeconds, uint32 Cycles);
+
+	/** Report the frame's totals, from FVehicleProfiler::OnEndFrame */
+	static void FlushSimulationStats();
+
+	// Begin Actor interface
+	virtual void Tick(float DeltaSeconds) override;
+	// End Actor interface
+
+private:
+	void RemoveAt(int32 Index);
+
+	/** Registered vehicles, in the same order as the batch */
+	TArray<TWeakObjectPtr<AFPawn>> Vehicles;
+	/** Core of each vehicle */
+	TArray<FVehicleCore*> Cores;
+	FVehicleCoreBatch Batch;
+	TArray<FVehicleCoreOutput> Outputs;
+};
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "FVehicleTuning.h"
+
+UFVehicleTuning::UFVehicleTuning(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	// Engine
+	MaxEngineRPM = 5700.0f;
+	TorqueCurve.GetRichCurve()->AddKey(0.0f, 400.0f);
+	TorqueCurve.GetRichCurve()->AddKey(1890.0f, 500.0f);
+	TorqueCurve.GetRichCurve()->AddKey(5730.0f, 400.0f);
+
+	// Steering
+	SteeringCurve.GetRichCurve()->AddKey(0.0f, 1.0f);
+	SteeringCurve.GetRichCurve()->AddKey(40.0f, 0.7f);
+	SteeringCurve.GetRichCurve()->AddKey(120.0f, 0.6f);
+
+	// Tire loading
+	MinNormalizedTireLoad = 0.0f;
+	MinNormalizedTireLoadFiltered = 0.2f;
+	MaxNormalizedTireLoad = 2.0f;
+	MaxNormalizedTireLoadFiltered = 2.0f;
+
+	// We want 4wd, driving the front wheels a little more than the rear, with an automatic gearbox
+	DifferentialType = EVehicleDifferential4W::LimitedSlip_4W;
+	FrontRearSplit = 0.65f;
+	bUseGearAutoBox = true;
+
+	// The buggy is quite low
+	COMOffset = FVector(8.0f, 0.0f, 0.0f);
+	InertiaTensorScale = FVector(1.0f, 1.333f, 1.2f);
+}
+
+UFVehicleTuning* UFVehicleTuning::LoadSharedAsset()
+{
+	// Soft reference so a project without the asset quietly keeps the class defaults, looked up only once.
+	// Rooted once found, pawns spawned after the last one went away still get it
+	static const FStringAssetReference AssetRef(TEXT("/Game/Vehicle/VehicleTuning.VehicleTuning"));
+	static UFVehicleTuning* SharedAsset = nullptr;
+	static bool bSearched = false;
+	if (bSearched == false)
+	{
+		SharedAsset = LoadObject<UFVehicleTuning>(nullptr, *AssetRef.ToString(), nullptr, LOAD_NoWarn | LOAD_Quiet);
+		if (SharedAsset != nullptr)
+		{
+			SharedAsset->AddToRoot();
+		}
+		bSearched = true;
+	}
+	return SharedAsset;
+}
+
+void UFVehicleTuning::ApplyTo(UWheeledVehicleMovementComponent4W* Vehicle4W) const
+{
+	check(Vehicle4W);
+
+	// Adjust the tire loading
+	Vehicle4W->MinNormalizedTireLoad = MinNormalizedTireLoad;
+	Vehicle4W->MinNormalizedTireLoadFiltered = MinNormalizedTireLoadFiltered;
+	Vehicle4W->MaxNormalizedTireLoad = MaxNormalizedTireLoad;
+	Vehicle4W->MaxNormalizedTireLoadFiltered = MaxNormalizedTireLoadFiltered;
+
+	// Torque setup
+	Vehicle4W->MaxEngineRPM = MaxEngineRPM;
+	*Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve() = *TorqueCurve.GetRichCurveConst();
+
+	// Adjust the steering
+	*Vehicle4W->SteeringCurve.GetRichCurve() = *SteeringCurve.GetRichCurveConst();
+
+	// Transmission
+	Vehicle4W->DifferentialSetup.DifferentialType = DifferentialType;
+	Vehicle4W->DifferentialSetup.FrontRearSplit = FrontRearSplit;
+	Vehicle4W->TransmissionSetup.bUseGearAutoBox = bUseGearAutoBox;
+
+	// Physics settings
+	Vehicle4W->COMOffset = COMOffset;
+	Vehicle4W->InertiaTensorScale = InertiaTensorScale;
+}
+
+void UFVehicleTuning::PostInitProperties()
+{
+	Super::PostInitProperties();
+	BakeCurves();
+}
+
+void UFVehicleTuning::PostLoad()
+{
+	Super::PostLoad();
+	BakeCurves();
+}
+
+#if WITH_EDITOR
+void UFVehicleTuning::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	BakeCurves();
+}
+#endif
+
+void UFVehicleTuning::BakeCurves()
+{
+	TorqueLUT.Bake(*TorqueCurve.GetRichCurveConst());
+	SteeringLUT.Bake(*SteeringCurve.GetRichCurveConst());
+}
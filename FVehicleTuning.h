@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "Curves/CurveFloat.h"
+#include "Vehicles/WheeledVehicleMovementComponent4W.h"
+#include "VehicleCurveLUT.h"
+#include "FVehicleTuning.generated.h"
+
+/**
+ * Engine, steering, transmission and chassis setup shared by the vehicle pawns.
+ * Edit the asset to retune every car without recompiling. The curves are baked into lookup tables
+ * when the asset loads for cheap game side lookups (AI, telemetry, HUD).
+ */
+UCLASS(BlueprintType)
+class UFVehicleTuning : public UDataAsset
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Engine torque against RPM */
+	UPROPERTY(Category = Engine, EditAnywhere)
+	FRuntimeFloatCurve TorqueCurve;
+
+	UPROPERTY(Category = Engine, EditAnywhere)
+	float MaxEngineRPM;
+
+	/** Maximum steering against speed (km/h) */
+	UPROPERTY(Category = Steering, EditAnywhere)
+	FRuntimeFloatCurve SteeringCurve;
+
+	UPROPERTY(Category = Tires, EditAnywhere)
+	float MinNormalizedTireLoad;
+
+	UPROPERTY(Category = Tires, EditAnywhere)
+	float MinNormalizedTireLoadFiltered;
+
+	UPROPERTY(Category = Tires, EditAnywhere)
+	float MaxNormalizedTireLoad;
+
+	UPROPERTY(Category = Tires, EditAnywhere)
+	float MaxNormalizedTireLoadFiltered;
+
+	UPROPERTY(Category = Transmission, EditAnywhere)
+	TEnumAsByte<EVehicleDifferential4W::Type> DifferentialType;
+
+	/** Share of the drive going to the front wheels */
+	UPROPERTY(Category = Transmission, EditAnywhere, meta=(ClampMin = "0.0", UIMin = "0.0", ClampMax = "1.0", UIMax = "1.0"))
+	float FrontRearSplit;
+
+	UPROPERTY(Category = Transmission, EditAnywhere)
+	bool bUseGearAutoBox;
+
+	/** Center of mass offset */
+	UPROPERTY(Category = Chassis, EditAnywhere)
+	FVector COMOffset;
+
+	/** How the mass of the vehicle is distributed */
+	UPROPERTY(Category = Chassis, EditAnywhere)
+	FVector InertiaTensorScale;
+
+	/** The project's /Game/Vehicle/VehicleTuning asset, nullptr (without logging) if the project has none */
+	static UFVehicleTuning* LoadSharedAsset();
+
+	/** Copy the setup onto a movement component, call before its physics state is created */
+	void ApplyTo(UWheeledVehicleMovementComponent4W* Vehicle4W) const;
+
+	/** Torque for an engine RPM from the baked table */
+	float GetTorque(float RPM) const { return TorqueLUT.Evaluate(RPM); }
+
+	/** Steering scale for a speed in km/h from the baked table */
+	float GetSteeringScale(float KPH) const { return SteeringLUT.Evaluate(KPH); }
+
+	/** Lookups for many vehicles at once, In and Out may be the same array */
+	void GetTorqueBatch(const float* RPMs, float* OutTorques, int32 Count) const { TorqueLUT.EvaluateBatch(RPMs, OutTorques, Count); }
+	void GetSteeringScaleBatch(const float* KPHs, float* OutScales, int32 Count) const { SteeringLUT.EvaluateBatch(KPHs, OutScales, Count); }
+
+	// Begin UObject interface
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	// End UObject interface
+
+private:
+	void BakeCurves();
+
+	FVehicleCurveLUT TorqueLUT;
+	FVehicleCurveLUT SteeringLUT;
+};
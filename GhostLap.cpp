@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "GhostLap.h"
+
+FGhostLap::FGhostLap(const FString& InFilename, int32 InLap)
+	: Filename(InFilename)
+	, Lap(InLap)
+	, LapStartUs(0)
+	, LapEndUs(0)
+	, FirstBlock(INDEX_NONE)
+	, LastBlock(INDEX_NONE)
+	, MaxDecodedBlocks(8)
+{
+	DecodedBlocks.Reserve(MaxDecodedBlocks);
+}
+
+bool FGhostLap::Load()
+{
+	if (Reader.Open(Filename) == false)
+	{
+		return false;
+	}
+
+	// First sample on the lap
+	const int32 SearchBlock = Reader.FindLapStartBlock(Lap);
+	if (SearchBlock == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FirstBlock = INDEX_NONE;
+	for (int32 BlockIndex = SearchBlock; (BlockIndex < Reader.GetNumBlocks()) && (FirstBlock == INDEX_NONE); ++BlockIndex)
+	{
+		const TArray<FVehicleTelemetrySample>* Samples = GetBlock(BlockIndex);
+		for (int32 SampleIndex = 0; (Samples != nullptr) && (SampleIndex < Samples->Num()); ++SampleIndex)
+		{
+			if ((*Samples)[SampleIndex].Lap == Lap)
+			{
+				FirstBlock = BlockIndex;
+				LapStartUs = (*Samples)[SampleIndex].TimeUs;
+				break;
+			}
+		}
+	}
+	if (FirstBlock == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// Last sample on the lap is in the last block that starts on it (or before it)
+	LastBlock = FirstBlock;
+	while ((LastBlock + 1 < Reader.GetNumBlocks()) && (Reader.GetBlockInfo(LastBlock + 1).FirstLap <= Lap))
+	{
+		++LastBlock;
+	}
+	LapEndUs = LapStartUs;
+	const TArray<FVehicleTelemetrySample>* Samples = GetBlock(LastBlock);
+	for (int32 SampleIndex = 0; (Samples != nullptr) && (SampleIndex < Samples->Num()); ++SampleIndex)
+	{
+		if ((*Samples)[SampleIndex].Lap == Lap)
+		{
+			LapEndUs = (*Samples)[SampleIndex].TimeUs;
+		}
+	}
+	return true;
+}
+
+const TArray<FVehicleTelemetrySample>* FGhostLap::GetBlock(int32 BlockIndex)
+{
+	for (int32 Index = 0; Index < DecodedBlocks.Num(); ++Index)
+	{
+		if (DecodedBlocks[Index].BlockIndex == BlockIndex)
+		{
+			DecodedBlocks[Index].LastUsedFrame = GFrameCounter;
+			return &DecodedBlocks[Index].Samples;
+		}
+	}
+
+	// Reuse the least recently used block once the cache is full
+	int32 SlotIndex = INDEX_NONE;
+	if (DecodedBlocks.Num() < MaxDecodedBlocks)
+	{
+		SlotIndex = DecodedBlocks.AddDefaulted();
+	}
+	else
+	{
+		SlotIndex = 0;
+		for (int32 Index = 1; Index < DecodedBlocks.Num(); ++Index)
+		{
+			if (DecodedBlocks[Index].LastUsedFrame < DecodedBlocks[SlotIndex].LastUsedFrame)
+			{
+				SlotIndex = Index;
+			}
+		}
+	}
+
+	FDecodedBlock& Block = DecodedBlocks[SlotIndex];
+	Block.BlockIndex = BlockIndex;
+	Block.LastUsedFrame = GFrameCounter;
+	Block.Samples.Reset();
+	if (Reader.DecodeBlock(BlockIndex, Block.Samples) == false)
+	{
+		DecodedBlocks.RemoveAtSwap(SlotIndex);
+		return nullptr;
+	}
+	return &Block.Samples;
+}
+
+bool FGhostLap::Sample(int64 LapTimeUs, FGhostLapCursor& Cursor, FVehicleTelemetrySample& OutFrom, FVehicleTelemetrySample& OutTo, float& OutAlpha)
+{
+	if (FirstBlock == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const int64 TimeUs = LapStartUs + FMath::Clamp<int64>(LapTimeUs, 0, GetLapTimeUs());
+
+	// Playback normally only moves forward, start over if it went back
+	if ((Cursor.BlockIndex == INDEX_NONE) || (Reader.GetBlockInfo(Cursor.BlockIndex).FirstTimeUs > TimeUs))
+	{
+		Cursor.BlockIndex = FMath::Clamp(Reader.FindBlock(TimeUs), FirstBlock, LastBlock);
+		Cursor.SampleIndex = 0;
+	}
+	while ((Cursor.BlockIndex < LastBlock) && (Reader.GetBlockInfo(Cursor.BlockIndex).LastTimeUs < TimeUs))
+	{
+		++Cursor.BlockIndex;
+		Cursor.SampleIndex = 0;
+	}
+
+	const TArray<FVehicleTelemetrySample>* Samples = GetBlock(Cursor.BlockIndex);
+	if ((Samples == nullptr) || (Samples->Num() == 0))
+	{
+		return false;
+	}
+
+	if ((Cursor.SampleIndex >= Samples->Num()) || ((*Samples)[Cursor.SampleIndex].TimeUs > TimeUs))
+	{
+		Cursor.SampleIndex = 0;
+	}
+	while ((Cursor.SampleIndex + 1 < Samples->Num()) && ((*Samples)[Cursor.SampleIndex + 1].TimeUs <= TimeUs))
+	{
+		++Cursor.SampleIndex;
+	}
+
+	OutFrom = (*Samples)[Cursor.SampleIndex];
+	if (Cursor.SampleIndex + 1 < Samples->Num())
+	{
+		OutTo = (*Samples)[Cursor.SampleIndex + 1];
+	}
+	else
+	{
+		// The next keyframe is the first of the next block
+		const TArray<FVehicleTelemetrySample>* NextSamples = (Cursor.BlockIndex < LastBlock) ? GetBlock(Cursor.BlockIndex + 1) : nullptr;
+		OutTo = ((NextSamples != nullptr) && (NextSamples->Num() > 0)) ? (*NextSamples)[0] : OutFrom;
+	}
+
+	const int64 SpanUs = OutTo.TimeUs - OutFrom.TimeUs;
+	OutAlpha = (SpanUs > 0) ? FMath::Clamp((float)(TimeUs - OutFrom.TimeUs) / (float)SpanUs, 0.0f, 1.0f) : 0.0f;
+	return true;
+}
+
+FGhostLapCache& FGhostLapCache::Get()
+{
+	static FGhostLapCache Cache;
+	return Cache;
+}
+
+FGhostLapPtr FGhostLapCache::FindOrLoad(const FString& Filename, int32 Lap)
+{
+	const FString Key = FString::Printf(TEXT("%s#%d"), *Filename, Lap);
+	TWeakPtr<FGhostLap>* Existing = Laps.Find(Key);
+	if (Existing != nullptr)
+	{
+		FGhostLapPtr Loaded = Existing->Pin();
+		if (Loaded.IsValid())
+		{
+			return Loaded;
+		}
+	}
+
+	PruneExpired();
+
+	FGhostLapPtr NewLap = MakeShareable(new FGhostLap(Filename, Lap));
+	if (NewLap->Load() == false)
+	{
+		Laps.Remove(Key);
+		return nullptr;
+	}
+	Laps.Add(Key, NewLap);
+	return NewLap;
+}
+
+void FGhostLapCache::Release(FGhostLapPtr& Lap)
+{
+	Lap.Reset();
+	PruneExpired();
+}
+
+void FGhostLapCache::PruneExpired()
+{
+	for (auto It = Laps.CreateIterator(); It; ++It)
+	{
+		if (It.Value().IsValid() == false)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
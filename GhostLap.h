@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VehicleTelemetryReader.h"
+
+/** Where a ghost is in its lap, owned by the ghost so several can share one FGhostLap */
+struct FGhostLapCursor
+{
+	int32 BlockIndex;
+	int32 SampleIndex;
+
+	FGhostLapCursor()
+		: BlockIndex(INDEX_NONE)
+		, SampleIndex(0)
+	{
+	}
+};
+
+/**
+ * One recorded lap streamed out of a telemetry file.
+ * Blocks are decoded when a ghost reaches them and kept in a small cache, so ghosts replaying the
+ * same lap decode it once between them.
+ */
+class FGhostLap
+{
+public:
+	FGhostLap(const FString& InFilename, int32 InLap);
+
+	/** Map the file and find where the lap starts and ends */
+	bool Load();
+
+	const FString& GetFilename() const { return Filename; }
+	int32 GetLap() const { return Lap; }
+
+	/** Length of the lap */
+	int64 GetLapTimeUs() const { return LapEndUs - LapStartUs; }
+
+	/**
+	 * Get the two keyframes around a time in the lap.
+	 *
+	 * @param	LapTimeUs	time since the start of the lap, clamped to the lap
+	 * @param	Cursor		the caller's position, moved forward (or reset when going back)
+	 * @param	OutFrom		keyframe at or before LapTimeUs
+	 * @param	OutTo		keyframe after LapTimeUs
+	 * @param	OutAlpha	blend from OutFrom to OutTo
+	 * @return false if the lap has no samples
+	 */
+	bool Sample(int64 LapTimeUs, FGhostLapCursor& Cursor, FVehicleTelemetrySample& OutFrom, FVehicleTelemetrySample& OutTo, float& OutAlpha);
+
+	/** Blocks currently held decoded, for checking the cache stays small */
+	int32 GetNumDecodedBlocks() const { return DecodedBlocks.Num(); }
+
+private:
+	struct FDecodedBlock
+	{
+		int32 BlockIndex;
+		uint64 LastUsedFrame;
+		TArray<FVehicleTelemetrySample> Samples;
+	};
+
+	/** Decoded samples of a block, decoding (and evicting the oldest block) if needed */
+	const TArray<FVehicleTelemetrySample>* GetBlock(int32 BlockIndex);
+
+	FString Filename;
+	int32 Lap;
+
+	FVehicleTelemetryReader Reader;
+
+	/** Absolute telemetry times of the first and last sample of the lap */
+	int64 LapStartUs;
+	int64 LapEndUs;
+	int32 FirstBlock;
+	int32 LastBlock;
+
+	/** Blocks kept decoded, enough for a few ghosts spread along the lap */
+	int32 MaxDecodedBlocks;
+	TArray<FDecodedBlock> DecodedBlocks;
+};
+
+typedef TSharedPtr<FGhostLap> FGhostLapPtr;
+
+/** Hands out shared FGhostLaps so ghosts replaying the same lap share decoding and memory */
+class FGhostLapCache
+{
+public:
+	static FGhostLapCache& Get();
+
+	/** Find a lap that is already loaded or load it, nullptr if it can not be read */
+	FGhostLapPtr FindOrLoad(const FString& Filename, int32 Lap);
+
+	/** Drop a ghost's reference to its lap and forget laps no ghost holds anymore */
+	void Release(FGhostLapPtr& Lap);
+
+private:
+	/** Remove entries whose lap has already been freed */
+	void PruneExpired();
+
+	/** Laps only live as long as a ghost holds them */
+	TMap<FString, TWeakPtr<FGhostLap>> Laps;
+};
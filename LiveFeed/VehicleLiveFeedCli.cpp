@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Sample consumer of the live vehicle feed, prints the latest state of every vehicle a few
+// times a second and follows the game when it restarts the feed.
+//
+//	VehicleLiveFeedCli [-name /VehicleLiveFeed] [-hz 10] [-vehicle <id>] [-all]
+
+#include "VehicleLiveFeedReader.h"
+
+#include <map>
+#include <vector>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+	volatile sig_atomic_t bQuit = 0;
+
+	void OnSignal(int)
+	{
+		bQuit = 1;
+	}
+
+	double NowSeconds()
+	{
+		timespec Time;
+		clock_gettime(CLOCK_MONOTONIC, &Time);
+		return Time.tv_sec + Time.tv_nsec * 1e-9;
+	}
+
+	void PrintLapTime(int64_t TimeUs)
+	{
+		const int64_t TotalMilSec = TimeUs / 1000;
+		printf("%d:%02d.%03d", (int)(TotalMilSec / 60000), (int)((TotalMilSec / 1000) % 60), (int)(TotalMilSec % 1000));
+	}
+
+	void PrintSample(const VehicleLiveFeedFormat::FSample& Sample)
+	{
+		printf("%10u  frame %8llu  %6.1f km/h  gear %2d  %5.0f rpm  thr %5.2f  str %5.2f%s  lap %d ",
+			Sample.VehicleId, (unsigned long long)Sample.FrameNumber, Sample.Speed * 0.036f, Sample.Gear, Sample.RPM,
+			Sample.Throttle, Sample.Steering, Sample.bHandbrake ? "  hb" : "    ", Sample.Lap);
+		PrintLapTime(Sample.LapTimeUs);
+		printf("  best ");
+		PrintLapTime(Sample.BestLapUs);
+		printf("  at (%.0f, %.0f, %.0f)\n", Sample.Location[0], Sample.Location[1], Sample.Location[2]);
+	}
+}
+
+int main(int ArgC, char** ArgV)
+{
+	const char* Name = VehicleLiveFeedFormat::DefaultName;
+	double PrintHz = 10.0;
+	bool bFilterVehicle = false;
+	uint32_t VehicleId = 0;
+	bool bPrintAll = false;
+
+	for (int Arg = 1; Arg < ArgC; ++Arg)
+	{
+		if ((strcmp(ArgV[Arg], "-name") == 0) && (Arg + 1 < ArgC))
+		{
+			Name = ArgV[++Arg];
+		}
+		else if ((strcmp(ArgV[Arg], "-hz") == 0) && (Arg + 1 < ArgC))
+		{
+			PrintHz = atof(ArgV[++Arg]);
+		}
+		else if ((strcmp(ArgV[Arg], "-vehicle") == 0) && (Arg + 1 < ArgC))
+		{
+			bFilterVehicle = true;
+			VehicleId = (uint32_t)strtoul(ArgV[++Arg], nullptr, 10);
+		}
+		else if (strcmp(ArgV[Arg], "-all") == 0)
+		{
+			bPrintAll = true;
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [-name /VehicleLiveFeed] [-hz 10] [-vehicle <id>] [-all]\n", ArgV[0]);
+			return 1;
+		}
+	}
+
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+
+	FVehicleLiveFeedReader Reader;
+	std::vector<VehicleLiveFeedFormat::FSample> Samples(1024);
+	std::map<uint32_t, VehicleLiveFeedFormat::FSample> Latest;
+	const double PrintInterval = (PrintHz > 0.0) ? 1.0 / PrintHz : 0.0;
+	double NextPrintTime = 0.0;
+	uint64_t LastMissed = 0;
+
+	while (bQuit == 0)
+	{
+		if ((Reader.IsAttached() == false) || (Reader.IsStale() == true))
+		{
+			if (Reader.IsAttached() == true)
+			{
+				printf("Feed closed or restarted, attaching again\n");
+				Latest.clear();
+			}
+			if (Reader.Attach(Name) == false)
+			{
+				usleep(500000);
+				continue;
+			}
+			printf("Attached to %s, session %llx\n", Name, (unsigned long long)Reader.GetSessionId());
+			LastMissed = 0;
+		}
+
+		const size_t NumRead = Reader.Read(Samples.data(), Samples.size());
+		for (size_t Index = 0; Index < NumRead; ++Index)
+		{
+			const VehicleLiveFeedFormat::FSample& Sample = Samples[Index];
+			if ((bFilterVehicle == true) && (Sample.VehicleId != VehicleId))
+			{
+				continue;
+			}
+			if (bPrintAll == true)
+			{
+				PrintSample(Sample);
+			}
+			Latest[Sample.VehicleId] = Sample;
+		}
+
+		const double Now = NowSeconds();
+		if ((bPrintAll == false) && (Now >= NextPrintTime) && (Latest.empty() == false))
+		{
+			for (std::map<uint32_t, VehicleLiveFeedFormat::FSample>::const_iterator It = Latest.begin(); It != Latest.end(); ++It)
+			{
+				PrintSample(It->second);
+			}
+			if (Reader.GetNumMissed() != LastMissed)
+			{
+				printf("%llu samples missed, the ring wrapped before they were read\n", (unsigned long long)(Reader.GetNumMissed() - LastMissed));
+				LastMissed = Reader.GetNumMissed();
+			}
+			printf("\n");
+			NextPrintTime = Now + PrintInterval;
+		}
+
+		// The game publishes once a frame, polling faster only burns a core
+		if (NumRead < Samples.size())
+		{
+			usleep(1000);
+		}
+	}
+
+	Reader.Detach();
+	return 0;
+}
@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VehicleLiveFeedReader.h"
+
+#include <atomic>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace VehicleLiveFeedFormat;
+
+FVehicleLiveFeedReader::FVehicleLiveFeedReader()
+	: Header(nullptr)
+	, Slots(nullptr)
+	, MappedSize(0)
+	, NumSlots(0)
+	, SessionId(0)
+	, Cursor(0)
+	, NumMissed(0)
+{
+}
+
+FVehicleLiveFeedReader::~FVehicleLiveFeedReader()
+{
+	Detach();
+}
+
+bool FVehicleLiveFeedReader::Attach(const char* Name)
+{
+	Detach();
+
+	const int File = shm_open(Name, O_RDONLY, 0);
+	if (File < 0)
+	{
+		return false;
+	}
+
+	struct stat FileStat;
+	void* View = MAP_FAILED;
+	if ((fstat(File, &FileStat) == 0) && (FileStat.st_size >= (off_t)sizeof(FHeader)))
+	{
+		MappedSize = (size_t)FileStat.st_size;
+		View = mmap(nullptr, MappedSize, PROT_READ, MAP_SHARED, File, 0);
+	}
+	close(File);
+
+	if (View == MAP_FAILED)
+	{
+		MappedSize = 0;
+		return false;
+	}
+
+	// The header is only valid once the game wrote Magic, and only usable if it matches our layout
+	const FHeader* MappedHeader = (const FHeader*)View;
+	const bool bReady = (MappedHeader->Magic == Magic);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if ((bReady == false) || (MappedHeader->bOpen == 0)
+		|| (MappedHeader->Version != Version) || (MappedHeader->HeaderSize != sizeof(FHeader)) || (MappedHeader->SlotSize != sizeof(FSlot))
+		|| (MappedHeader->NumSlots == 0) || (GetSegmentSize(MappedHeader->NumSlots) > MappedSize))
+	{
+		munmap(View, MappedSize);
+		MappedSize = 0;
+		return false;
+	}
+
+	Header = MappedHeader;
+	Slots = GetSlots(Header);
+	NumSlots = Header->NumSlots;
+	SessionId = Header->SessionId;
+	Cursor = Header->WriteCount;
+	NumMissed = 0;
+	return true;
+}
+
+void FVehicleLiveFeedReader::Detach()
+{
+	if (Header != nullptr)
+	{
+		munmap((void*)Header, MappedSize);
+	}
+	Header = nullptr;
+	Slots = nullptr;
+	MappedSize = 0;
+	NumSlots = 0;
+}
+
+bool FVehicleLiveFeedReader::IsStale() const
+{
+	return (Header != nullptr) && ((Header->bOpen == 0) || (Header->SessionId != SessionId));
+}
+
+size_t FVehicleLiveFeedReader::Read(FSample* OutSamples, size_t MaxSamples)
+{
+	if (Header == nullptr)
+	{
+		return 0;
+	}
+
+	const uint64_t WriteCount = Header->WriteCount;
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	// Lapped, the oldest samples are gone
+	if (WriteCount - Cursor > NumSlots)
+	{
+		NumMissed += WriteCount - NumSlots - Cursor;
+		Cursor = WriteCount - NumSlots;
+	}
+
+	size_t NumRead = 0;
+	while ((Cursor < WriteCount) && (NumRead < MaxSamples))
+	{
+		if (ReadSlot(Cursor, OutSamples[NumRead]) == true)
+		{
+			++NumRead;
+		}
+		else
+		{
+			++NumMissed;
+		}
+		++Cursor;
+	}
+	return NumRead;
+}
+
+bool FVehicleLiveFeedReader::ReadSlot(uint64_t Index, FSample& OutSample) const
+{
+	const FSlot& Slot = Slots[Index % NumSlots];
+
+	// An odd sequence means the game is writing a newer sample over this one
+	const uint32_t Before = Slot.Sequence;
+	if ((Before & 1) != 0)
+	{
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	const uint64_t SlotIndex = Slot.Index;
+	memcpy(&OutSample, (const void*)&Slot.Sample, sizeof(FSample));
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint32_t After = Slot.Sequence;
+	return (Before == After) && (SlotIndex == Index);
+}
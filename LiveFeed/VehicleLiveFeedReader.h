@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <stddef.h>
+#include "../VehicleLiveFeedFormat.h"
+
+/**
+ * Reads the live vehicle feed the game publishes to shared memory (see VehicleLiveFeedFormat.h).
+ * Plain C++ with no engine dependency, for rigs and dashboards running next to the game.
+ * Any number of readers can be attached, each keeps its own position in the ring and nothing
+ * a reader does is seen by the game.
+ */
+class FVehicleLiveFeedReader
+{
+public:
+	FVehicleLiveFeedReader();
+	~FVehicleLiveFeedReader();
+
+	/** Map the feed read only, false when the game has not opened it or wrote another version */
+	bool Attach(const char* Name = VehicleLiveFeedFormat::DefaultName);
+
+	void Detach();
+
+	bool IsAttached() const { return Header != nullptr; }
+
+	/** The game closed the feed or opened a new one, Detach and Attach again to follow it */
+	bool IsStale() const;
+
+	/**
+	 * Copy the samples published since the last call, oldest first. Reading starts at the
+	 * newest sample when attaching, samples overwritten before they were read are skipped.
+	 *
+	 * @return number of samples copied to OutSamples
+	 */
+	size_t Read(VehicleLiveFeedFormat::FSample* OutSamples, size_t MaxSamples);
+
+	/** Samples this reader lost because the ring wrapped before it read them */
+	uint64_t GetNumMissed() const { return NumMissed; }
+
+	uint64_t GetSessionId() const { return SessionId; }
+
+private:
+	/** Seqlock read of one slot, false if the sample was overwritten */
+	bool ReadSlot(uint64_t Index, VehicleLiveFeedFormat::FSample& OutSample) const;
+
+	const VehicleLiveFeedFormat::FHeader* Header;
+	const VehicleLiveFeedFormat::FSlot* Slots;
+	size_t MappedSize;
+	uint32_t NumSlots;
+	uint64_t SessionId;
+	/** Next sample to read */
+	uint64_t Cursor;
+	uint64_t NumMissed;
+};
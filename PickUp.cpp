@@ -1,28 +1,72 @@
-
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SimpleVehicle.h"
 #include "PickUp.h"
+#include "PickUpManager.h"
 
 
 APickUp::APickUp(const class FPostConstructInitializeProperties& PCIP)
 	: Super(PCIP)
 {
 	bIsActivate = true;
+	RespawnDelay = 0.0f;
+	PickUpIndex = INDEX_NONE;
 
 	BaseCollision = PCIP.CreateDefaultSubobject<USphereComponent>(this, TEXT("BaseCollsion"));
+	BaseCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BaseCollision->bGenerateOverlapEvents = false;
 
 	RootComponent = BaseCollision;
 
 	PickupMesh = PCIP.CreateDefaultSubobject<UStaticMeshComponent>(this, TEXT("PickUpMesh"));
 
-	PickupMesh->SetSimulatePhysics(true);
+	// Collection is done by the manager, no need for a body
+	PickupMesh->SetSimulatePhysics(false);
+	PickupMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	PickupMesh->bGenerateOverlapEvents = false;
 	PickupMesh->AttachTo(RootComponent);
 }
 
+void APickUp::BeginPlay()
+{
+	Super::BeginPlay();
+
+	APickUpManager* PickUpManager = APickUpManager::Get(GetWorld());
+	PickUpIndex = PickUpManager->AddPickUp(GetActorLocation(), BaseCollision->GetScaledSphereRadius(), this, RespawnDelay);
+	Manager = PickUpManager;
+	SetActivate(bIsActivate);
+}
+
+void APickUp::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Manager.IsValid() == true)
+	{
+		Manager->RemovePickUp(PickUpIndex);
+	}
+	PickUpIndex = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APickUp::SetActivate(bool bNewActivate)
+{
+	bIsActivate = bNewActivate;
+	SetActorHiddenInGame(bNewActivate == false);
+	if (Manager.IsValid() == true)
+	{
+		Manager->SetPickUpActive(PickUpIndex, bNewActivate);
+	}
+}
+
+void APickUp::OnCollected()
+{
+	bIsActivate = false;
+	SetActorHiddenInGame(true);
+	PickedUp();
+}
+
 void APickUp::PickedUp_Implementation()
 {
 	if (iCountFlags - 1 == iCountFlags)++iCountFlags;
 }
 
-
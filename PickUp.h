@@ -6,19 +6,26 @@
 #include "PickUp.generated.h"
 
 /**
- * 
+ * A pickup placed in the level. Collection is done by APickUpManager, the actor only holds the
+ * mesh, so it has no collision and no physics.
  */
 UCLASS()
 class SIMPLEVEHICLE_API APickUp : public AActor
 {
 	GENERATED_UCLASS_BODY()
 
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = PickUp)
+	/** Whether the pickup starts (and currently is) collectable, change it at runtime with SetActivate */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = PickUp)
 	bool bIsActivate;
 
 	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = PickUp)
 	INT16 iCountFlags;
 
+	/** Seconds until the pickup comes back after being collected, 0 for never */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = PickUp)
+	float RespawnDelay;
+
+	/** Only its radius is used, as the collection radius */
 	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = PickUp)
 	TSubobjectPtr<USphereComponent> BaseCollision;
 
@@ -27,7 +34,24 @@ class SIMPLEVEHICLE_API APickUp : public AActor
 
 	UFUNCTION(BlueprintNativeEvent)
 	void PickedUp();
-	
-};
 
+	/** Make the pickup collectable again, or take it away */
+	UFUNCTION(BlueprintCallable, Category = PickUp)
+	void SetActivate(bool bNewActivate);
+
+	/** Called by the manager when a vehicle drove through */
+	void OnCollected();
 
+	// Begin Actor interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End Actor interface
+
+private:
+	friend class APickUpManager;
+
+	/** Handle in the manager */
+	int32 PickUpIndex;
+
+	TWeakObjectPtr<class APickUpManager> Manager;
+};
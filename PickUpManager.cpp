@@ -0,0 +1,450 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SimpleVehicle.h"
+#include "PickUpManager.h"
+#include "PickUp.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPickUp, Log, All);
+
+namespace
+{
+	/** Manager of each world, every pickup asks for it in BeginPlay so don't search the actor list each time */
+	TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<APickUpManager>> WorldManagers;
+}
+
+APickUpManager::APickUpManager(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	CellSize = 1000.0f;
+	CollectorRadius = 150.0f;
+	MaxSweepDistance = 5000.0f;
+	InvCellSize = 1.0f / CellSize;
+	MaxPickUpRadius = 0.0f;
+	PoolClass = APickUp::StaticClass();
+	RespawnResolution = 0.1f;
+	RespawnSlots = 512;
+	PoolSize = 0;
+	PoolAllocations = 0;
+
+	// After the vehicles have moved
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+void APickUpManager::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	InvCellSize = 1.0f / FMath::Max(CellSize, 1.0f);
+	RespawnWheel.Init(RespawnResolution, RespawnSlots);
+}
+
+APickUpManager* APickUpManager::Find(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	const TWeakObjectPtr<APickUpManager>* Cached = WorldManagers.Find(World);
+	if ((Cached != nullptr) && Cached->IsValid() && ((*Cached)->IsPendingKill() == false))
+	{
+		return Cached->Get();
+	}
+
+	for (TActorIterator<APickUpManager> It(World); It; ++It)
+	{
+		if (It->IsPendingKill() == false)
+		{
+			WorldManagers.Add(World, *It);
+			return *It;
+		}
+	}
+	return nullptr;
+}
+
+APickUpManager* APickUpManager::Get(UWorld* World)
+{
+	check(World != nullptr);
+	APickUpManager* Manager = Find(World);
+	if (Manager != nullptr)
+	{
+		return Manager;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bNoCollisionFail = true;
+	Manager = World->SpawnActor<APickUpManager>(SpawnParams);
+
+	// Forget worlds that have gone away while we're here
+	for (auto It = WorldManagers.CreateIterator(); It; ++It)
+	{
+		if ((It.Key().IsValid() == false) || (It.Value().IsValid() == false))
+		{
+			It.RemoveCurrent();
+		}
+	}
+	WorldManagers.Add(World, Manager);
+	return Manager;
+}
+
+int32 APickUpManager::AddPickUp(const FVector& Location, float Radius, APickUp* Actor, float RespawnDelay)
+{
+	int32 PickUpIndex;
+	if (FreeList.Num() > 0)
+	{
+		PickUpIndex = FreeList.Pop();
+	}
+	else
+	{
+		PickUpIndex = PickUps.AddUninitialized();
+		RespawnWheel.Reserve(PickUps.Num());
+	}
+
+	FPickUpEntry& Entry = PickUps[PickUpIndex];
+	Entry.Location = Location;
+	Entry.Radius = Radius;
+	Entry.Actor = Actor;
+	Entry.RespawnDelay = RespawnDelay;
+	Entry.CellKey = MakeCellKey(ToCell(Location.X), ToCell(Location.Y));
+	Entry.NextInCell = INDEX_NONE;
+	Entry.bActive = true;
+	Entry.bInUse = true;
+	LinkToCell(PickUpIndex);
+
+	MaxPickUpRadius = FMath::Max(MaxPickUpRadius, Radius);
+	return PickUpIndex;
+}
+
+void APickUpManager::RemovePickUp(int32 PickUpIndex)
+{
+	if ((PickUps.IsValidIndex(PickUpIndex) == false) || (PickUps[PickUpIndex].bInUse == false))
+	{
+		return;
+	}
+
+	UnlinkFromCell(PickUpIndex);
+	RespawnWheel.Cancel(PickUpIndex);
+	FPickUpEntry& Entry = PickUps[PickUpIndex];
+	Entry.Actor.Reset();
+	Entry.bActive = false;
+	Entry.bInUse = false;
+	FreeList.Add(PickUpIndex);
+}
+
+void APickUpManager::SetPickUpActive(int32 PickUpIndex, bool bActive)
+{
+	if ((PickUps.IsValidIndex(PickUpIndex) == true) && (PickUps[PickUpIndex].bInUse == true))
+	{
+		PickUps[PickUpIndex].bActive = bActive;
+		if (bActive == true)
+		{
+			RespawnWheel.Cancel(PickUpIndex);
+		}
+	}
+}
+
+bool APickUpManager::IsPickUpActive(int32 PickUpIndex) const
+{
+	return (PickUps.IsValidIndex(PickUpIndex) == true) && (PickUps[PickUpIndex].bActive == true);
+}
+
+void APickUpManager::RegisterCollector(AActor* Collector)
+{
+	for (const FCollector& Existing : Collectors)
+	{
+		if (Existing.Actor.Get() == Collector)
+		{
+			return;
+		}
+	}
+
+	FCollector NewCollector;
+	NewCollector.Actor = Collector;
+	NewCollector.LastLocation = FVector::ZeroVector;
+	NewCollector.bHasLastLocation = false;
+	Collectors.Add(NewCollector);
+}
+
+void APickUpManager::UnregisterCollector(AActor* Collector)
+{
+	for (int32 CollectorIndex = 0; CollectorIndex < Collectors.Num(); ++CollectorIndex)
+	{
+		if (Collectors[CollectorIndex].Actor.Get() == Collector)
+		{
+			Collectors.RemoveAtSwap(CollectorIndex);
+			return;
+		}
+	}
+}
+
+void APickUpManager::LinkToCell(int32 PickUpIndex)
+{
+	FPickUpEntry& Entry = PickUps[PickUpIndex];
+	int32* Head = CellHeads.Find(Entry.CellKey);
+	if (Head != nullptr)
+	{
+		Entry.NextInCell = *Head;
+		*Head = PickUpIndex;
+	}
+	else
+	{
+		Entry.NextInCell = INDEX_NONE;
+		CellHeads.Add(Entry.CellKey, PickUpIndex);
+	}
+}
+
+void APickUpManager::UnlinkFromCell(int32 PickUpIndex)
+{
+	FPickUpEntry& Entry = PickUps[PickUpIndex];
+	int32* Head = CellHeads.Find(Entry.CellKey);
+	if (Head == nullptr)
+	{
+		return;
+	}
+
+	if (*Head == PickUpIndex)
+	{
+		*Head = Entry.NextInCell;
+		if (*Head == INDEX_NONE)
+		{
+			CellHeads.Remove(Entry.CellKey);
+		}
+	}
+	else
+	{
+		for (int32 Index = *Head; Index != INDEX_NONE; Index = PickUps[Index].NextInCell)
+		{
+			if (PickUps[Index].NextInCell == PickUpIndex)
+			{
+				PickUps[Index].NextInCell = Entry.NextInCell;
+				break;
+			}
+		}
+	}
+	Entry.NextInCell = INDEX_NONE;
+}
+
+void APickUpManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	RespawnWheel.Advance(DeltaSeconds, [this](int32 PickUpIndex) { Respawn(PickUpIndex); });
+
+	for (int32 CollectorIndex = Collectors.Num() - 1; CollectorIndex >= 0; --CollectorIndex)
+	{
+		FCollector& Collector = Collectors[CollectorIndex];
+		AActor* Actor = Collector.Actor.Get();
+		if (Actor == nullptr)
+		{
+			Collectors.RemoveAtSwap(CollectorIndex);
+			continue;
+		}
+
+		const FVector Location = Actor->GetActorLocation();
+		FVector Start = Collector.bHasLastLocation ? Collector.LastLocation : Location;
+		if (FVector::DistSquared(Start, Location) > FMath::Square(MaxSweepDistance))
+		{
+			Start = Location;
+		}
+		if (CellHeads.Num() > 0)
+		{
+			SweepCollector(Actor, Start, Location);
+		}
+		Collector.LastLocation = Location;
+		Collector.bHasLastLocation = true;
+	}
+
+	if (PendingEvents.Num() == 0)
+	{
+		return;
+	}
+
+	// One broadcast for the frame, then the per actor notifications
+	OnPickUpsCollected.Broadcast(PendingEvents);
+	for (const FPickUpCollectEvent& Event : PendingEvents)
+	{
+		// A handler may have destroyed the actor, it is only pending kill until the next collection
+		if ((Event.PickUp != nullptr) && (Event.PickUp->IsPendingKill() == false))
+		{
+			Event.PickUp->OnCollected();
+		}
+
+		// The handle may have been released by a handler
+		const FPickUpEntry& Entry = PickUps[Event.PickUpIndex];
+		if ((Entry.bInUse == true) && (Entry.bActive == false) && (Entry.RespawnDelay > 0.0f))
+		{
+			RespawnWheel.Schedule(Event.PickUpIndex, Entry.RespawnDelay);
+		}
+	}
+	PendingEvents.Reset();
+}
+
+void APickUpManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UE_LOG(LogPickUp, Log, TEXT("Pickup pool: %d actors, %d spawned during play, %d respawns pending"), PoolSize, PoolAllocations, RespawnWheel.GetNumPending());
+
+	const TWeakObjectPtr<APickUpManager>* Cached = WorldManagers.Find(GetWorld());
+	if ((Cached != nullptr) && (Cached->Get() == this))
+	{
+		WorldManagers.Remove(GetWorld());
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APickUpManager::Respawn(int32 PickUpIndex)
+{
+	FPickUpEntry& Entry = PickUps[PickUpIndex];
+	if (Entry.bInUse == false)
+	{
+		return;
+	}
+
+	APickUp* Actor = Entry.Actor.Get();
+	if (Actor != nullptr)
+	{
+		// Goes through SetPickUpActive
+		Actor->SetActivate(true);
+	}
+	else
+	{
+		Entry.bActive = true;
+	}
+}
+
+void APickUpManager::PrewarmPool(int32 Count)
+{
+	FreePool.Reserve(PoolSize + Count);
+	UsedPool.Reserve(PoolSize + Count);
+	PickUps.Reserve(PickUps.Num() + Count);
+	RespawnWheel.Reserve(PickUps.Num() + Count);
+	PendingEvents.Reserve(PickUps.Num() + Count);
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		APickUp* PickUp = SpawnPooledPickUp();
+		if (PickUp != nullptr)
+		{
+			FreePool.Add(PickUp);
+		}
+	}
+}
+
+APickUp* APickUpManager::AcquirePickUp(const FVector& Location, float RespawnDelay)
+{
+	APickUp* PickUp = nullptr;
+	if (FreePool.Num() > 0)
+	{
+		PickUp = FreePool.Pop();
+	}
+	else
+	{
+		PickUp = SpawnPooledPickUp();
+		if (PickUp == nullptr)
+		{
+			return nullptr;
+		}
+		++PoolAllocations;
+		UE_LOG(LogPickUp, Warning, TEXT("Pickup pool empty, spawned %s (%d spawned during play)"), *PickUp->GetName(), PoolAllocations);
+	}
+
+	UsedPool.Add(PickUp);
+	PickUp->SetActorLocation(Location);
+	PickUp->RespawnDelay = RespawnDelay;
+	PickUp->PickUpIndex = AddPickUp(Location, PickUp->BaseCollision->GetScaledSphereRadius(), PickUp, RespawnDelay);
+	PickUp->SetActivate(true);
+	return PickUp;
+}
+
+void APickUpManager::ReleasePickUp(APickUp* PickUp)
+{
+	if ((PickUp == nullptr) || (UsedPool.RemoveSingleSwap(PickUp) == 0))
+	{
+		return;
+	}
+
+	RemovePickUp(PickUp->PickUpIndex);
+	PickUp->PickUpIndex = INDEX_NONE;
+	PickUp->bIsActivate = false;
+	PickUp->SetActorHiddenInGame(true);
+	FreePool.Add(PickUp);
+}
+
+APickUp* APickUpManager::SpawnPooledPickUp()
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bNoCollisionFail = true;
+	APickUp* PickUp = GetWorld()->SpawnActor<APickUp>(PoolClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+	if (PickUp == nullptr)
+	{
+		return nullptr;
+	}
+	++PoolSize;
+
+	// BeginPlay put it in the grid, pooled pickups only go there when acquired
+	RemovePickUp(PickUp->PickUpIndex);
+	PickUp->PickUpIndex = INDEX_NONE;
+	PickUp->bIsActivate = false;
+	PickUp->SetActorHiddenInGame(true);
+	return PickUp;
+}
+
+void APickUpManager::SweepCollector(AActor* Collector, const FVector& Start, const FVector& End)
+{
+	// Cells touched by the sweep grown by the largest radius
+	const float Reach = CollectorRadius + MaxPickUpRadius;
+	const int32 MinX = ToCell(FMath::Min(Start.X, End.X) - Reach);
+	const int32 MaxX = ToCell(FMath::Max(Start.X, End.X) + Reach);
+	const int32 MinY = ToCell(FMath::Min(Start.Y, End.Y) - Reach);
+	const int32 MaxY = ToCell(FMath::Max(Start.Y, End.Y) + Reach);
+
+	const FVector Segment = End - Start;
+	const float SegmentSizeSquared = Segment.SizeSquared();
+
+	for (int32 CellX = MinX; CellX <= MaxX; ++CellX)
+	{
+		for (int32 CellY = MinY; CellY <= MaxY; ++CellY)
+		{
+			const int32* Head = CellHeads.Find(MakeCellKey(CellX, CellY));
+			if (Head == nullptr)
+			{
+				continue;
+			}
+
+			for (int32 PickUpIndex = *Head; PickUpIndex != INDEX_NONE; PickUpIndex = PickUps[PickUpIndex].NextInCell)
+			{
+				const FPickUpEntry& Entry = PickUps[PickUpIndex];
+				if (Entry.bActive == false)
+				{
+					continue;
+				}
+
+				// Closest point of the sweep to the pickup
+				FVector Closest = Start;
+				if (SegmentSizeSquared > KINDA_SMALL_NUMBER)
+				{
+					const float T = FMath::Clamp(FVector::DotProduct(Entry.Location - Start, Segment) / SegmentSizeSquared, 0.0f, 1.0f);
+					Closest = Start + Segment * T;
+				}
+
+				if (FVector::DistSquared(Closest, Entry.Location) <= FMath::Square(CollectorRadius + Entry.Radius))
+				{
+					Collect(PickUpIndex, Collector);
+				}
+			}
+		}
+	}
+}
+
+void APickUpManager::Collect(int32 PickUpIndex, AActor* Collector)
+{
+	FPickUpEntry& Entry = PickUps[PickUpIndex];
+	Entry.bActive = false;
+
+	FPickUpCollectEvent& Event = PendingEvents[PendingEvents.AddDefaulted()];
+	Event.PickUpIndex = PickUpIndex;
+	Event.PickUp = Entry.Actor.Get();
+	Event.Collector = Collector;
+	Event.Location = Entry.Location;
+}
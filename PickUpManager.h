@@ -0,0 +1,226 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "PickUpRespawnWheel.h"
+#include "PickUpManager.generated.h"
+
+class APickUp;
+
+/** One pickup collected this frame */
+USTRUCT(BlueprintType)
+struct FPickUpCollectEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Handle of the pickup in the manager */
+	UPROPERTY(BlueprintReadOnly, Category = PickUp)
+	int32 PickUpIndex;
+
+	/** Actor the pickup was placed with, null for pickups added from code */
+	UPROPERTY(BlueprintReadOnly, Category = PickUp)
+	APickUp* PickUp;
+
+	/** Who drove through it */
+	UPROPERTY(BlueprintReadOnly, Category = PickUp)
+	AActor* Collector;
+
+	UPROPERTY(BlueprintReadOnly, Category = PickUp)
+	FVector Location;
+
+	FPickUpCollectEvent()
+		: PickUpIndex(INDEX_NONE)
+		, PickUp(nullptr)
+		, Collector(nullptr)
+		, Location(FVector::ZeroVector)
+	{
+	}
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPickUpsCollected, const TArray<FPickUpCollectEvent>&, Events);
+
+/**
+ * Owns every pickup in the world and tests them against the registered vehicles once per tick.
+ * Pickups live in a uniform grid on the XY plane, each vehicle's movement since the last tick is
+ * swept through the cells it touches. Nothing here uses overlap events or physics bodies.
+ */
+UCLASS()
+class SIMPLEVEHICLE_API APickUpManager : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Size of a grid cell, a few pickups per cell works best */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = PickUp)
+	float CellSize;
+
+	/** Radius of a collecting vehicle */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = PickUp)
+	float CollectorRadius;
+
+	/** Sweeps longer than this (teleports, respawns) only test the end point */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = PickUp)
+	float MaxSweepDistance;
+
+	/** Pickup spawned by the pool */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Pool)
+	TSubclassOf<APickUp> PoolClass;
+
+	/** Length of a respawn wheel slot in seconds */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Pool)
+	float RespawnResolution;
+
+	/** Slots in the respawn wheel, delays longer than a turn wait extra rounds */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Pool)
+	int32 RespawnSlots;
+
+	/** Everything collected in a frame, sent once at the end of the manager's tick */
+	UPROPERTY(BlueprintAssignable, Category = PickUp)
+	FOnPickUpsCollected OnPickUpsCollected;
+
+	/** The manager of a world, spawned on first use */
+	static APickUpManager* Get(UWorld* World);
+
+	/** The manager of a world if there is one */
+	static APickUpManager* Find(UWorld* World);
+
+	/**
+	 * Add a pickup.
+	 *
+	 * @param	Location	centre of the pickup
+	 * @param	Radius		collection radius
+	 * @param	Actor		optional actor to notify and hide when collected
+	 * @param	RespawnDelay	seconds until it comes back after being collected, 0 for never
+	 * @return handle of the pickup
+	 */
+	int32 AddPickUp(const FVector& Location, float Radius, APickUp* Actor, float RespawnDelay = 0.0f);
+
+	/** Remove a pickup, its handle may be reused */
+	void RemovePickUp(int32 PickUpIndex);
+
+	/** Enable or disable collection of a pickup */
+	void SetPickUpActive(int32 PickUpIndex, bool bActive);
+
+	bool IsPickUpActive(int32 PickUpIndex) const;
+
+	/** Start testing an actor's movement against the pickups */
+	void RegisterCollector(AActor* Collector);
+
+	void UnregisterCollector(AActor* Collector);
+
+	int32 GetNumPickUps() const { return PickUps.Num() - FreeList.Num(); }
+
+	/** Spawn pickups up front so the pool does not have to during play */
+	UFUNCTION(BlueprintCallable, Category = Pool)
+	void PrewarmPool(int32 Count);
+
+	/**
+	 * Place a pickup from the pool, only spawns when the pool is empty.
+	 *
+	 * @param	Location		where to put it
+	 * @param	RespawnDelay	seconds until it comes back after being collected, 0 for never
+	 */
+	UFUNCTION(BlueprintCallable, Category = Pool)
+	APickUp* AcquirePickUp(const FVector& Location, float RespawnDelay);
+
+	/** Take a pickup out of the level and back into the pool */
+	UFUNCTION(BlueprintCallable, Category = Pool)
+	void ReleasePickUp(APickUp* PickUp);
+
+	/** Actors created by the pool, in use or not */
+	UFUNCTION(BlueprintCallable, Category = Pool)
+	int32 GetPoolSize() const { return PoolSize; }
+
+	/** Actors spawned because the pool was empty, should stay 0 during a race */
+	UFUNCTION(BlueprintCallable, Category = Pool)
+	int32 GetPoolAllocations() const { return PoolAllocations; }
+
+	UFUNCTION(BlueprintCallable, Category = Pool)
+	int32 GetNumFreeInPool() const { return FreePool.Num(); }
+
+	UFUNCTION(BlueprintCallable, Category = Pool)
+	int32 GetNumPendingRespawns() const { return RespawnWheel.GetNumPending(); }
+
+	// Begin UObject interface
+	virtual void PostInitProperties() override;
+	// End UObject interface
+
+	// Begin Actor interface
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End Actor interface
+
+private:
+	struct FPickUpEntry
+	{
+		FVector Location;
+		float Radius;
+		TWeakObjectPtr<APickUp> Actor;
+		float RespawnDelay;
+		uint64 CellKey;
+		/** Next pickup in the same cell */
+		int32 NextInCell;
+		bool bActive;
+		bool bInUse;
+	};
+
+	struct FCollector
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FVector LastLocation;
+		bool bHasLastLocation;
+	};
+
+	FORCEINLINE int32 ToCell(float Coordinate) const
+	{
+		return FMath::FloorToInt(Coordinate * InvCellSize);
+	}
+
+	FORCEINLINE static uint64 MakeCellKey(int32 CellX, int32 CellY)
+	{
+		return ((uint64)(uint32)CellX << 32) | (uint64)(uint32)CellY;
+	}
+
+	void LinkToCell(int32 PickUpIndex);
+	void UnlinkFromCell(int32 PickUpIndex);
+
+	/** Test one swept sphere against the cells it touches */
+	void SweepCollector(AActor* Collector, const FVector& Start, const FVector& End);
+
+	/** Mark collected and queue the event */
+	void Collect(int32 PickUpIndex, AActor* Collector);
+
+	/** Respawn wheel callback */
+	void Respawn(int32 PickUpIndex);
+
+	/** Spawn a pooled pickup, hidden and not in the grid */
+	APickUp* SpawnPooledPickUp();
+
+	float InvCellSize;
+	/** Largest pickup radius, cells are searched this far around the sweep */
+	float MaxPickUpRadius;
+
+	TArray<FPickUpEntry> PickUps;
+	TArray<int32> FreeList;
+	/** First pickup of each occupied cell */
+	TMap<uint64, int32> CellHeads;
+
+	TArray<FCollector> Collectors;
+
+	/** Collected this tick, reused between ticks */
+	TArray<FPickUpCollectEvent> PendingEvents;
+
+	/** Pending respawns, indexed by pickup handle */
+	FPickUpRespawnWheel RespawnWheel;
+
+	/** Pooled pickups not in the level */
+	UPROPERTY()
+	TArray<APickUp*> FreePool;
+
+	/** Pooled pickups in the level, kept so GC does not collect them */
+	UPROPERTY()
+	TArray<APickUp*> UsedPool;
+
+	int32 PoolSize;
+	int32 PoolAllocations;
+};
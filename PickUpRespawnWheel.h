@@ -0,0 +1,165 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Hashed timing wheel for pickup respawns.
+ * Time is cut into slots of Resolution seconds, a timer lands in slot (Now + Delay) % NumSlots
+ * and waits the number of full turns left. Each pickup has at most one pending respawn, so the
+ * nodes are indexed by pickup handle and linked in place: scheduling, cancelling and advancing a
+ * slot never allocate, and a tick only visits the slots it passes.
+ */
+struct FPickUpRespawnWheel
+{
+	FPickUpRespawnWheel()
+		: Resolution(0.1f)
+		, InvResolution(10.0f)
+		, CurrentSlot(0)
+		, Accumulator(0.0)
+		, NumPending(0)
+	{
+	}
+
+	/** Setup the wheel, drops anything pending */
+	void Init(float InResolution, int32 NumSlots)
+	{
+		Resolution = FMath::Max(InResolution, 0.001f);
+		InvResolution = 1.0f / Resolution;
+		Slots.Init(INDEX_NONE, FMath::Max(NumSlots, 1));
+		for (FNode& Node : Nodes)
+		{
+			Node.bPending = false;
+		}
+		CurrentSlot = 0;
+		Accumulator = 0.0;
+		NumPending = 0;
+	}
+
+	/** Make room for handles up to Num - 1, call when the pool grows */
+	void Reserve(int32 Num)
+	{
+		while (Nodes.Num() < Num)
+		{
+			FNode& Node = Nodes[Nodes.AddUninitialized()];
+			Node.Next = INDEX_NONE;
+			Node.Prev = INDEX_NONE;
+			Node.Rounds = 0;
+			Node.bPending = false;
+		}
+	}
+
+	/** Fire Id after Delay seconds, replaces a pending timer for the same Id */
+	void Schedule(int32 Id, float Delay)
+	{
+		check(Slots.Num() > 0);
+		Reserve(Id + 1);
+		Cancel(Id);
+
+		// At least one slot away so a timer never fires in the tick it was set
+		const int32 Ticks = FMath::Max(FMath::CeilToInt(Delay * InvResolution), 1);
+		const int32 Slot = (CurrentSlot + Ticks) % Slots.Num();
+
+		FNode& Node = Nodes[Id];
+		Node.Rounds = (Ticks - 1) / Slots.Num();
+		Node.Prev = INDEX_NONE;
+		Node.Next = Slots[Slot];
+		Node.Slot = Slot;
+		Node.bPending = true;
+		if (Node.Next != INDEX_NONE)
+		{
+			Nodes[Node.Next].Prev = Id;
+		}
+		Slots[Slot] = Id;
+		++NumPending;
+	}
+
+	void Cancel(int32 Id)
+	{
+		if ((Nodes.IsValidIndex(Id) == false) || (Nodes[Id].bPending == false))
+		{
+			return;
+		}
+
+		FNode& Node = Nodes[Id];
+		if (Node.Prev != INDEX_NONE)
+		{
+			Nodes[Node.Prev].Next = Node.Next;
+		}
+		else
+		{
+			Slots[Node.Slot] = Node.Next;
+		}
+		if (Node.Next != INDEX_NONE)
+		{
+			Nodes[Node.Next].Prev = Node.Prev;
+		}
+		Node.bPending = false;
+		--NumPending;
+	}
+
+	bool IsPending(int32 Id) const
+	{
+		return (Nodes.IsValidIndex(Id) == true) && (Nodes[Id].bPending == true);
+	}
+
+	int32 GetNumPending() const { return NumPending; }
+
+	/**
+	 * Move time forward and call Fire(Id) for every timer that is due.
+	 * Fire may schedule again (a timer set from inside Fire lands in a later slot) but must not
+	 * cancel other timers.
+	 */
+	template<typename FireFunc>
+	void Advance(float DeltaSeconds, FireFunc Fire)
+	{
+		if ((NumPending == 0) || (Slots.Num() == 0))
+		{
+			// Nothing to wait for, keep the wheel where it is
+			Accumulator = 0.0;
+			return;
+		}
+
+		Accumulator += DeltaSeconds;
+		while (Accumulator >= Resolution)
+		{
+			Accumulator -= Resolution;
+			CurrentSlot = (CurrentSlot + 1) % Slots.Num();
+
+			int32 Id = Slots[CurrentSlot];
+			while (Id != INDEX_NONE)
+			{
+				FNode& Node = Nodes[Id];
+				const int32 Next = Node.Next;
+				if (Node.Rounds > 0)
+				{
+					--Node.Rounds;
+				}
+				else
+				{
+					Cancel(Id);
+					Fire(Id);
+				}
+				Id = Next;
+			}
+		}
+	}
+
+private:
+	struct FNode
+	{
+		int32 Next;
+		int32 Prev;
+		int32 Slot;
+		int32 Rounds;
+		bool bPending;
+	};
+
+	float Resolution;
+	float InvResolution;
+	/** Head node of each slot */
+	TArray<int32> Slots;
+	TArray<FNode> Nodes;
+	int32 CurrentSlot;
+	double Accumulator;
+	int32 NumPending;
+};
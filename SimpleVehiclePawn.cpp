@@ -12,6 +12,13 @@
 #include "Components/InputComponent.h"
 #include "Vehicles/WheeledVehicleMovementComponent4W.h"
 #include "Engine/SkeletalMesh.h"
+#include "FVehicleTuning.h"
+#include "FVehicleSurfaceMap.h"
+#include "VehicleStats.h"
+#include "VehicleProfiler.h"
+#include "PickUpManager.h"
+#include "VehicleAssetBundle.h"
+#include "VehicleLiveFeed.h"
 
 // Needed for VR Headset
 #include "Engine.h"
@@ -21,25 +28,35 @@ const FName ASimpleVehiclePawn::LookUpBinding("LookUp");
 const FName ASimpleVehiclePawn::LookRightBinding("LookRight");
 const FName ASimpleVehiclePawn::EngineAudioRPM("RPM");
 
+namespace
+{
+	void GatherSimpleVehicleAssets(TArray<FStringAssetReference>& OutAssets)
+	{
+		ASimpleVehiclePawn::GetPreloadAssets(ASimpleVehiclePawn::StaticClass(), OutAssets);
+	}
+
+	/** This module's own bundle, preloaded with the others when a map loads */
+	FVehicleAssetBundle SimpleVehicleAssets(TEXT("SimpleVehicle"), FGatherVehicleAssets::CreateStatic(&GatherSimpleVehicleAssets));
+}
+
 #define LOCTEXT_NAMESPACE "VehiclePawn"
 
 ASimpleVehiclePawn::ASimpleVehiclePawn(const class FPostConstructInitializeProperties& PCIP)
 	: Super(PCIP)
 {
-	// Car mesh
-	static ConstructorHelpers::FObjectFinder<USkeletalMesh> CarMesh(TEXT("/Game/Vehicle/Vehicle_SkelMesh.Vehicle_SkelMesh"));
-	Mesh->SetSkeletalMesh(CarMesh.Object);
-	
-	static ConstructorHelpers::FClassFinder<UObject> AnimBPClass(TEXT("/Game/Vehicle/VehicleAnimationBlueprint"));
+	// Car mesh and its animation, preloaded by FVehicleAssetBundle and set in PostInitProperties
+	CarMeshAsset = TAssetPtr<USkeletalMesh>(FStringAssetReference(TEXT("/Game/Vehicle/Vehicle_SkelMesh.Vehicle_SkelMesh")));
+	AnimClassAsset = TAssetSubclassOf<UAnimInstance>(FStringAssetReference(TEXT("/Game/Vehicle/VehicleAnimationBlueprint.VehicleAnimationBlueprint_C")));
 	Mesh->SetAnimationMode(EAnimationMode::AnimationBlueprint);
-	Mesh->SetAnimInstanceClass(AnimBPClass.Class);
+
+	SurfaceMap = nullptr;
+	FMemory::Memzero(WheelOffsets, sizeof(WheelOffsets));
 
 	// Setup friction materials
-	static ConstructorHelpers::FObjectFinder<UPhysicalMaterial> SlipperyMat(TEXT("/Game/PhysicsMaterials/Slippery.Slippery"));
-	SlipperyMaterial = SlipperyMat.Object;
-		
-	static ConstructorHelpers::FObjectFinder<UPhysicalMaterial> NonSlipperyMat(TEXT("/Game/PhysicsMaterials/NonSlippery.NonSlippery"));
-	NonSlipperyMaterial = NonSlipperyMat.Object;
+	SlipperyMaterialAsset = TAssetPtr<UPhysicalMaterial>(FStringAssetReference(TEXT("/Game/PhysicsMaterials/Slippery.Slippery")));
+	NonSlipperyMaterialAsset = TAssetPtr<UPhysicalMaterial>(FStringAssetReference(TEXT("/Game/PhysicsMaterials/NonSlippery.NonSlippery")));
+	SlipperyMaterial = nullptr;
+	NonSlipperyMaterial = nullptr;
 
 	UWheeledVehicleMovementComponent4W* Vehicle4W = CastChecked<UWheeledVehicleMovementComponent4W>(VehicleMovement);
 
@@ -63,42 +80,9 @@ ASimpleVehiclePawn::ASimpleVehiclePawn(const class FPostConstructInitializePrope
 	Vehicle4W->WheelSetups[3].BoneName = FName("PhysWheel_BR");
 	Vehicle4W->WheelSetups[3].AdditionalOffset = FVector(0.f, 8.f, 0.f);
 
-	// Adjust the tire loading
-	Vehicle4W->MinNormalizedTireLoad = 0.0f;
-	Vehicle4W->MinNormalizedTireLoadFiltered = 0.2f;
-	Vehicle4W->MaxNormalizedTireLoad = 2.0f;
-	Vehicle4W->MaxNormalizedTireLoadFiltered = 2.0f;
-
-	// Engine 
-	// Torque setup
-	Vehicle4W->MaxEngineRPM = 5700.0f;
-	Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve()->Reset();
-	Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve()->AddKey(0.0f, 400.0f);
-	Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve()->AddKey(1890.0f, 500.0f);
-	Vehicle4W->EngineSetup.TorqueCurve.GetRichCurve()->AddKey(5730.0f, 400.0f);
- 
-	// Adjust the steering 
-	Vehicle4W->SteeringCurve.GetRichCurve()->Reset();
-	Vehicle4W->SteeringCurve.GetRichCurve()->AddKey(0.0f, 1.0f);
-	Vehicle4W->SteeringCurve.GetRichCurve()->AddKey(40.0f, 0.7f);
-	Vehicle4W->SteeringCurve.GetRichCurve()->AddKey(120.0f, 0.6f);
-			
- 	// Transmission	
-	// We want 4wd
-	Vehicle4W->DifferentialSetup.DifferentialType = EVehicleDifferential4W::LimitedSlip_4W;
-	
-	// Drive the front wheels a little more than the rear
-	Vehicle4W->DifferentialSetup.FrontRearSplit = 0.65;
-
-	// Automatic gearbox
-	Vehicle4W->TransmissionSetup.bUseGearAutoBox = true;
-	
-	// Physics settings
-	// Adjust the center of mass - the buggy is quite low
-	Vehicle4W->COMOffset = FVector(8.0f, 0.0f, 0.0f);
-
-	// Set the inertia scale. This controls how the mass of the vehicle is distributed.
-	Vehicle4W->InertiaTensorScale = FVector(1.0f, 1.333f, 1.2f);
+	// Engine, steering, transmission and chassis come from the shared tuning asset
+	Tuning = UFVehicleTuning::LoadSharedAsset();
+	GetTuning()->ApplyTo(Vehicle4W);
 
 	// Create a spring arm component for our chase camera
 	SpringArm = PCIP.CreateDefaultSubobject<USpringArmComponent>(this, TEXT("SpringArm"));
@@ -145,17 +129,66 @@ ASimpleVehiclePawn::ASimpleVehiclePawn(const class FPostConstructInitializePrope
 	InCarGear->AttachTo(Mesh);
 	
 	// Setup the audio component and allocate it a sound cue
-	static ConstructorHelpers::FObjectFinder<USoundCue> SoundCue(TEXT("/Game/Sound/Engine_Loop_Cue.Engine_Loop_Cue"));
+	EngineSoundAsset = TAssetPtr<USoundCue>(FStringAssetReference(TEXT("/Game/Sound/Engine_Loop_Cue.Engine_Loop_Cue")));
 	EngineSoundComponent = PCIP.CreateDefaultSubobject<UAudioComponent>(this, TEXT("EngineSound"));
-	EngineSoundComponent->SetSound(SoundCue.Object);
 	EngineSoundComponent->AttachTo(Mesh);
 
 	// Colors for the in-car gear display. One for normal one for reverse
 	GearDisplayReverseColor = FColor(255, 0, 0, 255);
 	GearDisplayColor = FColor(255, 255, 255, 255);
 
-	bIsLowFriction = false;
 	bInReverseGear = false;
+	PendingInCarHUDFields = 0;
+	ThrottleInput = 0.0f;
+	SteeringInput = 0.0f;
+	bHandbrakeInput = false;
+}
+
+void ASimpleVehiclePawn::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Blueprints can pick a different tuning asset
+	if (Tuning != nullptr)
+	{
+		Tuning->ApplyTo(CastChecked<UWheeledVehicleMovementComponent4W>(VehicleMovement));
+	}
+
+	// The physics vehicle is built from the mesh when the components register, which is before BeginPlay
+	if (HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) == false)
+	{
+		ResolveCarMesh();
+	}
+}
+
+void ASimpleVehiclePawn::ResolveCarMesh()
+{
+	// Leave what a Blueprint set on the component itself
+	if (Mesh->SkeletalMesh == nullptr)
+	{
+		USkeletalMesh* CarMesh = CarMeshAsset.Get();
+		if ((CarMesh == nullptr) && (CarMeshAsset.IsNull() == false))
+		{
+			// Spawned before the bundle got to it
+			CarMesh = LoadObject<USkeletalMesh>(nullptr, *CarMeshAsset.ToStringReference().ToString());
+		}
+		Mesh->SetSkeletalMesh(CarMesh);
+	}
+
+	if (Mesh->AnimBlueprintGeneratedClass == nullptr)
+	{
+		UClass* AnimClass = AnimClassAsset.Get();
+		if ((AnimClass == nullptr) && (AnimClassAsset.IsNull() == false))
+		{
+			AnimClass = LoadObject<UClass>(nullptr, *AnimClassAsset.ToStringReference().ToString());
+		}
+		Mesh->SetAnimInstanceClass(AnimClass);
+	}
+}
+
+const UFVehicleTuning* ASimpleVehiclePawn::GetTuning() const
+{
+	return (Tuning != nullptr) ? Tuning : GetDefault<UFVehicleTuning>();
 }
 
 void ASimpleVehiclePawn::SetupPlayerInputComponent(class UInputComponent* InputComponent)
@@ -178,22 +211,26 @@ void ASimpleVehiclePawn::SetupPlayerInputComponent(class UInputComponent* InputC
 void ASimpleVehiclePawn::MoveForward(float Val)
 {
 	GetVehicleMovementComponent()->SetThrottleInput(Val);
+	ThrottleInput = Val;
 
 }
 
 void ASimpleVehiclePawn::MoveRight(float Val)
 {
 	GetVehicleMovementComponent()->SetSteeringInput(Val);
+	SteeringInput = Val;
 }
 
 void ASimpleVehiclePawn::OnHandbrakePressed()
 {
 	GetVehicleMovementComponent()->SetHandbrakeInput(true);
+	bHandbrakeInput = true;
 }
 
 void ASimpleVehiclePawn::OnHandbrakeReleased()
 {
 	GetVehicleMovementComponent()->SetHandbrakeInput(false);
+	bHandbrakeInput = false;
 }
 
 void ASimpleVehiclePawn::OnToggleCamera()
@@ -203,6 +240,8 @@ void ASimpleVehiclePawn::OnToggleCamera()
 
 void ASimpleVehiclePawn::EnableIncarView(const bool bState)
 {
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleEnableIncarView, EnableIncarView);
+
 	//if (bState != bInCarCameraActive)
 	//{
 	//	bInCarCameraActive = bState;
@@ -232,41 +271,127 @@ void ASimpleVehiclePawn::EnableIncarView(const bool bState)
 
 void ASimpleVehiclePawn::Tick(float Delta)
 {
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehiclePawnTick, PawnTick);
+	FVehicleProfiler::Get().AddCount(FVehicleProfiler::VehiclesTicked, 1);
+
+	// Run the engine independent part of the tick
+	FVehicleCoreInput CoreInput;
+	GatherCoreInput(CoreInput);
+	CoreInput.DeltaSeconds = Delta;
+	FVehicleCoreOutput CoreOutput;
+	Core.Tick(CoreInput, FVehicleFrameContext::Capture(), CoreOutput);
+
 	// Setup the flag to say we are in reverse gear
-	bInReverseGear = VehicleMovement->GetCurrentGear() < 0;
+	bInReverseGear = CoreOutput.bInReverseGear;
 	
 	// Update phsyics material
-	UpdatePhysicsMaterial();
+	UpdatePhysicsMaterial(CoreOutput.FrictionChange);
 
 	// Update the strings used in the hud (incar and onscreen)
-	UpdateHUDStrings();
+	UpdateHUDStrings(CoreOutput.ChangedHUDFields);
 
 	// Set the string in the incar hud
 	SetupInCarHUD();
 
-	if ((GEngine->HMDDevice.IsValid() == false) || ((GEngine->HMDDevice.IsValid() == true ) && ( (GEngine->HMDDevice->IsHeadTrackingAllowed() == false) || (GEngine->IsStereoscopic3D() == false))))
+	if ( (InputComponent) && (CoreOutput.bApplyManualHeadLook == true) )
 	{
-		if ( (InputComponent) && (bInCarCameraActive == true ))
-		{
-			FRotator HeadRotation = InternalCamera->RelativeRotation;
-			HeadRotation.Pitch += InputComponent->GetAxisValue(LookUpBinding);
-			HeadRotation.Yaw += InputComponent->GetAxisValue(LookRightBinding);
-			InternalCamera->RelativeRotation = HeadRotation;
-		}
-	}	
+		FRotator HeadRotation = InternalCamera->RelativeRotation;
+		HeadRotation.Pitch += InputComponent->GetAxisValue(LookUpBinding);
+		HeadRotation.Yaw += InputComponent->GetAxisValue(LookRightBinding);
+		InternalCamera->RelativeRotation = HeadRotation;
+	}
 
 	// Pass the engine RPM to the sound component
-	float RPMToAudioScale = 2500.0f / VehicleMovement->GetEngineMaxRotationSpeed();
-	EngineSoundComponent->SetFloatParameter(EngineAudioRPM, VehicleMovement->GetEngineRotationSpeed()*RPMToAudioScale);
+	EngineSoundComponent->SetFloatParameter(EngineAudioRPM, CoreOutput.AudioRPM);
+
+	PublishLiveFeed();
+}
+
+void ASimpleVehiclePawn::GatherCoreInput(FVehicleCoreInput& OutInput) const
+{
+	OutInput.ForwardSpeed = VehicleMovement->GetForwardSpeed();
+	OutInput.CurrentGear = VehicleMovement->GetCurrentGear();
+	OutInput.EngineRotationSpeed = VehicleMovement->GetEngineRotationSpeed();
+	OutInput.EngineMaxRotationSpeed = VehicleMovement->GetEngineMaxRotationSpeed();
+	OutInput.UpZ = GetActorUpVector().Z;
+	OutInput.DeltaSeconds = 0.0f;
+	OutInput.NumWheels = ARRAY_COUNT(WheelOffsets);
+	OutInput.NumSlipperyWheels = (SurfaceMap != nullptr) ? SurfaceMap->CountSlipperyWheels(GetActorTransform(), WheelOffsets, ARRAY_COUNT(WheelOffsets)) : 0;
+	OutInput.bInCarCameraActive = bInCarCameraActive;
+	OutInput.bHasLapTimer = false;
+	OutInput.LapTimeUs = 0;
+	OutInput.BestLapUs = 0;
+}
+
+void ASimpleVehiclePawn::PublishLiveFeed()
+{
+	FVehicleLiveFeed& LiveFeed = FVehicleLiveFeed::Get();
+	if (LiveFeed.IsOpen() == false)
+	{
+		return;
+	}
+
+	// No lap timer on this car, the lap fields stay 0
+	VehicleLiveFeedFormat::FSample Sample;
+	FVehicleLiveFeed::FillSample(this, Sample);
+	Sample.Throttle = ThrottleInput;
+	Sample.Steering = SteeringInput;
+	Sample.bHandbrake = bHandbrakeInput ? 1 : 0;
+	LiveFeed.Publish(Sample);
+}
+
+void ASimpleVehiclePawn::GetPreloadAssets(UClass* Class, TArray<FStringAssetReference>& OutAssets)
+{
+	const ASimpleVehiclePawn* Defaults = CastChecked<ASimpleVehiclePawn>(Class->GetDefaultObject());
+	OutAssets.AddUnique(Defaults->CarMeshAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->AnimClassAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->SlipperyMaterialAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->NonSlipperyMaterialAsset.ToStringReference());
+	OutAssets.AddUnique(Defaults->EngineSoundAsset.ToStringReference());
+}
+
+void ASimpleVehiclePawn::OnVehicleAssetsLoaded()
+{
+	if (IsPendingKill() == true)
+	{
+		return;
+	}
+
+	SlipperyMaterial = SlipperyMaterialAsset.Get();
+	NonSlipperyMaterial = NonSlipperyMaterialAsset.Get();
+
+	// Wheel contact points for the surface map, they do not move relative to the actor
+	UWheeledVehicleMovementComponent4W* Vehicle4W = CastChecked<UWheeledVehicleMovementComponent4W>(VehicleMovement);
+	const FTransform ActorTransform = GetActorTransform();
+	for (int32 WheelIndex = 0; WheelIndex < ARRAY_COUNT(WheelOffsets); ++WheelIndex)
+	{
+		WheelOffsets[WheelIndex] = ActorTransform.InverseTransformPosition(Mesh->GetBoneLocation(Vehicle4W->WheelSetups[WheelIndex].BoneName));
+	}
+
+	// Start an engine sound playing
+	EngineSoundComponent->SetSound(EngineSoundAsset.Get());
+	EngineSoundComponent->Play();
 }
 
 void ASimpleVehiclePawn::BeginPlay()
 {
+	if (SurfaceMap != nullptr)
+	{
+		Core.FrictionHysteresis = SurfaceMap->GetFrictionHysteresis();
+	}
+
 	// Enable in car view if HMD is attached
 	EnableIncarView(GEngine->HMDDevice.IsValid());
 
-	// Start an engine sound playing
-	EngineSoundComponent->Play();
+	// Materials and sound, straight away unless we spawned before the preload finished.
+	// A Blueprint subclass may point at assets the bundle was not asked for.
+	TArray<FStringAssetReference> ClassAssets;
+	GetPreloadAssets(GetClass(), ClassAssets);
+	SimpleVehicleAssets.AddAssets(ClassAssets);
+	SimpleVehicleAssets.WhenLoaded(FSimpleDelegate::CreateUObject(this, &ASimpleVehiclePawn::OnVehicleAssetsLoaded));
+
+	// Pickups are collected by the manager from our movement
+	APickUpManager::Get(GetWorld())->RegisterCollector(this);
 }
 
 void ASimpleVehiclePawn::OnResetVR()
@@ -279,29 +404,28 @@ void ASimpleVehiclePawn::OnResetVR()
 	}
 }
 
-void ASimpleVehiclePawn::UpdateHUDStrings()
+void ASimpleVehiclePawn::UpdateHUDStrings(uint32 ChangedFields)
 {
-	float KPH = FMath::Abs(VehicleMovement->GetForwardSpeed()) * 0.036f;
-	int32 KPH_int = FMath::FloorToInt(KPH);
-	float RapTime = GetTickCount();
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleUpdateHUDStrings, UpdateHUDStrings);
 
-	// Using FText because this is display text that should be localizable
-	SpeedDisplayString = FText::Format(LOCTEXT("SpeedFormat", "{0} km/h"), FText::AsNumber(KPH_int));
-	//RapTimeDisplayString = FText::Format(LOCTEXT("RapTime", "{00:00:000} sec"), FText::AsNumber(RapTime));
-	
-	if (bInReverseGear == true)
+	// Using FText because this is display text that should be localizable. The core only
+	// reformats a string when its displayed value changes.
+	const FVehicleHUDTextCache& HUDText = Core.HUDText;
+	if (ChangedFields & FVehicleHUDTextCache::Speed)
 	{
-		GearDisplayString = FText(LOCTEXT("ReverseGear", "R"));
+		SpeedDisplayString = HUDText.SpeedText;
 	}
-	else
+	if (ChangedFields & FVehicleHUDTextCache::Gear)
 	{
-		int32 Gear = VehicleMovement->GetCurrentGear();
-		GearDisplayString = (Gear == 0) ? LOCTEXT("N", "N") : FText::AsNumber(Gear);
-	}	
+		GearDisplayString = HUDText.GearText;
+	}
+	PendingInCarHUDFields |= ChangedFields;
 }
 
 void ASimpleVehiclePawn::SetupInCarHUD()
 {
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleSetupInCarHUD, SetupInCarHUD);
+
 	APlayerController* PlayerController = Cast<APlayerController>(GetController());
 	if ((PlayerController != nullptr) && (InCarSpeed.IsValid() == true) && (InCarGear.IsValid()==true) )
 	{
@@ -310,35 +434,42 @@ void ASimpleVehiclePawn::SetupInCarHUD()
 		//FVector HUD_Pos = FVector(ViewportSize.X / 1280.f, ViewportSize.Y / 720.f, 0);
 
 		//InCarSpeed->SetRelativeLocation(HUD_Pos);
-		InCarSpeed->SetText(SpeedDisplayString.ToString());
-		InCarGear->SetText(GearDisplayString.ToString());
-
-		
-		if (bInReverseGear == false)
+		// Only push what changed, each SetText rebuilds the text mesh
+		if (PendingInCarHUDFields & FVehicleHUDTextCache::Speed)
 		{
-			InCarGear->SetTextRenderColor(GearDisplayColor);
+			InCarSpeed->SetText(SpeedDisplayString.ToString());
 		}
-		else
+
+		if (PendingInCarHUDFields & FVehicleHUDTextCache::Gear)
 		{
-			InCarGear->SetTextRenderColor(GearDisplayReverseColor);
+			InCarGear->SetText(GearDisplayString.ToString());
+
+			if (bInReverseGear == false)
+			{
+				InCarGear->SetTextRenderColor(GearDisplayColor);
+			}
+			else
+			{
+				InCarGear->SetTextRenderColor(GearDisplayReverseColor);
+			}
 		}
+		PendingInCarHUDFields = 0;
 	}
 }
 
-void ASimpleVehiclePawn::UpdatePhysicsMaterial()
+void ASimpleVehiclePawn::UpdatePhysicsMaterial(FVehicleCoreOutput::EFrictionChange FrictionChange)
 {
-	if (GetActorUpVector().Z < 0)
+	VEHICLE_SCOPE_CYCLE_COUNTER(STAT_VehicleUpdatePhysicsMaterial, UpdatePhysicsMaterial);
+
+	if (FrictionChange == FVehicleCoreOutput::ToNonSlippery)
 	{
-		if (bIsLowFriction == true)
-		{
-			Mesh->SetPhysMaterialOverride(NonSlipperyMaterial);
-			bIsLowFriction = false;
-		}
-		else
-		{
-			Mesh->SetPhysMaterialOverride(SlipperyMaterial);
-			bIsLowFriction = true;
-		}
+		Mesh->SetPhysMaterialOverride(NonSlipperyMaterial);
+		FVehicleProfiler::Get().AddCount(FVehicleProfiler::MaterialSwaps, 1);
+	}
+	else if (FrictionChange == FVehicleCoreOutput::ToSlippery)
+	{
+		Mesh->SetPhysMaterialOverride(SlipperyMaterial);
+		FVehicleProfiler::Get().AddCount(FVehicleProfiler::MaterialSwaps, 1);
 	}
 }
 
@@ -1,13 +1,18 @@
 // Copyright 1998-2014 Epic Games, Inc. All Rights Reserved.
 #pragma once
 #include "GameFramework/WheeledVehicle.h"
+#include "VehicleCore.h"
 #include "SimpleVehiclePawn.generated.h"
 
 class UPhysicalMaterial;
+class USoundCue;
+class UAnimInstance;
 class UCameraComponent;
 class USpringArmComponent;
 class UTextRenderComponent;
 class UInputComponent;
+class UFVehicleTuning;
+class UFVehicleSurfaceMap;
 
 UCLASS(config=Game)
 class ASimpleVehiclePawn : public AWheeledVehicle
@@ -70,6 +75,40 @@ class ASimpleVehiclePawn : public AWheeledVehicle
 	UPROPERTY(Category = Camera, VisibleDefaultsOnly, BlueprintReadOnly)
 	bool bInReverseGear;
 
+	/** Car mesh, preloaded with FVehicleAssetBundle and set before the components register */
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<USkeletalMesh> CarMeshAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetSubclassOf<UAnimInstance> AnimClassAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<UPhysicalMaterial> SlipperyMaterialAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<UPhysicalMaterial> NonSlipperyMaterialAsset;
+
+	UPROPERTY(Category = Assets, EditDefaultsOnly)
+	TAssetPtr<USoundCue> EngineSoundAsset;
+
+	/** The assets of a class's defaults, for FVehicleAssetBundle */
+	static void GetPreloadAssets(UClass* Class, TArray<FStringAssetReference>& OutAssets);
+
+	/** Engine, steering and chassis setup, the built in defaults are used when not set */
+	UPROPERTY(Category = Vehicle, EditDefaultsOnly, BlueprintReadOnly)
+	UFVehicleTuning* Tuning;
+
+	/** The tuning in use, never null */
+	const UFVehicleTuning* GetTuning() const;
+
+	/** Baked track surfaces the wheels are looked up in, grip everywhere when not set */
+	UPROPERTY(Category = Vehicle, EditAnywhere, BlueprintReadOnly)
+	UFVehicleSurfaceMap* SurfaceMap;
+
+	/** Physics material switches so far, should only move when the car really changes surface */
+	UFUNCTION(Category = Vehicle, BlueprintCallable)
+	int32 GetFrictionChangeCount() const { return Core.NumFrictionChanges; }
+
 	/** Initial offset of incar camera */
 	FVector InternalCameraOrigin;
 
@@ -77,6 +116,10 @@ class ASimpleVehiclePawn : public AWheeledVehicle
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 	// End Pawn interface
 
+	// Begin UObject interface
+	virtual void PostInitProperties() override;
+	// End UObject interface
+
 	// Begin Actor interface
 	virtual void Tick(float Delta) override;
 	virtual void BeginPlay() override;
@@ -89,7 +132,7 @@ class ASimpleVehiclePawn : public AWheeledVehicle
 	void SetupInCarHUD();
 
 	/** Update the physics material used by the vehicle mesh */
-	void UpdatePhysicsMaterial();
+	void UpdatePhysicsMaterial(FVehicleCoreOutput::EFrictionChange FrictionChange);
 
 	/** Handle pressing right */
 	void MoveRight(float Val);
@@ -115,10 +158,33 @@ private:
 	void EnableIncarView( const bool bState );
 
 	/** Update the gear and speed strings */
-	void UpdateHUDStrings();
+	void UpdateHUDStrings(uint32 ChangedFields);
+
+	/** Set the car mesh and its animation, loading them if the bundle does not have them yet */
+	void ResolveCarMesh();
+
+	/** Apply the bundle's materials and sound */
+	void OnVehicleAssetsLoaded();
+
+	/** Read what the vehicle core needs from the movement component */
+	void GatherCoreInput(FVehicleCoreInput& OutInput) const;
+
+	/** Copy this tick's state to the shared memory live feed when it is open */
+	void PublishLiveFeed();
+
+	/** Engine independent tick logic and the cached HUD strings */
+	FVehicleCore Core;
+	/** Fields changed since they were last pushed to the in-car text components (FVehicleHUDTextCache::EField) */
+	uint32 PendingInCarHUDFields;
+
+	/** Last input given to the movement component, for the live feed */
+	float ThrottleInput;
+	float SteeringInput;
+	bool bHandbrakeInput;
+
+	/** Wheel positions relative to the actor, read from the bones in BeginPlay */
+	FVector WheelOffsets[4];
 
-	/* Are we on a 'slippery' surface */
-	bool bIsLowFriction;
 	/** Slippery Material instance */
 	UPhysicalMaterial* SlipperyMaterial;
 	/** Non Slippery Material instance */
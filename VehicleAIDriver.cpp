@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleAIDriver.h"
+#include "VehicleRacingLine.h"
+
+int32 FVehicleAIDriverBatch::Add(const FVehicleAIDriverParams& InParams, const FVehicleRacingLine* InLine)
+{
+	const int32 Index = Location.Add(FVector::ZeroVector);
+	Forward.Add(FVector::ForwardVector);
+	Right.Add(FVector::RightVector);
+	Speed.Add(0.0f);
+	SteeringScale.Add(1.0f);
+	Params.Add(InParams);
+	Line.Add(InLine);
+	Cursor.Add(INDEX_NONE);
+	Throttle.Add(0.0f);
+	Steering.Add(0.0f);
+	bHandbrake.Add(0);
+	return Index;
+}
+
+void FVehicleAIDriverBatch::RemoveAtSwap(int32 Index)
+{
+	Location.RemoveAtSwap(Index);
+	Forward.RemoveAtSwap(Index);
+	Right.RemoveAtSwap(Index);
+	Speed.RemoveAtSwap(Index);
+	SteeringScale.RemoveAtSwap(Index);
+	Params.RemoveAtSwap(Index);
+	Line.RemoveAtSwap(Index);
+	Cursor.RemoveAtSwap(Index);
+	Throttle.RemoveAtSwap(Index);
+	Steering.RemoveAtSwap(Index);
+	bHandbrake.RemoveAtSwap(Index);
+}
+
+void FVehicleAIDriverBatch::Compute(int32 Start, int32 End)
+{
+	for (int32 Index = Start; Index < End; ++Index)
+	{
+		const FVehicleRacingLine* RacingLine = Line[Index];
+		if ((RacingLine == nullptr) || (RacingLine->Num() < 2))
+		{
+			// Nothing to follow, stay put
+			Throttle[Index] = 0.0f;
+			Steering[Index] = 0.0f;
+			bHandbrake[Index] = 1;
+			continue;
+		}
+
+		const FVehicleAIDriverParams& Driver = Params[Index];
+		const float CarSpeed = Speed[Index];
+		const float InvSpacing = 1.0f / RacingLine->Spacing;
+
+		const int32 Nearest = RacingLine->FindNearest(Location[Index], Cursor[Index]);
+		Cursor[Index] = Nearest;
+
+		// Steer at a point ahead on the line
+		const float Lookahead = Driver.MinLookahead + FMath::Abs(CarSpeed) * Driver.LookaheadTime;
+		const FVector ToTarget = RacingLine->Points[RacingLine->Wrap(Nearest + FMath::CeilToInt(Lookahead * InvSpacing))] - Location[Index];
+		const float AngleToTarget = FMath::RadiansToDegrees(FMath::Atan2(FVector::DotProduct(ToTarget, Right[Index]), FVector::DotProduct(ToTarget, Forward[Index])));
+		const float AvailableSteer = Driver.MaxSteerAngle * FMath::Max(SteeringScale[Index], 0.1f);
+		Steering[Index] = FMath::Clamp(AngleToTarget / AvailableSteer, -1.0f, 1.0f);
+
+		// Drive at the speed of the point we are about to reach, the profile already has the braking in it
+		const int32 SpeedPoint = RacingLine->Wrap(Nearest + FMath::CeilToInt(FMath::Max(CarSpeed, 0.0f) * 0.25f * InvSpacing));
+		const float Target = RacingLine->TargetSpeed[SpeedPoint] * Driver.SpeedScale;
+		Throttle[Index] = FMath::Clamp((Target - CarSpeed) * Driver.SpeedGain, -1.0f, 1.0f);
+
+		bHandbrake[Index] = ((FMath::Abs(AngleToTarget) > Driver.HandbrakeAngle) && (CarSpeed > Driver.HandbrakeMinSpeed)) ? 1 : 0;
+	}
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+struct FVehicleRacingLine;
+
+/** How an AI driver follows the racing line */
+struct FVehicleAIDriverParams
+{
+	/** Distance ahead of the car steered at, grows with speed */
+	float MinLookahead;
+	float LookaheadTime;
+	/** Steering angle of the front wheels at full lock, in degrees */
+	float MaxSteerAngle;
+	/** Throttle per cm/s of speed error */
+	float SpeedGain;
+	/** Share of the target speed driven at, below 1 for slower opponents */
+	float SpeedScale;
+	/** Pull the handbrake above this steering error (degrees) at speed */
+	float HandbrakeAngle;
+	float HandbrakeMinSpeed;
+
+	FVehicleAIDriverParams()
+		: MinLookahead(600.0f)
+		, LookaheadTime(0.6f)
+		, MaxSteerAngle(50.0f)
+		, SpeedGain(0.005f)
+		, SpeedScale(1.0f)
+		, HandbrakeAngle(70.0f)
+		, HandbrakeMinSpeed(800.0f)
+	{
+	}
+};
+
+/**
+ * State of all AI drivers, one array per field.
+ * The game thread fills the inputs, Compute works on any range of drivers without touching
+ * anything else, so ranges can run on different threads, then the game thread applies the outputs.
+ */
+struct FVehicleAIDriverBatch
+{
+	// Inputs
+	TArray<FVector> Location;
+	TArray<FVector> Forward;
+	TArray<FVector> Right;
+	/** Forward speed in cm/s */
+	TArray<float> Speed;
+	/** Steering available at the current speed (UFVehicleTuning::GetSteeringScale) */
+	TArray<float> SteeringScale;
+	TArray<FVehicleAIDriverParams> Params;
+	/** Line each driver follows, must not change while Compute runs */
+	TArray<const FVehicleRacingLine*> Line;
+
+	// Kept between frames
+	/** Nearest racing line point */
+	TArray<int32> Cursor;
+
+	// Outputs
+	TArray<float> Throttle;
+	TArray<float> Steering;
+	TArray<uint8> bHandbrake;
+
+	int32 Num() const { return Location.Num(); }
+
+	int32 Add(const FVehicleAIDriverParams& InParams, const FVehicleRacingLine* InLine);
+	void RemoveAtSwap(int32 Index);
+
+	/** Work out the controls of drivers [Start, End) */
+	void Compute(int32 Start, int32 End);
+};
@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleAssetBundle.h"
+#include "FPawn.h"
+#include "FHud.h"
+#include "FGhostCar.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVehicleAssets, Log, All);
+
+namespace
+{
+	/** The assets of this module's classes */
+	void GatherVehicleAssets(TArray<FStringAssetReference>& OutAssets)
+	{
+		AFPawn::GetPreloadAssets(AFPawn::StaticClass(), OutAssets);
+		AFHUD::GetPreloadAssets(OutAssets);
+		AFGhostCar::GetPreloadAssets(AFGhostCar::StaticClass(), OutAssets);
+	}
+
+	/** Starts the preload whenever a map has loaded */
+	struct FVehicleAssetBundleStartup
+	{
+		FVehicleAssetBundleStartup()
+		{
+			// This module's bundle has to exist before the first map loads
+			FVehicleAssetBundle::Get();
+			FCoreUObjectDelegates::PostLoadMap.AddStatic(&FVehicleAssetBundle::OnPostLoadMap);
+		}
+	};
+
+	FVehicleAssetBundleStartup VehicleAssetBundleStartup;
+}
+
+FVehicleAssetBundle& FVehicleAssetBundle::Get()
+{
+	static FVehicleAssetBundle Bundle(TEXT("Vehicle"), FGatherVehicleAssets::CreateStatic(&GatherVehicleAssets));
+	return Bundle;
+}
+
+TArray<FVehicleAssetBundle*>& FVehicleAssetBundle::GetAllBundles()
+{
+	static TArray<FVehicleAssetBundle*> Bundles;
+	return Bundles;
+}
+
+FVehicleAssetBundle::FVehicleAssetBundle(const TCHAR* InName, const FGatherVehicleAssets& InGather)
+	: Name(InName)
+	, Gather(InGather)
+	, NumLoaded(0)
+	, bLoading(false)
+	, bLoaded(false)
+	, MapLoadTime(0.0)
+	, StartTime(0.0)
+	, LoadedTime(0.0)
+	, FirstWaitTime(0.0)
+	, FirstWaitSeconds(0.0)
+{
+	GetAllBundles().Add(this);
+}
+
+FVehicleAssetBundle::~FVehicleAssetBundle()
+{
+	GetAllBundles().RemoveSingleSwap(this);
+}
+
+void FVehicleAssetBundle::OnPostLoadMap()
+{
+	for (FVehicleAssetBundle* Bundle : GetAllBundles())
+	{
+		if (Bundle->MapLoadTime == 0.0)
+		{
+			Bundle->MapLoadTime = FPlatformTime::Seconds();
+		}
+		Bundle->StartPreload();
+	}
+}
+
+void FVehicleAssetBundle::StartPreload()
+{
+	check(IsInGameThread());
+	if ((bLoading == true) || (bLoaded == true))
+	{
+		return;
+	}
+
+	// What the default objects point at, every class adds its own
+	Gather.ExecuteIfBound(Assets);
+
+	bLoading = true;
+	NumLoaded = 0;
+	StartTime = FPlatformTime::Seconds();
+	UE_LOG(LogVehicleAssets, Log, TEXT("Preloading %d %s assets"), Assets.Num(), *Name);
+
+	if (Assets.Num() == 0)
+	{
+		OnAssetLoaded();
+		return;
+	}
+
+	// One request each, so progress can be reported as they come in
+	for (const FStringAssetReference& Asset : Assets)
+	{
+		RequestAsset(Asset);
+	}
+}
+
+void FVehicleAssetBundle::AddAssets(const TArray<FStringAssetReference>& NewAssets)
+{
+	check(IsInGameThread());
+	for (const FStringAssetReference& Asset : NewAssets)
+	{
+		if ((Asset.IsValid() == false) || (Assets.Contains(Asset) == true))
+		{
+			continue;
+		}
+
+		Assets.Add(Asset);
+		if ((bLoading == false) && (bLoaded == false))
+		{
+			// Requested with the rest when the preload starts
+			continue;
+		}
+
+		if (bLoaded == true)
+		{
+			// Loading again until the new ones are in
+			bLoaded = false;
+			bLoading = true;
+		}
+		RequestAsset(Asset);
+	}
+}
+
+void FVehicleAssetBundle::RequestAsset(const FStringAssetReference& Asset)
+{
+	Streamable.RequestAsyncLoad(Asset, FStreamableDelegate::CreateRaw(this, &FVehicleAssetBundle::OnAssetLoaded));
+}
+
+void FVehicleAssetBundle::OnAssetLoaded()
+{
+	NumLoaded = FMath::Min(NumLoaded + 1, Assets.Num());
+	OnProgress.Broadcast(GetProgress());
+	if (NumLoaded < Assets.Num())
+	{
+		return;
+	}
+
+	for (const FStringAssetReference& Asset : Assets)
+	{
+		if (Asset.ResolveObject() == nullptr)
+		{
+			UE_LOG(LogVehicleAssets, Warning, TEXT("Could not load %s"), *Asset.ToString());
+		}
+	}
+
+	bLoading = false;
+	bLoaded = true;
+	LoadedTime = FPlatformTime::Seconds();
+	if (FirstWaitTime != 0.0)
+	{
+		FirstWaitSeconds = LoadedTime - FirstWaitTime;
+	}
+	LogStats();
+
+	// Callbacks may ask for more callbacks
+	TArray<FSimpleDelegate> Callbacks;
+	Exchange(Callbacks, Waiting);
+	for (const FSimpleDelegate& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound();
+	}
+}
+
+void FVehicleAssetBundle::WhenLoaded(const FSimpleDelegate& Callback)
+{
+	if (bLoaded == true)
+	{
+		Callback.ExecuteIfBound();
+		return;
+	}
+
+	if (FirstWaitTime == 0.0)
+	{
+		FirstWaitTime = FPlatformTime::Seconds();
+	}
+	Waiting.Add(Callback);
+
+	// Spawned without a map load, eg in the editor before PostLoadMap
+	StartPreload();
+}
+
+void FVehicleAssetBundle::LogStats() const
+{
+	if (bLoaded == false)
+	{
+		UE_LOG(LogVehicleAssets, Display, TEXT("%s assets: %d/%d loaded, %s"), *Name, NumLoaded, Assets.Num(), (bLoading == true) ? TEXT("loading") : TEXT("not started"));
+		return;
+	}
+
+	UE_LOG(LogVehicleAssets, Display, TEXT("%s assets: %d loaded in %.1f ms, %.1f ms after the map loaded, first caller waited %.1f ms"),
+		*Name, Assets.Num(), (LoadedTime - StartTime) * 1000.0,
+		(MapLoadTime != 0.0) ? (LoadedTime - MapLoadTime) * 1000.0 : 0.0,
+		FirstWaitSeconds * 1000.0);
+}
+
+void FVehicleAssetBundle::LogAllStats()
+{
+	for (const FVehicleAssetBundle* Bundle : GetAllBundles())
+	{
+		Bundle->LogStats();
+	}
+}
+
+static FAutoConsoleCommand VehicleAssetStatsCommand(
+	TEXT("Vehicle.Assets.Stats"),
+	TEXT("Log the vehicle asset preload time and how long the first vehicle waited for it"),
+	FConsoleCommandDelegate::CreateStatic(&FVehicleAssetBundle::LogAllStats)
+	);
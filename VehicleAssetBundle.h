@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/StreamableManager.h"
+
+/** Share of the bundle loaded, 0 to 1 */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnVehicleAssetsProgress, float);
+
+/** Adds the assets a module's classes need to a bundle */
+DECLARE_DELEGATE_OneParam(FGatherVehicleAssets, TArray<FStringAssetReference>&);
+
+/**
+ * The meshes, sounds, materials and fonts the vehicles and their HUD use, loaded in the
+ * background when a map loads instead of at class construction.
+ * Each module has its own bundle listing its own classes' defaults, so no module has to know
+ * the classes of another. Spawned objects add their class's assets (a Blueprint subclass may
+ * point at others) and ask to be called back once everything is in, which is straight away
+ * unless they spawn before the load finished.
+ */
+class FVehicleAssetBundle
+{
+public:
+	/**
+	 * @param	InName		for the log
+	 * @param	InGather	adds the module's assets when the preload starts
+	 */
+	FVehicleAssetBundle(const TCHAR* InName, const FGatherVehicleAssets& InGather);
+	~FVehicleAssetBundle();
+
+	/** Bundle of this module: AFPawn and AFHUD */
+	static FVehicleAssetBundle& Get();
+
+	/** Start loading, does nothing when already loading or loaded */
+	void StartPreload();
+
+	/** Load these as well, if they are not already, WhenLoaded waits for them too */
+	void AddAssets(const TArray<FStringAssetReference>& NewAssets);
+
+	/** Call Callback once the bundle is loaded, immediately if it is */
+	void WhenLoaded(const FSimpleDelegate& Callback);
+
+	bool IsLoaded() const { return bLoaded; }
+
+	float GetProgress() const { return (Assets.Num() > 0) ? (float)NumLoaded / Assets.Num() : (bLoaded ? 1.0f : 0.0f); }
+
+	/** Log how long the load took and how long the first caller waited */
+	void LogStats() const;
+
+	/** Broadcast as each asset comes in */
+	FOnVehicleAssetsProgress OnProgress;
+
+	/** A map finished loading, starts the preload of every bundle */
+	static void OnPostLoadMap();
+
+	/** Vehicle.Assets.Stats */
+	static void LogAllStats();
+
+private:
+	/** Every bundle there is, for OnPostLoadMap */
+	static TArray<FVehicleAssetBundle*>& GetAllBundles();
+
+	void RequestAsset(const FStringAssetReference& Asset);
+
+	void OnAssetLoaded();
+
+	FString Name;
+	FGatherVehicleAssets Gather;
+
+	FStreamableManager Streamable;
+	TArray<FStringAssetReference> Assets;
+	int32 NumLoaded;
+	bool bLoading;
+	bool bLoaded;
+
+	/** Waiting for the load to finish */
+	TArray<FSimpleDelegate> Waiting;
+
+	double MapLoadTime;
+	double StartTime;
+	double LoadedTime;
+	/** When the first caller had to wait, 0 if nobody did */
+	double FirstWaitTime;
+	double FirstWaitSeconds;
+};
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleCore.h"
+#include "VehicleStats.h"
+
+DEFINE_STAT(STAT_VehicleFrictionChanges);
+
+void FVehicleCore::Tick(const FVehicleCoreInput& Input, const FVehicleFrameContext& Frame, FVehicleCoreOutput& Output)
+{
+	// Setup the flag to say we are in reverse gear
+	Output.bInReverseGear = Input.CurrentGear < 0;
+
+	Output.FrictionChange = UpdateFriction(Input.UpZ, Input.NumSlipperyWheels, Input.DeltaSeconds);
+
+	Output.ChangedHUDFields = UpdateHUDText(Input.ForwardSpeed, Input.CurrentGear, Input.bHasLapTimer, Input.LapTimeUs, Input.BestLapUs);
+
+	Output.bApplyManualHeadLook = Input.bInCarCameraActive && Frame.AllowsManualHeadLook();
+
+	Output.AudioRPM = GetAudioRPM(Input.EngineRotationSpeed, Input.EngineMaxRotationSpeed);
+}
+
+FVehicleCoreOutput::EFrictionChange FVehicleCore::UpdateFriction(float UpZ, int32 NumSlipperyWheels, float DeltaSeconds)
+{
+	// Physics material, only switched once the surface under the wheels has really changed
+	FVehicleCoreOutput::EFrictionChange FrictionChange = FVehicleCoreOutput::NoFrictionChange;
+	bool bWantLowFriction = bIsLowFriction;
+	if (UpZ < 0)
+	{
+		// On its roof, let it slide
+		bWantLowFriction = true;
+	}
+	else if ((bIsLowFriction == false) && (NumSlipperyWheels >= FrictionHysteresis.EnterWheels))
+	{
+		bWantLowFriction = true;
+	}
+	else if ((bIsLowFriction == true) && (NumSlipperyWheels <= FrictionHysteresis.ExitWheels))
+	{
+		bWantLowFriction = false;
+	}
+
+	if (bWantLowFriction != bIsLowFriction)
+	{
+		FrictionHoldTime += DeltaSeconds;
+		if (FrictionHoldTime >= FrictionHysteresis.HoldTime)
+		{
+			FrictionChange = bWantLowFriction ? FVehicleCoreOutput::ToSlippery : FVehicleCoreOutput::ToNonSlippery;
+			bIsLowFriction = bWantLowFriction;
+			FrictionHoldTime = 0.0f;
+			++NumFrictionChanges;
+			INC_DWORD_STAT(STAT_VehicleFrictionChanges);
+		}
+	}
+	else
+	{
+		FrictionHoldTime = 0.0f;
+	}
+	return FrictionChange;
+}
+
+uint32 FVehicleCore::UpdateHUDText(float ForwardSpeed, int32 CurrentGear, bool bHasLapTimer, int64 LapTimeUs, int64 BestLapUs)
+{
+	// HUD strings, only reformatted when the displayed values change
+	uint32 ChangedFields = HUDText.UpdateSpeed(GetDisplayKPH(ForwardSpeed));
+	if (bHasLapTimer == true)
+	{
+		int32 Minutes, Seconds, MilSec;
+		FVehicleHUDTextCache::BreakTime(LapTimeUs, Minutes, Seconds, MilSec);
+		ChangedFields |= HUDText.UpdateLapTime(Minutes, Seconds, MilSec);
+		ChangedFields |= HUDText.UpdateBestLap(BestLapUs);
+	}
+	ChangedFields |= HUDText.UpdateGear(CurrentGear, CurrentGear < 0);
+	return ChangedFields;
+}
+
+int32 FVehicleCoreBatch::Add()
+{
+	const int32 Index = ForwardSpeed.Add(0.0f);
+	CurrentGear.Add(0);
+	EngineRotationSpeed.Add(0.0f);
+	EngineMaxRotationSpeed.Add(0.0f);
+	UpZ.Add(1.0f);
+	DeltaSeconds.Add(0.0f);
+	NumWheels.Add(0);
+	NumSlipperyWheels.Add(0);
+	Flags.Add(0);
+	LapTimeUs.Add(0);
+	BestLapUs.Add(0);
+	return Index;
+}
+
+void FVehicleCoreBatch::RemoveAtSwap(int32 Index)
+{
+	ForwardSpeed.RemoveAtSwap(Index);
+	CurrentGear.RemoveAtSwap(Index);
+	EngineRotationSpeed.RemoveAtSwap(Index);
+	EngineMaxRotationSpeed.RemoveAtSwap(Index);
+	UpZ.RemoveAtSwap(Index);
+	DeltaSeconds.RemoveAtSwap(Index);
+	NumWheels.RemoveAtSwap(Index);
+	NumSlipperyWheels.RemoveAtSwap(Index);
+	Flags.RemoveAtSwap(Index);
+	LapTimeUs.RemoveAtSwap(Index);
+	BestLapUs.RemoveAtSwap(Index);
+}
+
+void FVehicleCoreBatch::Reserve(int32 Num)
+{
+	ForwardSpeed.Reserve(Num);
+	CurrentGear.Reserve(Num);
+	EngineRotationSpeed.Reserve(Num);
+	EngineMaxRotationSpeed.Reserve(Num);
+	UpZ.Reserve(Num);
+	DeltaSeconds.Reserve(Num);
+	NumWheels.Reserve(Num);
+	NumSlipperyWheels.Reserve(Num);
+	Flags.Reserve(Num);
+	LapTimeUs.Reserve(Num);
+	BestLapUs.Reserve(Num);
+}
+
+void FVehicleCoreBatch::Tick(const FVehicleFrameContext& Frame, FVehicleCore* const* Cores, FVehicleCoreOutput* Outputs) const
+{
+	const int32 Count = Num();
+
+	// Stateless parts straight from the columns
+	const bool bFrameAllowsHeadLook = Frame.AllowsManualHeadLook();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FVehicleCoreOutput& Output = Outputs[Index];
+		Output.bInReverseGear = CurrentGear[Index] < 0;
+		Output.bApplyManualHeadLook = bFrameAllowsHeadLook && ((Flags[Index] & InCarCameraActive) != 0);
+		Output.AudioRPM = FVehicleCore::GetAudioRPM(EngineRotationSpeed[Index], EngineMaxRotationSpeed[Index]);
+	}
+
+	// Friction hysteresis, touches only the friction state of each core
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Outputs[Index].FrictionChange = Cores[Index]->UpdateFriction(UpZ[Index], NumSlipperyWheels[Index], DeltaSeconds[Index]);
+	}
+
+	// HUD strings last, the only part that may format text
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Outputs[Index].ChangedHUDFields = Cores[Index]->UpdateHUDText(ForwardSpeed[Index], CurrentGear[Index], (Flags[Index] & HasLapTimer) != 0, LapTimeUs[Index], BestLapUs[Index]);
+	}
+}
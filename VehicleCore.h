@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VehicleHUDTextCache.h"
+
+/**
+ * State that is the same for every vehicle in a frame.
+ * Captured from the engine by the game, filled in by hand when running headless.
+ */
+struct FVehicleFrameContext
+{
+	/** An HMD device is present */
+	bool bHMDValid;
+	/** The HMD allows head tracking */
+	bool bHeadTrackingAllowed;
+	/** Rendering in stereo */
+	bool bStereoscopic3D;
+	/** The HMD is rendering in stereo (used by the onscreen HUD) */
+	bool bStereoEnabled;
+
+	FVehicleFrameContext()
+		: bHMDValid(false)
+		, bHeadTrackingAllowed(false)
+		, bStereoscopic3D(false)
+		, bStereoEnabled(false)
+	{
+	}
+
+	/** Read the HMD state from GEngine, the only engine dependent part (VehicleFrameContext.cpp) */
+	static FVehicleFrameContext Capture();
+
+	/** No HMD head tracking, so the look axes drive the in-car camera */
+	bool AllowsManualHeadLook() const
+	{
+		return (bHMDValid == false) || (bHeadTrackingAllowed == false) || (bStereoscopic3D == false);
+	}
+};
+
+/** What the core needs to know about a vehicle for one tick */
+struct FVehicleCoreInput
+{
+	float ForwardSpeed;
+	int32 CurrentGear;
+	float EngineRotationSpeed;
+	float EngineMaxRotationSpeed;
+	/** Z of the actor up vector */
+	float UpZ;
+	bool bInCarCameraActive;
+	/** Seconds since the last tick */
+	float DeltaSeconds;
+	/** Wheels sampled against the surface map and how many of them are on a slippery surface */
+	int32 NumWheels;
+	int32 NumSlipperyWheels;
+	/** Lap timer values, ignored unless bHasLapTimer */
+	bool bHasLapTimer;
+	int64 LapTimeUs;
+	int64 BestLapUs;
+};
+
+/** What the pawn has to apply to its components after a tick */
+struct FVehicleCoreOutput
+{
+	enum EFrictionChange
+	{
+		NoFrictionChange,
+		ToSlippery,
+		ToNonSlippery,
+	};
+
+	bool bInReverseGear;
+	EFrictionChange FrictionChange;
+	/** FVehicleHUDTextCache::EField mask of the strings that changed */
+	uint32 ChangedHUDFields;
+	/** Value for the engine sound RPM parameter */
+	float AudioRPM;
+	/** Move the in-car camera from the look axes */
+	bool bApplyManualHeadLook;
+};
+
+/** When a vehicle switches between its grip and slippery physics material */
+struct FVehicleFrictionHysteresis
+{
+	/** Go slippery when at least this many wheels are on a slippery surface */
+	int32 EnterWheels;
+	/** Back to grip when at most this many wheels are */
+	int32 ExitWheels;
+	/** How long the new surface has to hold before switching */
+	float HoldTime;
+
+	FVehicleFrictionHysteresis()
+		: EnterWheels(3)
+		, ExitWheels(1)
+		, HoldTime(0.2f)
+	{
+	}
+};
+
+/**
+ * Per tick vehicle logic that does not need the engine: reverse flag, friction material choice,
+ * HUD strings, head look decision and engine audio value.
+ * Only depends on Core so it can be driven headless (see UFVehicleBenchmarkCommandlet).
+ */
+struct FVehicleCore
+{
+	/** Cached HUD strings */
+	FVehicleHUDTextCache HUDText;
+
+	/** Are we on a 'slippery' surface */
+	bool bIsLowFriction;
+
+	FVehicleFrictionHysteresis FrictionHysteresis;
+
+	/** How long the surface has disagreed with bIsLowFriction */
+	float FrictionHoldTime;
+
+	/** Physics material switches so far, each one rebuilds the physics shapes */
+	int32 NumFrictionChanges;
+
+	FVehicleCore()
+		: bIsLowFriction(false)
+		, FrictionHoldTime(0.0f)
+		, NumFrictionChanges(0)
+	{
+	}
+
+	/** Back to a new vehicle on grip, every HUD string is reported changed on the next tick */
+	void Reset()
+	{
+		HUDText.Reset();
+		bIsLowFriction = false;
+		FrictionHoldTime = 0.0f;
+		NumFrictionChanges = 0;
+	}
+
+	/** Run one tick */
+	void Tick(const FVehicleCoreInput& Input, const FVehicleFrameContext& Frame, FVehicleCoreOutput& Output);
+
+	/** Friction part of the tick, returns the physics material switch to make */
+	FVehicleCoreOutput::EFrictionChange UpdateFriction(float UpZ, int32 NumSlipperyWheels, float DeltaSeconds);
+
+	/** HUD part of the tick, returns the FVehicleHUDTextCache::EField mask of the strings that changed */
+	uint32 UpdateHUDText(float ForwardSpeed, int32 CurrentGear, bool bHasLapTimer, int64 LapTimeUs, int64 BestLapUs);
+
+	/** Displayed speed in km/h from the forward speed in cm/s */
+	static int32 GetDisplayKPH(float ForwardSpeed)
+	{
+		return FMath::FloorToInt(FMath::Abs(ForwardSpeed) * 0.036f);
+	}
+
+	/** Engine sound parameter from the engine rotation speed */
+	static float GetAudioRPM(float EngineRotationSpeed, float EngineMaxRotationSpeed)
+	{
+		const float RPMToAudioScale = 2500.0f / EngineMaxRotationSpeed;
+		return EngineRotationSpeed * RPMToAudioScale;
+	}
+};
+
+/**
+ * Core inputs of many vehicles, one array per field so a batch tick walks contiguous memory.
+ * Entries are removed by swapping with the last one, owners keep their own arrays in the same order.
+ */
+struct FVehicleCoreBatch
+{
+	enum EFlags
+	{
+		InCarCameraActive = 1 << 0,
+		HasLapTimer = 1 << 1,
+	};
+
+	TArray<float> ForwardSpeed;
+	TArray<int32> CurrentGear;
+	TArray<float> EngineRotationSpeed;
+	TArray<float> EngineMaxRotationSpeed;
+	TArray<float> UpZ;
+	TArray<float> DeltaSeconds;
+	TArray<uint8> NumWheels;
+	TArray<uint8> NumSlipperyWheels;
+	/** EFlags */
+	TArray<uint8> Flags;
+	TArray<int64> LapTimeUs;
+	TArray<int64> BestLapUs;
+
+	int32 Num() const { return ForwardSpeed.Num(); }
+
+	/** Add a zeroed entry, returns its index */
+	int32 Add();
+
+	void RemoveAtSwap(int32 Index);
+
+	void Reserve(int32 Num);
+
+	/**
+	 * Tick every entry with the same frame context.
+	 * Runs one pass per part of the core tick, each reading only the columns it needs.
+	 *
+	 * @param	Cores	core of each entry
+	 * @param	Outputs	filled in for each entry
+	 */
+	void Tick(const FVehicleFrameContext& Frame, FVehicleCore* const* Cores, FVehicleCoreOutput* Outputs) const;
+};
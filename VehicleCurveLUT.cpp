@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleCurveLUT.h"
+
+FVehicleCurveLUT::FVehicleCurveLUT()
+	: MinX(0.0f)
+	, MaxX(0.0f)
+	, InvStep(0.0f)
+{
+	FMemory::Memzero(Values, sizeof(Values));
+}
+
+void FVehicleCurveLUT::Bake(const FRichCurve& Curve)
+{
+	Curve.GetTimeRange(MinX, MaxX);
+
+	const float Range = MaxX - MinX;
+	InvStep = (Range > KINDA_SMALL_NUMBER) ? (float)(NumSamples - 1) / Range : 0.0f;
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		const float X = (InvStep > 0.0f) ? MinX + (float)Index / InvStep : MinX;
+		Values[Index] = Curve.Eval(X);
+	}
+}
+
+void FVehicleCurveLUT::EvaluateBatch(const float* In, float* Out, int32 Count) const
+{
+	const VectorRegister VecMinX = VectorSetFloat1(MinX);
+	const VectorRegister VecInvStep = VectorSetFloat1(InvStep);
+	const VectorRegister VecZero = VectorZero();
+	const VectorRegister VecMaxT = VectorSetFloat1((float)(NumSamples - 1));
+
+	int32 Index = 0;
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		// Position in the table for four inputs at once
+		VectorRegister T = VectorMultiply(VectorSubtract(VectorLoad(In + Index), VecMinX), VecInvStep);
+		T = VectorMin(VectorMax(T, VecZero), VecMaxT);
+
+		MS_ALIGN(16) float Lanes[4] GCC_ALIGN(16);
+		MS_ALIGN(16) float From[4] GCC_ALIGN(16);
+		MS_ALIGN(16) float Delta[4] GCC_ALIGN(16);
+		MS_ALIGN(16) float Base[4] GCC_ALIGN(16);
+		VectorStoreAligned(T, Lanes);
+
+		// Gather the two samples around each input
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			const int32 Sample = FMath::Min(FMath::TruncToInt(Lanes[Lane]), NumSamples - 2);
+			Base[Lane] = (float)Sample;
+			From[Lane] = Values[Sample];
+			Delta[Lane] = Values[Sample + 1] - Values[Sample];
+		}
+
+		const VectorRegister Alpha = VectorSubtract(T, VectorLoadAligned(Base));
+		VectorStore(VectorMultiplyAdd(VectorLoadAligned(Delta), Alpha, VectorLoadAligned(From)), Out + Index);
+	}
+
+	for (; Index < Count; ++Index)
+	{
+		Out[Index] = Evaluate(In[Index]);
+	}
+}
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * A float curve baked into uniformly spaced samples.
+ * Evaluating is a multiply, a truncate and a lerp instead of a key search, and EvaluateBatch does
+ * four lookups per vector operation for callers with many vehicles.
+ */
+struct FVehicleCurveLUT
+{
+	enum { NumSamples = 64 };
+
+	FVehicleCurveLUT();
+
+	/** Sample the curve across its key range */
+	void Bake(const FRichCurve& Curve);
+
+	/** Value at X, clamped to the baked range */
+	FORCEINLINE float Evaluate(float X) const
+	{
+		float T = (X - MinX) * InvStep;
+		T = FMath::Clamp(T, 0.0f, (float)(NumSamples - 1));
+		const int32 Index = FMath::Min(FMath::TruncToInt(T), NumSamples - 2);
+		const float Alpha = T - (float)Index;
+		return Values[Index] + (Values[Index + 1] - Values[Index]) * Alpha;
+	}
+
+	/** Evaluate Count values, In and Out may be the same array */
+	void EvaluateBatch(const float* In, float* Out, int32 Count) const;
+
+	float GetMinX() const { return MinX; }
+	float GetMaxX() const { return MaxX; }
+
+private:
+	float MinX;
+	float MaxX;
+	/** Samples per unit of X */
+	float InvStep;
+	/** Baked samples from MinX to MaxX */
+	float Values[NumSamples];
+};
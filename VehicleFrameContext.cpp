@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleCore.h"
+
+// Needed for VR Headset
+#include "Engine.h"
+#include "IHeadMountedDisplay.h"
+
+FVehicleFrameContext FVehicleFrameContext::Capture()
+{
+	FVehicleFrameContext Frame;
+	Frame.bHMDValid = GEngine->HMDDevice.IsValid();
+	if (Frame.bHMDValid == true)
+	{
+		Frame.bHeadTrackingAllowed = GEngine->HMDDevice->IsHeadTrackingAllowed();
+		Frame.bStereoEnabled = GEngine->HMDDevice->IsStereoEnabled();
+	}
+	Frame.bStereoscopic3D = GEngine->IsStereoscopic3D();
+	return Frame;
+}
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleHUDLayer.h"
+#include "VehicleStats.h"
+#include "Engine/Canvas.h"
+#include "Engine/Font.h"
+#include "CanvasItem.h"
+
+DEFINE_STAT(STAT_VehicleHUDDraw);
+DEFINE_STAT(STAT_VehicleHUDElementsRebuilt);
+
+FVehicleHUDLayer::FVehicleHUDLayer()
+	: TextScale(1.0f)
+	, LayoutSize(0, 0)
+	, LayoutFont(nullptr)
+	, bBatchDirty(true)
+	, NumRebuilt(0)
+{
+}
+
+int32 FVehicleHUDLayer::AddElement(const FVector2D& Position, const FLinearColor& Color)
+{
+	const int32 Index = Elements.AddZeroed();
+	FElement& Element = Elements[Index];
+	Element.Position = Position;
+	Element.Color = Color;
+	Element.bVisible = true;
+	Element.bDirty = true;
+	bBatchDirty = true;
+	return Index;
+}
+
+void FVehicleHUDLayer::SetText(int32 Index, const FText& Text)
+{
+	FElement& Element = Elements[Index];
+	const FString& NewText = Text.ToString();
+	if (Element.Text != NewText)
+	{
+		Element.Text = NewText;
+		Element.bDirty = true;
+	}
+}
+
+void FVehicleHUDLayer::SetColor(int32 Index, const FLinearColor& Color)
+{
+	FElement& Element = Elements[Index];
+	if (Element.Color != Color)
+	{
+		Element.Color = Color;
+		Element.bDirty = true;
+	}
+}
+
+void FVehicleHUDLayer::SetVisible(int32 Index, bool bVisible)
+{
+	FElement& Element = Elements[Index];
+	if (Element.bVisible != bVisible)
+	{
+		Element.bVisible = bVisible;
+		bBatchDirty = true;
+	}
+}
+
+void FVehicleHUDLayer::SetTextScale(float InTextScale)
+{
+	if (TextScale != InTextScale)
+	{
+		TextScale = InTextScale;
+		Invalidate();
+	}
+}
+
+void FVehicleHUDLayer::Invalidate()
+{
+	for (FElement& Element : Elements)
+	{
+		Element.bDirty = true;
+	}
+}
+
+void FVehicleHUDLayer::Draw(UCanvas* Canvas, UFont* Font)
+{
+	NumRebuilt = 0;
+	if ((Canvas == nullptr) || (Font == nullptr))
+	{
+		return;
+	}
+
+	// Positions and scale are relative to 720p, a new viewport size moves everything
+	const FIntPoint CanvasSize(Canvas->SizeX, Canvas->SizeY);
+	if ((CanvasSize != LayoutSize) || (Font != LayoutFont))
+	{
+		LayoutSize = CanvasSize;
+		LayoutFont = Font;
+		Invalidate();
+	}
+
+	const float HUDXRatio = CanvasSize.X / 1280.f;
+	const float HUDYRatio = CanvasSize.Y / 720.f;
+	for (FElement& Element : Elements)
+	{
+		if ((Element.bDirty == true) && (Element.bVisible == true))
+		{
+			LayoutElement(Element, Font, HUDXRatio, HUDYRatio);
+			Element.bDirty = false;
+			bBatchDirty = true;
+			++NumRebuilt;
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_VehicleHUDElementsRebuilt, NumRebuilt);
+
+	if (bBatchDirty == true)
+	{
+		BuildBatches();
+		bBatchDirty = false;
+	}
+
+	for (int32 Page = 0; Page < PageBatches.Num(); ++Page)
+	{
+		if ((PageBatches[Page].Num() == 0) || (Font->Textures.IsValidIndex(Page) == false) || (Font->Textures[Page] == nullptr))
+		{
+			continue;
+		}
+
+		FCanvasTriangleItem TriangleItem(PageBatches[Page], Font->Textures[Page]->Resource);
+		if (Font->ImportOptions.bUseDistanceFieldAlpha == true)
+		{
+			TriangleItem.BlendMode = SE_BLEND_TranslucentDistanceField;
+		}
+		else
+		{
+			TriangleItem.BlendMode = SE_BLEND_Translucent;
+		}
+		Canvas->DrawItem(TriangleItem);
+	}
+}
+
+void FVehicleHUDLayer::LayoutElement(FElement& Element, UFont* Font, float HUDXRatio, float HUDYRatio)
+{
+	Element.Triangles.Reset();
+	Element.Pages.Reset();
+
+	// Same scale the HUD used for its text items
+	const float Scale = HUDYRatio * TextScale;
+	FVector2D Pen(Element.Position.X * HUDXRatio, Element.Position.Y * HUDYRatio);
+
+	for (const TCHAR Char : Element.Text)
+	{
+		const int32 CharIndex = Font->RemapChar(Char);
+		if (Font->Characters.IsValidIndex(CharIndex) == false)
+		{
+			continue;
+		}
+
+		const FFontCharacter& Glyph = Font->Characters[CharIndex];
+		const UTexture2D* Texture = Font->Textures.IsValidIndex(Glyph.TextureIndex) ? Font->Textures[Glyph.TextureIndex] : nullptr;
+		if ((Texture != nullptr) && (Glyph.USize > 0) && (Glyph.VSize > 0))
+		{
+			const float InvWidth = 1.0f / Texture->GetSurfaceWidth();
+			const float InvHeight = 1.0f / Texture->GetSurfaceHeight();
+			const FVector2D UV0(Glyph.StartU * InvWidth, Glyph.StartV * InvHeight);
+			const FVector2D UV1((Glyph.StartU + Glyph.USize) * InvWidth, (Glyph.StartV + Glyph.VSize) * InvHeight);
+			const FVector2D P0(Pen.X, Pen.Y + Glyph.VerticalOffset * Scale);
+			const FVector2D P1(P0.X + Glyph.USize * Scale, P0.Y + Glyph.VSize * Scale);
+
+			FCanvasUVTri Tri;
+			Tri.V0_Color = Tri.V1_Color = Tri.V2_Color = Element.Color;
+
+			Tri.V0_Pos = P0;						Tri.V0_UV = UV0;
+			Tri.V1_Pos = FVector2D(P1.X, P0.Y);		Tri.V1_UV = FVector2D(UV1.X, UV0.Y);
+			Tri.V2_Pos = P1;						Tri.V2_UV = UV1;
+			Element.Triangles.Add(Tri);
+
+			Tri.V1_Pos = P1;						Tri.V1_UV = UV1;
+			Tri.V2_Pos = FVector2D(P0.X, P1.Y);		Tri.V2_UV = FVector2D(UV0.X, UV1.Y);
+			Element.Triangles.Add(Tri);
+
+			Element.Pages.Add((uint8)Glyph.TextureIndex);
+		}
+
+		Pen.X += (Glyph.USize + Font->Kerning) * Scale;
+	}
+}
+
+void FVehicleHUDLayer::BuildBatches()
+{
+	for (TArray<FCanvasUVTri>& Batch : PageBatches)
+	{
+		Batch.Reset();
+	}
+
+	for (const FElement& Element : Elements)
+	{
+		if (Element.bVisible == false)
+		{
+			continue;
+		}
+
+		for (int32 GlyphIndex = 0; GlyphIndex < Element.Pages.Num(); ++GlyphIndex)
+		{
+			const int32 Page = Element.Pages[GlyphIndex];
+			if (PageBatches.Num() <= Page)
+			{
+				PageBatches.SetNum(Page + 1);
+			}
+			PageBatches[Page].Add(Element.Triangles[GlyphIndex * 2]);
+			PageBatches[Page].Add(Element.Triangles[GlyphIndex * 2 + 1]);
+		}
+	}
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+class UCanvas;
+class UFont;
+struct FCanvasUVTri;
+
+/**
+ * Retained text for the onscreen vehicle HUD.
+ * Elements keep their glyph quads between frames and are only laid out again when their text,
+ * color or the viewport size changes. All visible elements are drawn as one triangle list per
+ * font page, normally a single draw for the whole HUD.
+ */
+struct FVehicleHUDLayer
+{
+	FVehicleHUDLayer();
+
+	/**
+	 * Add a text element.
+	 *
+	 * @param	Position	top left corner on a 1280x720 screen, scaled to the viewport
+	 * @param	Color		text color
+	 * @return handle of the element
+	 */
+	int32 AddElement(const FVector2D& Position, const FLinearColor& Color);
+
+	void SetText(int32 Element, const FText& Text);
+	void SetColor(int32 Element, const FLinearColor& Color);
+	void SetVisible(int32 Element, bool bVisible);
+
+	/** Scale of the text on a 720p screen */
+	void SetTextScale(float InTextScale);
+
+	/** Lay out what changed and draw every visible element */
+	void Draw(UCanvas* Canvas, UFont* Font);
+
+	/** Elements laid out again by the last Draw */
+	int32 GetNumRebuilt() const { return NumRebuilt; }
+
+	/** Forget all cached layout, eg when the font changes */
+	void Invalidate();
+
+private:
+	struct FElement
+	{
+		FVector2D Position;
+		FLinearColor Color;
+		FString Text;
+		/** Glyph triangles and the font page of each pair */
+		TArray<FCanvasUVTri> Triangles;
+		TArray<uint8> Pages;
+		bool bVisible;
+		bool bDirty;
+	};
+
+	/** Build the glyph quads of an element for the current viewport */
+	void LayoutElement(FElement& Element, UFont* Font, float HUDXRatio, float HUDYRatio);
+
+	/** Gather the visible elements into one triangle list per font page */
+	void BuildBatches();
+
+	TArray<FElement> Elements;
+
+	/** Triangles drawn each frame, one list per font page */
+	TArray<TArray<FCanvasUVTri>> PageBatches;
+
+	float TextScale;
+	/** Viewport the layout was built for */
+	FIntPoint LayoutSize;
+	UFont* LayoutFont;
+
+	bool bBatchDirty;
+	int32 NumRebuilt;
+};
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleHUDTextCache.h"
+#include "VehicleStats.h"
+#include "VehicleProfiler.h"
+
+DEFINE_STAT(STAT_VehicleHUDFormatsSkipped);
+DEFINE_STAT(STAT_VehicleHUDFormatsRebuilt);
+
+// Keep the keys from the pawn so existing localization still applies
+#define LOCTEXT_NAMESPACE "VehiclePawn"
+
+namespace VehicleHUDText
+{
+	/** Highest speed that is served from the table */
+	const int32 MaxTableKPH = 400;
+	/** Numbers 0..MaxTableNumber are served from the table (gears, minutes, seconds and milliseconds) */
+	const int32 MaxTableNumber = 999;
+
+	/** Prebuilt strings shared by every vehicle */
+	struct FTables
+	{
+		FText Speed[MaxTableKPH + 1];
+		FText Number[MaxTableNumber + 1];
+		FText Reverse;
+		FText Neutral;
+
+		FTables()
+		{
+			for (int32 Index = 0; Index <= MaxTableKPH; ++Index)
+			{
+				Speed[Index] = FText::Format(LOCTEXT("SpeedFormat", "{0} km/h"), FText::AsNumber(Index));
+			}
+			for (int32 Index = 0; Index <= MaxTableNumber; ++Index)
+			{
+				Number[Index] = FText::AsNumber(Index);
+			}
+			Reverse = LOCTEXT("ReverseGear", "R");
+			Neutral = LOCTEXT("N", "N");
+		}
+	};
+
+	static const FTables& GetTables()
+	{
+		static FTables Tables;
+		return Tables;
+	}
+
+	static FText FormatNumber(int32 Value)
+	{
+		if ((Value >= 0) && (Value <= MaxTableNumber))
+		{
+			return GetTables().Number[Value];
+		}
+		return FText::Format(LOCTEXT("LapTimerFormat", "{0}"), FText::AsNumber(Value));
+	}
+
+	/** Formats skipped and rebuilt since the start of the current one second window */
+	static uint32 SkippedInWindow = 0;
+	static uint32 RebuiltInWindow = 0;
+	static double WindowStartTime = 0.0;
+
+	static void NoteFormats(uint32 NumSkipped, uint32 NumRebuilt)
+	{
+		SkippedInWindow += NumSkipped;
+		RebuiltInWindow += NumRebuilt;
+		FVehicleProfiler::Get().AddCount(FVehicleProfiler::StringsReformatted, NumRebuilt);
+
+		const double Now = FApp::GetCurrentTime();
+		if (Now - WindowStartTime >= 1.0)
+		{
+			SET_DWORD_STAT(STAT_VehicleHUDFormatsSkipped, SkippedInWindow);
+			SET_DWORD_STAT(STAT_VehicleHUDFormatsRebuilt, RebuiltInWindow);
+			SkippedInWindow = 0;
+			RebuiltInWindow = 0;
+			WindowStartTime = Now;
+		}
+	}
+}
+
+FVehicleHUDTextCache::FVehicleHUDTextCache()
+{
+	Reset();
+}
+
+void FVehicleHUDTextCache::Reset()
+{
+	LastKPH = INDEX_NONE;
+	LastGear = MIN_int32;
+	LastMinutes = INDEX_NONE;
+	LastSeconds = INDEX_NONE;
+	LastMilSec = INDEX_NONE;
+	LastBestLapUs = INDEX_NONE;
+}
+
+uint32 FVehicleHUDTextCache::UpdateSpeed(int32 KPH)
+{
+	if (KPH == LastKPH)
+	{
+		VehicleHUDText::NoteFormats(1, 0);
+		return 0;
+	}
+
+	LastKPH = KPH;
+	if ((KPH >= 0) && (KPH <= VehicleHUDText::MaxTableKPH))
+	{
+		SpeedText = VehicleHUDText::GetTables().Speed[KPH];
+	}
+	else
+	{
+		SpeedText = FText::Format(LOCTEXT("SpeedFormat", "{0} km/h"), FText::AsNumber(KPH));
+	}
+	VehicleHUDText::NoteFormats(0, 1);
+	return Speed;
+}
+
+uint32 FVehicleHUDTextCache::UpdateGear(int32 InGear, bool bInReverse)
+{
+	// All reverse gears display the same so share one key
+	const int32 GearKey = bInReverse ? -1 : InGear;
+	if (GearKey == LastGear)
+	{
+		VehicleHUDText::NoteFormats(1, 0);
+		return 0;
+	}
+
+	LastGear = GearKey;
+	if (bInReverse == true)
+	{
+		GearText = VehicleHUDText::GetTables().Reverse;
+	}
+	else
+	{
+		GearText = (InGear == 0) ? VehicleHUDText::GetTables().Neutral : VehicleHUDText::FormatNumber(InGear);
+	}
+	VehicleHUDText::NoteFormats(0, 1);
+	return Gear;
+}
+
+uint32 FVehicleHUDTextCache::UpdateLapTime(int32 Minutes, int32 Seconds, int32 MilSec)
+{
+	uint32 Changed = 0;
+	uint32 NumRebuilt = 0;
+	if (Minutes != LastMinutes)
+	{
+		LastMinutes = Minutes;
+		LapMinutesText = VehicleHUDText::FormatNumber(Minutes);
+		Changed |= LapMinutes;
+		++NumRebuilt;
+	}
+	if (Seconds != LastSeconds)
+	{
+		LastSeconds = Seconds;
+		LapSecondsText = VehicleHUDText::FormatNumber(Seconds);
+		Changed |= LapSeconds;
+		++NumRebuilt;
+	}
+	if (MilSec != LastMilSec)
+	{
+		LastMilSec = MilSec;
+		LapMilSecText = VehicleHUDText::FormatNumber(MilSec);
+		Changed |= LapMilSec;
+		++NumRebuilt;
+	}
+
+	VehicleHUDText::NoteFormats(3 - NumRebuilt, NumRebuilt);
+	return Changed;
+}
+
+uint32 FVehicleHUDTextCache::UpdateBestLap(int64 BestLapUs)
+{
+	if (BestLapUs == LastBestLapUs)
+	{
+		return 0;
+	}
+
+	LastBestLapUs = BestLapUs;
+	if (BestLapUs <= 0)
+	{
+		BestLapText = FText::GetEmpty();
+	}
+	else
+	{
+		// Only happens when a lap is completed so build it directly
+		int32 Minutes, Seconds, MilSec;
+		BreakTime(BestLapUs, Minutes, Seconds, MilSec);
+		FNumberFormattingOptions TwoDigits;
+		TwoDigits.MinimumIntegralDigits = 2;
+		FNumberFormattingOptions ThreeDigits;
+		ThreeDigits.MinimumIntegralDigits = 3;
+
+		BestLapText = FText::Format(LOCTEXT("BestLapFormat", "Best {0}:{1}.{2}"),
+			FText::AsNumber(Minutes), FText::AsNumber(Seconds, &TwoDigits), FText::AsNumber(MilSec, &ThreeDigits));
+	}
+	VehicleHUDText::NoteFormats(0, 1);
+	return BestLap;
+}
+
+#undef LOCTEXT_NAMESPACE
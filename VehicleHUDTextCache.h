@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Holds the localized strings shown by the vehicle HUDs (onscreen and in-car).
+ * Each field remembers the integer it was last built from and is only reformatted when
+ * that value changes. Common values (0-400 km/h, gears, 0-59 and 0-999 for the lap timer)
+ * are served from tables that are built once and shared by every vehicle.
+ */
+struct FVehicleHUDTextCache
+{
+	/** Bit flags returned by the Update functions for the fields that changed */
+	enum EField
+	{
+		Speed			= 1 << 0,
+		Gear			= 1 << 1,
+		LapMinutes		= 1 << 2,
+		LapSeconds		= 1 << 3,
+		LapMilSec		= 1 << 4,
+		BestLap			= 1 << 5,
+	};
+
+	/** Speed eg "10 km/h" */
+	FText SpeedText;
+	/** Gear (R, N, 1, 2 etc) */
+	FText GearText;
+	/** Lap timer fields */
+	FText LapMinutesText;
+	FText LapSecondsText;
+	FText LapMilSecText;
+	/** Best lap eg "Best 1:05.250", empty until a lap was completed */
+	FText BestLapText;
+
+	FVehicleHUDTextCache();
+
+	/** Forget the last displayed values so the next update rebuilds every field */
+	void Reset();
+
+	/** @return EField::Speed if the displayed speed changed */
+	uint32 UpdateSpeed(int32 KPH);
+
+	/** @return EField::Gear if the displayed gear changed */
+	uint32 UpdateGear(int32 InGear, bool bInReverse);
+
+	/** @return mask of the lap timer fields that changed */
+	uint32 UpdateLapTime(int32 Minutes, int32 Seconds, int32 MilSec);
+
+	/** @return EField::BestLap if the best lap changed */
+	uint32 UpdateBestLap(int64 BestLapUs);
+
+	/** Values the fields were last built from, for displays that are not text. INDEX_NONE before the first update */
+	int32 GetShownKPH() const { return LastKPH; }
+	/** -1 in reverse, 0 in neutral, MIN_int32 before the first update */
+	int32 GetShownGear() const { return LastGear; }
+	int32 GetShownMinutes() const { return LastMinutes; }
+	int32 GetShownSeconds() const { return LastSeconds; }
+	int32 GetShownMilSec() const { return LastMilSec; }
+
+	/** Break a time down into the fields shown on the HUD */
+	static void BreakTime(int64 TimeUs, int32& OutMinutes, int32& OutSeconds, int32& OutMilSec)
+	{
+		const int64 TotalMilSec = TimeUs / 1000;
+		OutMilSec = (int32)(TotalMilSec % 1000);
+		OutSeconds = (int32)((TotalMilSec / 1000) % 60);
+		OutMinutes = (int32)(TotalMilSec / 60000);
+	}
+
+private:
+	int32 LastKPH;
+	int32 LastGear;
+	int32 LastMinutes;
+	int32 LastSeconds;
+	int32 LastMilSec;
+	int64 LastBestLapUs;
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleLapDelta.h"
+
+FVehicleLapDelta::FVehicleLapDelta()
+	: LapLength(0.0f)
+	, Spacing(1.0f)
+	, InvSpacing(1.0f)
+	, RecordCursor(0)
+	, LookupCursor(0)
+	, LastDistance(0.0f)
+	, LastTime(0.0f)
+	, Delta(0.0f)
+	, bLapFromStart(false)
+	, bHasReference(false)
+	, bHasDelta(false)
+{
+}
+
+void FVehicleLapDelta::Init(float InLapLength, float InSpacing)
+{
+	const float NewSpacing = FMath::Max(InSpacing, 1.0f);
+	if ((InLapLength == LapLength) && (NewSpacing == Spacing))
+	{
+		return;
+	}
+
+	LapLength = InLapLength;
+	Spacing = NewSpacing;
+	InvSpacing = 1.0f / Spacing;
+
+	// One sample per Spacing plus the finish line
+	const int32 NumSamples = FMath::CeilToInt(LapLength * InvSpacing) + 1;
+	Reference.Init(0.0f, NumSamples);
+	Recording.Init(0.0f, NumSamples);
+	bHasReference = false;
+	StartLap();
+}
+
+void FVehicleLapDelta::StartLap()
+{
+	RecordCursor = 0;
+	LookupCursor = 0;
+	LastDistance = 0.0f;
+	LastTime = 0.0f;
+	Delta = 0.0f;
+	bLapFromStart = true;
+	bHasDelta = false;
+}
+
+void FVehicleLapDelta::Update(float LapDistance, float LapTime)
+{
+	if ((Recording.Num() == 0) || (LapDistance <= LastDistance))
+	{
+		return;
+	}
+
+	if ((RecordCursor == 0) && (LapDistance > Spacing * 2.0f))
+	{
+		bLapFromStart = false;
+	}
+
+	// Fill every sample crossed since last time, interpolating the time it was crossed at
+	const int32 LastSample = Recording.Num() - 1;
+	while ((RecordCursor <= LastSample) && (RecordCursor * Spacing <= LapDistance))
+	{
+		const float SampleDistance = RecordCursor * Spacing;
+		const float Alpha = (SampleDistance - LastDistance) / (LapDistance - LastDistance);
+		Recording[RecordCursor] = FMath::Lerp(LastTime, LapTime, FMath::Clamp(Alpha, 0.0f, 1.0f));
+		++RecordCursor;
+	}
+	LastDistance = LapDistance;
+	LastTime = LapTime;
+
+	if (bHasReference == false)
+	{
+		return;
+	}
+
+	// The reference time here, between the samples either side of the car
+	const float Position = LapDistance * InvSpacing;
+	LookupCursor = FMath::Clamp(FMath::Max(LookupCursor, FMath::FloorToInt(Position)), 0, LastSample - 1);
+	const float Alpha = FMath::Clamp(Position - LookupCursor, 0.0f, 1.0f);
+	const float ReferenceTime = FMath::Lerp(Reference[LookupCursor], Reference[LookupCursor + 1], Alpha);
+
+	Delta = LapTime - ReferenceTime;
+	bHasDelta = true;
+}
+
+void FVehicleLapDelta::CompleteLap(float LapTime, bool bBestLap)
+{
+	// A lap cut short (reset, cut track) did not fill every sample and cannot be a reference
+	if ((bBestLap == true) && (bLapFromStart == true) && (RecordCursor >= Recording.Num() - 1))
+	{
+		// The finish sample is the lap time, the last update stopped short of the line
+		Recording.Last() = LapTime;
+		Exchange(Reference, Recording);
+		bHasReference = true;
+	}
+	StartLap();
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Live time difference to a reference lap, by track distance.
+ * The reference holds the lap time at every Spacing along the track. The lap being driven is
+ * recorded the same way, and if it ends up the best it becomes the reference. Both the
+ * recording and the lookup use cursors that only move forward through the lap, so an update
+ * costs the same however long the track is.
+ */
+struct FVehicleLapDelta
+{
+	FVehicleLapDelta();
+
+	/** Size the samples for a lap, drops the reference when the length changes */
+	void Init(float InLapLength, float InSpacing);
+
+	/** A new lap starts at distance 0 */
+	void StartLap();
+
+	/**
+	 * Record where we are and update the delta.
+	 * @param	LapDistance		distance into the lap, going backwards is ignored
+	 * @param	LapTime			seconds into the lap
+	 */
+	void Update(float LapDistance, float LapTime);
+
+	/** The lap ended in LapTime seconds, it becomes the reference when it was the best so far */
+	void CompleteLap(float LapTime, bool bBestLap);
+
+	/** Seconds behind (positive) or ahead of the reference, false without a reference */
+	bool GetDelta(float& OutDelta) const
+	{
+		OutDelta = Delta;
+		return bHasDelta;
+	}
+
+	bool HasReference() const { return bHasReference; }
+
+private:
+	float LapLength;
+	float Spacing;
+	float InvSpacing;
+
+	/** Lap time at each Spacing of the reference lap */
+	TArray<float> Reference;
+	/** Lap time at each Spacing of the lap being driven */
+	TArray<float> Recording;
+	/** Next sample of Recording to fill */
+	int32 RecordCursor;
+	/** Reference sample at or before the car */
+	int32 LookupCursor;
+
+	/** Furthest distance into the lap so far and the time it was reached */
+	float LastDistance;
+	float LastTime;
+
+	float Delta;
+	/** The lap was driven from the line, a lap joined halfway cannot be a reference */
+	bool bLapFromStart;
+	bool bHasReference;
+	bool bHasDelta;
+};
@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleLiveFeed.h"
+#include "GameFramework/WheeledVehicle.h"
+#include "Vehicles/WheeledVehicleMovementComponent.h"
+
+#if PLATFORM_LINUX || PLATFORM_MAC
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogVehicleLiveFeed, Log, All);
+
+using namespace VehicleLiveFeedFormat;
+
+namespace
+{
+	struct FVehicleLiveFeedStartup
+	{
+		FVehicleLiveFeedStartup()
+		{
+			FCoreDelegates::OnPreExit.AddStatic(&FVehicleLiveFeed::OnPreExit);
+		}
+	};
+
+	FVehicleLiveFeedStartup VehicleLiveFeedStartup;
+}
+
+FVehicleLiveFeed& FVehicleLiveFeed::Get()
+{
+	static FVehicleLiveFeed LiveFeed;
+	return LiveFeed;
+}
+
+FVehicleLiveFeed::FVehicleLiveFeed()
+	: Header(nullptr)
+	, Slots(nullptr)
+	, SegmentSize(0)
+{
+}
+
+void FVehicleLiveFeed::OnPreExit()
+{
+	Get().Close();
+}
+
+bool FVehicleLiveFeed::Open(const FString& Name, int32 NumSlots)
+{
+	Close();
+
+#if PLATFORM_LINUX || PLATFORM_MAC
+	SegmentName = Name.IsEmpty() ? FString(ANSI_TO_TCHAR(DefaultName)) : Name;
+	if (SegmentName.StartsWith(TEXT("/")) == false)
+	{
+		SegmentName = TEXT("/") + SegmentName;
+	}
+	NumSlots = FMath::Max(NumSlots, 1);
+
+	// Readers of an earlier run still map the old segment, they see it closed and attach to ours
+	RemoveSegment(SegmentName);
+
+	const int File = shm_open(TCHAR_TO_UTF8(*SegmentName), O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (File < 0)
+	{
+		UE_LOG(LogVehicleLiveFeed, Warning, TEXT("Could not create shared memory %s (errno %d)"), *SegmentName, errno);
+		return false;
+	}
+
+	SegmentSize = GetSegmentSize(NumSlots);
+	void* View = MAP_FAILED;
+	if (ftruncate(File, SegmentSize) == 0)
+	{
+		View = mmap(nullptr, SegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+	}
+	close(File);
+
+	if (View == MAP_FAILED)
+	{
+		UE_LOG(LogVehicleLiveFeed, Warning, TEXT("Could not map shared memory %s (errno %d)"), *SegmentName, errno);
+		shm_unlink(TCHAR_TO_UTF8(*SegmentName));
+		SegmentSize = 0;
+		return false;
+	}
+
+	// A fresh segment is zero filled, so every slot starts with an even sequence
+	Header = (FHeader*)View;
+	Slots = GetSlots(Header);
+	Header->Version = Version;
+	Header->HeaderSize = sizeof(FHeader);
+	Header->SlotSize = sizeof(FSlot);
+	Header->NumSlots = NumSlots;
+	Header->SessionId = (uint64)FDateTime::UtcNow().GetTicks() ^ ((uint64)getpid() << 48);
+	Header->WriteCount = 0;
+	Header->bOpen = 1;
+	FPlatformMisc::MemoryBarrier();
+	Header->Magic = Magic;
+
+	UE_LOG(LogVehicleLiveFeed, Log, TEXT("Publishing vehicle state to shared memory %s, %d slots (%llu bytes)"), *SegmentName, NumSlots, SegmentSize);
+	return true;
+#else
+	UE_LOG(LogVehicleLiveFeed, Warning, TEXT("The live feed needs POSIX shared memory, not available on this platform"));
+	return false;
+#endif
+}
+
+void FVehicleLiveFeed::Close()
+{
+	if (Header == nullptr)
+	{
+		return;
+	}
+
+#if PLATFORM_LINUX || PLATFORM_MAC
+	UE_LOG(LogVehicleLiveFeed, Log, TEXT("Closing live feed %s after %llu samples"), *SegmentName, (uint64)Header->WriteCount);
+
+	Header->bOpen = 0;
+	FPlatformMisc::MemoryBarrier();
+	munmap(Header, SegmentSize);
+	shm_unlink(TCHAR_TO_UTF8(*SegmentName));
+#endif
+
+	Header = nullptr;
+	Slots = nullptr;
+	SegmentSize = 0;
+}
+
+void FVehicleLiveFeed::RemoveSegment(const FString& Name)
+{
+#if PLATFORM_LINUX || PLATFORM_MAC
+	const int File = shm_open(TCHAR_TO_UTF8(*Name), O_RDWR, 0);
+	if (File < 0)
+	{
+		return;
+	}
+
+	struct stat FileStat;
+	if ((fstat(File, &FileStat) == 0) && (FileStat.st_size >= (off_t)sizeof(FHeader)))
+	{
+		void* View = mmap(nullptr, sizeof(FHeader), PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+		if (View != MAP_FAILED)
+		{
+			((FHeader*)View)->bOpen = 0;
+			munmap(View, sizeof(FHeader));
+		}
+	}
+	close(File);
+	shm_unlink(TCHAR_TO_UTF8(*Name));
+#endif
+}
+
+void FVehicleLiveFeed::Publish(const FSample& Sample)
+{
+	if (Header == nullptr)
+	{
+		return;
+	}
+
+	const uint64 Index = Header->WriteCount;
+	FSlot& Slot = Slots[Index % Header->NumSlots];
+
+	// Odd while we write, a reader copying the slot meanwhile throws its copy away
+	const uint32 Sequence = Slot.Sequence;
+	Slot.Sequence = Sequence + 1;
+	FPlatformMisc::MemoryBarrier();
+
+	Slot.Index = Index;
+	Slot.Sample = Sample;
+
+	FPlatformMisc::MemoryBarrier();
+	Slot.Sequence = Sequence + 2;
+	FPlatformMisc::MemoryBarrier();
+	Header->WriteCount = Index + 1;
+}
+
+void FVehicleLiveFeed::FillSample(const AWheeledVehicle* Vehicle, FSample& OutSample)
+{
+	FMemory::Memzero(&OutSample, sizeof(OutSample));
+	OutSample.FrameNumber = GFrameCounter;
+	OutSample.WorldTime = Vehicle->GetWorld()->GetTimeSeconds();
+	OutSample.VehicleId = Vehicle->GetUniqueID();
+
+	UWheeledVehicleMovementComponent* Movement = Vehicle->VehicleMovement;
+	OutSample.Gear = Movement->GetCurrentGear();
+	OutSample.Speed = Movement->GetForwardSpeed();
+	OutSample.RPM = Movement->GetEngineRotationSpeed();
+	OutSample.MaxRPM = Movement->GetEngineMaxRotationSpeed();
+
+	const FVector Location = Vehicle->GetActorLocation();
+	const FQuat Rotation = Vehicle->GetActorQuat();
+	OutSample.Location[0] = Location.X;
+	OutSample.Location[1] = Location.Y;
+	OutSample.Location[2] = Location.Z;
+	OutSample.Rotation[0] = Rotation.X;
+	OutSample.Rotation[1] = Rotation.Y;
+	OutSample.Rotation[2] = Rotation.Z;
+	OutSample.Rotation[3] = Rotation.W;
+}
+
+static void StartLiveFeed(const TArray<FString>& Args)
+{
+	int32 NumSlots = DefaultNumSlots;
+	if (Args.Num() > 1)
+	{
+		NumSlots = FCString::Atoi(*Args[1]);
+	}
+	FVehicleLiveFeed::Get().Open((Args.Num() > 0) ? Args[0] : FString(), NumSlots);
+}
+
+static void StopLiveFeed()
+{
+	FVehicleLiveFeed::Get().Close();
+}
+
+static FAutoConsoleCommand StartLiveFeedCommand(
+	TEXT("Vehicle.LiveFeed.Start"),
+	TEXT("Publish every vehicle's state each tick to shared memory, optional name (default /VehicleLiveFeed) and ring size"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&StartLiveFeed)
+	);
+
+static FAutoConsoleCommand StopLiveFeedCommand(
+	TEXT("Vehicle.LiveFeed.Stop"),
+	TEXT("Stop publishing vehicle state and remove the shared memory"),
+	FConsoleCommandDelegate::CreateStatic(&StopLiveFeed)
+	);
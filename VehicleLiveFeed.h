@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VehicleLiveFeedFormat.h"
+
+class AWheeledVehicle;
+
+/**
+ * Publishes every vehicle's state each tick into a POSIX shared memory ring (VehicleLiveFeedFormat)
+ * for sim rigs and dashboards outside the game, see LiveFeed/ for the reader. Publishing is a
+ * copy into the ring with no locks or system calls, readers that fall behind lose the oldest
+ * samples and never slow the game down. The feed is closed on engine pre-exit, a segment left by a
+ * crash is removed by the next Open.
+ */
+class FVehicleLiveFeed
+{
+public:
+	static FVehicleLiveFeed& Get();
+
+	/**
+	 * Create the shared memory segment, replacing one left by an earlier run.
+	 *
+	 * @param	Name		shm_open name, VehicleLiveFeedFormat::DefaultName when empty
+	 * @param	NumSlots	samples the ring holds before the oldest are overwritten
+	 */
+	bool Open(const FString& Name, int32 NumSlots = VehicleLiveFeedFormat::DefaultNumSlots);
+
+	/** Tell the readers and remove the segment */
+	void Close();
+
+	bool IsOpen() const { return Header != nullptr; }
+
+	/** Copy a sample into the ring, game thread only */
+	void Publish(const VehicleLiveFeedFormat::FSample& Sample);
+
+	/** Fill the frame, movement and transform of a vehicle, the inputs and lap times are left at 0 */
+	static void FillSample(const AWheeledVehicle* Vehicle, VehicleLiveFeedFormat::FSample& OutSample);
+
+	uint64 GetNumPublished() const { return (Header != nullptr) ? Header->WriteCount : 0; }
+
+private:
+	FVehicleLiveFeed();
+
+	/** Close before the engine shuts down, the logging is gone by static destruction */
+	static void OnPreExit();
+
+	/** Mark a segment left by an earlier open closed so its readers move on, then remove it */
+	void RemoveSegment(const FString& Name);
+
+	VehicleLiveFeedFormat::FHeader* Header;
+	VehicleLiveFeedFormat::FSlot* Slots;
+	uint64 SegmentSize;
+	FString SegmentName;
+};
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Included by the game and by the readers in LiveFeed/, which are built without the engine
+#include <stdint.h>
+
+/**
+ * Shared memory layout of the live vehicle feed
+ *
+ *	Header		Magic, Version, sizes, SessionId, WriteCount
+ *	Slot*		NumSlots slots, sample N of the session is written to slot N % NumSlots
+ *
+ * The game is the only writer. Every slot is a seqlock: the writer makes Sequence odd, writes
+ * the slot and makes Sequence even again before bumping WriteCount. A reader copies a slot
+ * between two reads of Sequence and keeps the copy only when both were the same even value and
+ * the slot still holds the sample it asked for. Nothing in the segment refers to readers, so
+ * they attach and detach whenever they like and can never hold up the game.
+ */
+namespace VehicleLiveFeedFormat
+{
+	const uint32_t Magic = 0x4646564C; // 'LVFF'
+	const uint32_t Version = 1;
+	const uint32_t DefaultNumSlots = 4096;
+	/** shm_open name */
+	const char* const DefaultName = "/VehicleLiveFeed";
+
+	struct FHeader
+	{
+		/** Written last when the game opens the feed, readers wait for it */
+		volatile uint32_t Magic;
+		uint32_t Version;
+		uint32_t HeaderSize;
+		uint32_t SlotSize;
+		uint32_t NumSlots;
+		/** Cleared when the game closes the feed, readers should detach and attach again */
+		volatile uint32_t bOpen;
+		/** Different every time the game opens the feed */
+		uint64_t SessionId;
+		/** Samples published this session */
+		volatile uint64_t WriteCount;
+	};
+
+	/** State of one vehicle after one tick */
+	struct FSample
+	{
+		uint64_t FrameNumber;
+		/** Game time in seconds */
+		double WorldTime;
+		/** Same for a vehicle for the whole session */
+		uint32_t VehicleId;
+		int32_t Gear;
+		/** Forward speed in cm/s */
+		float Speed;
+		float RPM;
+		float MaxRPM;
+		float Throttle;
+		float Steering;
+		uint32_t bHandbrake;
+		/** World location in cm */
+		float Location[3];
+		/** World rotation quaternion X, Y, Z, W */
+		float Rotation[4];
+		int64_t LapTimeUs;
+		int64_t LastLapUs;
+		int64_t BestLapUs;
+		int32_t Lap;
+		uint32_t Reserved;
+	};
+
+	struct FSlot
+	{
+		/** Odd while the game is writing the slot */
+		volatile uint32_t Sequence;
+		uint32_t Reserved;
+		/** Number of the sample in the slot */
+		uint64_t Index;
+		FSample Sample;
+	};
+
+	inline uint64_t GetSegmentSize(uint32_t NumSlots)
+	{
+		return sizeof(FHeader) + (uint64_t)NumSlots * sizeof(FSlot);
+	}
+
+	inline FSlot* GetSlots(FHeader* Header)
+	{
+		return (FSlot*)((uint8_t*)Header + sizeof(FHeader));
+	}
+
+	inline const FSlot* GetSlots(const FHeader* Header)
+	{
+		return (const FSlot*)((const uint8_t*)Header + sizeof(FHeader));
+	}
+}
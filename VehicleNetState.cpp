@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleNetState.h"
+#include "VehicleStats.h"
+
+DEFINE_STAT(STAT_VehicleNetStateBits);
+
+uint64 FVehicleReplicatedState::TotalBitsWritten = 0;
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarNetKeyframeInterval(
+		TEXT("Vehicle.Net.KeyframeInterval"),
+		30,
+		TEXT("Vehicle state updates sent as deltas before a full one, so a client that lost its baseline recovers."),
+		ECVF_Default);
+
+	/** The baseline of the last state sent on a connection */
+	class FVehicleNetBaseState : public INetDeltaBaseState
+	{
+	public:
+		FVehicleNetBaseState(const FVehicleNetSnapshot& InSnapshot, int32 InDeltasSinceKeyframe)
+			: Snapshot(InSnapshot)
+			, DeltasSinceKeyframe(InDeltasSinceKeyframe)
+		{
+		}
+
+		virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+		{
+			const FVehicleNetBaseState* Other = static_cast<FVehicleNetBaseState*>(OtherState);
+			return (Other != nullptr) && (Snapshot.StateId == Other->Snapshot.StateId);
+		}
+
+		FVehicleNetSnapshot Snapshot;
+
+		/** Updates sent against a baseline since the last full one */
+		int32 DeltasSinceKeyframe;
+	};
+
+	FORCEINLINE uint32 ZigZag(int32 Value)
+	{
+		return ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+	}
+
+	FORCEINLINE int32 UnZigZag(uint32 Value)
+	{
+		return (int32)(Value >> 1) ^ -(int32)(Value & 1);
+	}
+}
+
+void FVehicleNetSnapshot::ToValues(int32* OutValues) const
+{
+	int32* Out = OutValues;
+	*Out++ = InputSequence;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		*Out++ = Location[Axis];
+		*Out++ = Rotation[Axis];
+		*Out++ = LinearVelocity[Axis];
+		*Out++ = AngularVelocity[Axis];
+	}
+	for (int32 Wheel = 0; Wheel < NumWheels; ++Wheel)
+	{
+		*Out++ = WheelSpeed[Wheel];
+	}
+	*Out++ = Gear;
+	*Out++ = Throttle;
+	*Out++ = Steering;
+	*Out++ = bHandbrake;
+	check(Out - OutValues == NumValues);
+}
+
+void FVehicleNetSnapshot::FromValues(const int32* Values)
+{
+	const int32* In = Values;
+	InputSequence = (uint16)*In++;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Location[Axis] = *In++;
+		Rotation[Axis] = *In++;
+		LinearVelocity[Axis] = *In++;
+		AngularVelocity[Axis] = *In++;
+	}
+	for (int32 Wheel = 0; Wheel < NumWheels; ++Wheel)
+	{
+		WheelSpeed[Wheel] = *In++;
+	}
+	Gear = *In++;
+	Throttle = *In++;
+	Steering = *In++;
+	bHandbrake = *In++;
+}
+
+bool FVehicleNetSnapshot::IsStateEqual(const FVehicleNetSnapshot& Other) const
+{
+	int32 Values[NumValues];
+	int32 OtherValues[NumValues];
+	ToValues(Values);
+	Other.ToValues(OtherValues);
+	return FMemory::Memcmp(Values, OtherValues, sizeof(Values)) == 0;
+}
+
+void FVehicleNetSnapshot::SetState(const FVector& InLocation, const FRotator& InRotation, const FVector& InLinearVelocity, const FVector& InAngularVelocity)
+{
+	Location[0] = FMath::RoundToInt(InLocation.X * 2.0f);
+	Location[1] = FMath::RoundToInt(InLocation.Y * 2.0f);
+	Location[2] = FMath::RoundToInt(InLocation.Z * 2.0f);
+	Rotation[0] = FRotator::CompressAxisToShort(InRotation.Pitch);
+	Rotation[1] = FRotator::CompressAxisToShort(InRotation.Yaw);
+	Rotation[2] = FRotator::CompressAxisToShort(InRotation.Roll);
+	LinearVelocity[0] = FMath::RoundToInt(InLinearVelocity.X);
+	LinearVelocity[1] = FMath::RoundToInt(InLinearVelocity.Y);
+	LinearVelocity[2] = FMath::RoundToInt(InLinearVelocity.Z);
+	AngularVelocity[0] = FMath::RoundToInt(InAngularVelocity.X);
+	AngularVelocity[1] = FMath::RoundToInt(InAngularVelocity.Y);
+	AngularVelocity[2] = FMath::RoundToInt(InAngularVelocity.Z);
+}
+
+FVector FVehicleNetSnapshot::GetLocation() const
+{
+	return FVector(Location[0], Location[1], Location[2]) * 0.5f;
+}
+
+FRotator FVehicleNetSnapshot::GetRotation() const
+{
+	return FRotator(FRotator::DecompressAxisFromShort(Rotation[0]), FRotator::DecompressAxisFromShort(Rotation[1]), FRotator::DecompressAxisFromShort(Rotation[2]));
+}
+
+FVector FVehicleNetSnapshot::GetLinearVelocity() const
+{
+	return FVector(LinearVelocity[0], LinearVelocity[1], LinearVelocity[2]);
+}
+
+FVector FVehicleNetSnapshot::GetAngularVelocity() const
+{
+	return FVector(AngularVelocity[0], AngularVelocity[1], AngularVelocity[2]);
+}
+
+const FVehicleNetSnapshot* FVehicleReplicatedState::FindHistory(uint16 StateId) const
+{
+	for (int32 Index = 0; Index < FMath::Min<int32>(NumHistory, HistorySize); ++Index)
+	{
+		if (History[Index].StateId == StateId)
+		{
+			return &History[Index];
+		}
+	}
+	return nullptr;
+}
+
+void FVehicleReplicatedState::AddHistory(const FVehicleNetSnapshot& Received)
+{
+	History[NumHistory % HistorySize] = Received;
+	++NumHistory;
+}
+
+bool FVehicleReplicatedState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	int32 Values[FVehicleNetSnapshot::NumValues];
+	int32 BaseValues[FVehicleNetSnapshot::NumValues];
+
+	if (DeltaParms.Writer != nullptr)
+	{
+		FBitWriter& Writer = *DeltaParms.Writer;
+		const FVehicleNetBaseState* OldState = static_cast<FVehicleNetBaseState*>(DeltaParms.OldState);
+
+		// The client already has this one
+		if ((OldState != nullptr) && (OldState->Snapshot.StateId == Snapshot.StateId))
+		{
+			return false;
+		}
+
+		// A full state every so often, a client that dropped its baseline can't decode deltas against it
+		const bool bKeyframe = (OldState == nullptr) || (OldState->DeltasSinceKeyframe >= CVarNetKeyframeInterval.GetValueOnGameThread());
+
+		// Remembered by the engine and handed back as OldState once the client acks it
+		*DeltaParms.NewState = MakeShareable(new FVehicleNetBaseState(Snapshot, bKeyframe ? 0 : OldState->DeltasSinceKeyframe + 1));
+
+		const int64 StartBits = Writer.GetNumBits();
+
+		uint8 bHasBase = bKeyframe ? 0 : 1;
+		Writer.WriteBit(bHasBase);
+		uint16 StateId = Snapshot.StateId;
+		Writer << StateId;
+
+		Snapshot.ToValues(Values);
+		if (bHasBase == true)
+		{
+			uint16 BaseId = OldState->Snapshot.StateId;
+			Writer << BaseId;
+			OldState->Snapshot.ToValues(BaseValues);
+		}
+		else
+		{
+			FMemory::Memzero(BaseValues, sizeof(BaseValues));
+		}
+
+		for (int32 Index = 0; Index < FVehicleNetSnapshot::NumValues; ++Index)
+		{
+			const uint8 bChanged = (Values[Index] != BaseValues[Index]) ? 1 : 0;
+			Writer.WriteBit(bChanged);
+			if (bChanged == true)
+			{
+				uint32 Packed = ZigZag((int32)((uint32)Values[Index] - (uint32)BaseValues[Index]));
+				Writer.SerializeIntPacked(Packed);
+			}
+		}
+
+		const int64 NumBits = Writer.GetNumBits() - StartBits;
+		TotalBitsWritten += NumBits;
+		INC_DWORD_STAT_BY(STAT_VehicleNetStateBits, (uint32)NumBits);
+		return true;
+	}
+
+	if (DeltaParms.Reader != nullptr)
+	{
+		FBitReader& Reader = *DeltaParms.Reader;
+
+		const bool bHasBase = Reader.ReadBit() != 0;
+		uint16 StateId = 0;
+		Reader << StateId;
+
+		const FVehicleNetSnapshot* Base = nullptr;
+		if (bHasBase == true)
+		{
+			uint16 BaseId = 0;
+			Reader << BaseId;
+			Base = FindHistory(BaseId);
+		}
+
+		if (Base != nullptr)
+		{
+			Base->ToValues(BaseValues);
+		}
+		else
+		{
+			FMemory::Memzero(BaseValues, sizeof(BaseValues));
+		}
+
+		// Always read everything so the bunch stays in sync, even if the result is thrown away
+		for (int32 Index = 0; Index < FVehicleNetSnapshot::NumValues; ++Index)
+		{
+			Values[Index] = BaseValues[Index];
+			if (Reader.ReadBit() != 0)
+			{
+				uint32 Packed = 0;
+				Reader.SerializeIntPacked(Packed);
+				Values[Index] = (int32)((uint32)Values[Index] + (uint32)UnZigZag(Packed));
+			}
+		}
+
+		if (Reader.IsError() == true)
+		{
+			return false;
+		}
+
+		bMissedBaseline = (bHasBase == true) && (Base == nullptr);
+		if (bMissedBaseline == true)
+		{
+			// Nothing received since can be trusted as a baseline, wait for the next full state
+			NumHistory = 0;
+		}
+		else
+		{
+			FVehicleNetSnapshot Received;
+			Received.FromValues(Values);
+			Received.StateId = StateId;
+			Snapshot = Received;
+			AddHistory(Received);
+		}
+		return true;
+	}
+
+	return true;
+}
+
+namespace
+{
+	/** Vehicle.Net.Stats: bytes per second sent to each client and the share used by vehicle state */
+	void LogNetStats(UWorld* World)
+	{
+		static double LastTime = 0.0;
+		static uint64 LastBits = 0;
+
+		const double Now = FPlatformTime::Seconds();
+		const double Elapsed = Now - LastTime;
+		const uint64 Bits = FVehicleReplicatedState::TotalBitsWritten;
+		if ((LastTime > 0.0) && (Elapsed > 0.0))
+		{
+			UE_LOG(LogNet, Display, TEXT("Vehicle state: %.0f bytes/s over %.1f s, all clients"), (Bits - LastBits) / 8.0 / Elapsed, Elapsed);
+		}
+		LastTime = Now;
+		LastBits = Bits;
+
+		UNetDriver* NetDriver = (World != nullptr) ? World->GetNetDriver() : nullptr;
+		if (NetDriver == nullptr)
+		{
+			UE_LOG(LogNet, Display, TEXT("Not networked"));
+			return;
+		}
+
+		if (NetDriver->ServerConnection != nullptr)
+		{
+			UE_LOG(LogNet, Display, TEXT("Server connection: in %d bytes/s, out %d bytes/s"), NetDriver->ServerConnection->InBytesPerSecond, NetDriver->ServerConnection->OutBytesPerSecond);
+		}
+
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			UE_LOG(LogNet, Display, TEXT("Client %s: out %d bytes/s, in %d bytes/s"), *Connection->LowLevelGetRemoteAddress(), Connection->OutBytesPerSecond, Connection->InBytesPerSecond);
+		}
+	}
+
+	FAutoConsoleCommandWithWorld NetStatsCommand(
+		TEXT("Vehicle.Net.Stats"),
+		TEXT("Log bandwidth per client and the vehicle state share since the last call"),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&LogNetStats));
+}
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VehicleNetState.generated.h"
+
+/**
+ * Quantized vehicle state as it goes over the network.
+ * Everything is an integer so a snapshot can be compared exactly and sent as deltas.
+ */
+struct FVehicleNetSnapshot
+{
+	enum
+	{
+		NumWheels = 4,
+		/** Number of values in ToValues / FromValues */
+		NumValues = 1 + 3 + 3 + 3 + 3 + NumWheels + 4,
+	};
+
+	/** Bumped by the server whenever the snapshot changes, clients keep recent ones by id */
+	uint16 StateId;
+	/** Last owner input the server had applied */
+	uint16 InputSequence;
+	/** Location in half centimetres */
+	int32 Location[3];
+	/** Pitch, yaw, roll as FRotator::CompressAxisToShort */
+	int32 Rotation[3];
+	/** Linear velocity in cm/s */
+	int32 LinearVelocity[3];
+	/** Angular velocity in degrees/s */
+	int32 AngularVelocity[3];
+	/** Wheel rotation speed in degrees/s */
+	int32 WheelSpeed[NumWheels];
+	int32 Gear;
+	/** Inputs scaled to -127..127 */
+	int32 Throttle;
+	int32 Steering;
+	int32 bHandbrake;
+
+	FVehicleNetSnapshot()
+	{
+		FMemory::Memzero(this, sizeof(*this));
+	}
+
+	void ToValues(int32* OutValues) const;
+	void FromValues(const int32* Values);
+
+	/** Same vehicle state, the ids are not compared */
+	bool IsStateEqual(const FVehicleNetSnapshot& Other) const;
+
+	/** Quantize a world state */
+	void SetState(const FVector& InLocation, const FRotator& InRotation, const FVector& InLinearVelocity, const FVector& InAngularVelocity);
+
+	FVector GetLocation() const;
+	FRotator GetRotation() const;
+	FVector GetLinearVelocity() const;
+	FVector GetAngularVelocity() const;
+
+	static int32 QuantizeInput(float Value) { return FMath::Clamp(FMath::RoundToInt(Value * 127.0f), -127, 127); }
+	static float DequantizeInput(int32 Value) { return Value / 127.0f; }
+};
+
+/** One tick of owner input sent to the server */
+USTRUCT()
+struct FVehicleNetInput
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	uint16 Sequence;
+
+	/** -127..127 */
+	UPROPERTY()
+	int8 Throttle;
+
+	UPROPERTY()
+	int8 Steering;
+
+	UPROPERTY()
+	bool bHandbrake;
+
+	FVehicleNetInput()
+		: Sequence(0)
+		, Throttle(0)
+		, Steering(0)
+		, bHandbrake(false)
+	{
+	}
+};
+
+/** What the owning client predicted for one input, compared with the server later */
+struct FVehicleNetPrediction
+{
+	uint16 Sequence;
+	FVector Location;
+	FQuat Rotation;
+	FVector LinearVelocity;
+};
+
+/**
+ * Replicated vehicle state. Sent as a bit mask of the changed values followed by their packed
+ * differences to the last state the client acknowledged, or to zero when there is none and for the
+ * full keyframe sent every Vehicle.Net.KeyframeInterval updates.
+ */
+USTRUCT()
+struct FVehicleReplicatedState
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Current state on the server, last received on clients */
+	FVehicleNetSnapshot Snapshot;
+
+	/** Set when a snapshot arrived that could not be decoded against a known baseline */
+	bool bMissedBaseline;
+
+	FVehicleReplicatedState()
+		: bMissedBaseline(false)
+		, NumHistory(0)
+	{
+	}
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+	/** Bits written for vehicle state by this process, for bandwidth reporting */
+	static uint64 TotalBitsWritten;
+
+private:
+	/** Recently received snapshots, the server may use any of them as the baseline */
+	enum { HistorySize = 32 };
+	FVehicleNetSnapshot History[HistorySize];
+	int32 NumHistory;
+
+	const FVehicleNetSnapshot* FindHistory(uint16 StateId) const;
+	void AddHistory(const FVehicleNetSnapshot& Received);
+};
+
+template<>
+struct TStructOpsTypeTraits<FVehicleReplicatedState> : public TStructOpsTypeTraitsBase
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
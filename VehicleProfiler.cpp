@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleProfiler.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVehicleProfiler, Log, All);
+
+namespace
+{
+	const TCHAR* ScopeNames[FVehicleProfiler::NumScopes] =
+	{
+		TEXT("PawnTick"),
+		TEXT("TickManager"),
+		TEXT("UpdateHUDStrings"),
+		TEXT("SetupInCarHUD"),
+		TEXT("UpdatePhysicsMaterial"),
+		TEXT("EnableIncarView"),
+		TEXT("DrawHUD"),
+	};
+
+	const TCHAR* CounterNames[FVehicleProfiler::NumCounters] =
+	{
+		TEXT("VehiclesTicked"),
+		TEXT("StringsReformatted"),
+		TEXT("MaterialSwaps"),
+		TEXT("InCarRenderStates"),
+	};
+
+	/** Value at a percentile of sorted samples */
+	float Percentile(const TArray<float>& Sorted, float Percent)
+	{
+		if (Sorted.Num() == 0)
+		{
+			return 0.0f;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Percent / 100.0f * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	}
+
+	void WriteLine(FArchive& File, const FString& Line)
+	{
+		FTCHARToUTF8 Converted(*(Line + LINE_TERMINATOR));
+		File.Serialize((void*)Converted.Get(), Converted.Length());
+	}
+}
+
+FVehicleProfiler& FVehicleProfiler::Get()
+{
+	static FVehicleProfiler Profiler;
+	return Profiler;
+}
+
+FSimpleMulticastDelegate& FVehicleProfiler::OnEndFrame()
+{
+	static FSimpleMulticastDelegate Delegate;
+	return Delegate;
+}
+
+FVehicleProfiler::FVehicleProfiler()
+	: File(nullptr)
+	, NumFrames(0)
+{
+	FMemory::Memzero(ScopeCycles, sizeof(ScopeCycles));
+	FMemory::Memzero(Counts, sizeof(Counts));
+}
+
+TStatId FVehicleProfiler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FVehicleProfiler, STATGROUP_Tickables);
+}
+
+void FVehicleProfiler::StartCapture(const FString& Name)
+{
+	check(IsInGameThread());
+	if (IsCapturing() == true)
+	{
+		StopCapture();
+	}
+
+	FilePath = FPaths::GameSavedDir() / TEXT("Profiling") / ((Name.Len() > 0) ? Name : FDateTime::Now().ToString()) + TEXT(".csv");
+	File = IFileManager::Get().CreateFileWriter(*FilePath);
+	if (File == nullptr)
+	{
+		UE_LOG(LogVehicleProfiler, Warning, TEXT("Could not open %s"), *FilePath);
+		return;
+	}
+
+	FString Header = TEXT("Frame,FrameMs");
+	for (int32 Scope = 0; Scope < NumScopes; ++Scope)
+	{
+		Header += FString::Printf(TEXT(",%sMs"), ScopeNames[Scope]);
+	}
+	for (int32 Counter = 0; Counter < NumCounters; ++Counter)
+	{
+		Header += FString::Printf(TEXT(",%s"), CounterNames[Counter]);
+	}
+	WriteLine(*File, Header);
+
+	NumFrames = 0;
+	FMemory::Memzero(ScopeCycles, sizeof(ScopeCycles));
+	FMemory::Memzero(Counts, sizeof(Counts));
+	for (int32 Scope = 0; Scope < NumScopes; ++Scope)
+	{
+		ScopeSamples[Scope].Reset();
+	}
+	FrameSamples.Reset();
+
+	UE_LOG(LogVehicleProfiler, Log, TEXT("Capturing vehicle frames to %s"), *FilePath);
+}
+
+void FVehicleProfiler::StopCapture()
+{
+	if (IsCapturing() == false)
+	{
+		return;
+	}
+
+	File->Close();
+	delete File;
+	File = nullptr;
+
+	UE_LOG(LogVehicleProfiler, Log, TEXT("Wrote %u frames to %s"), NumFrames, *FilePath);
+	LogSummary();
+}
+
+void FVehicleProfiler::Tick(float DeltaTime)
+{
+	// Tickables run once a frame after the world, so this is where one frame ends
+	OnEndFrame().Broadcast();
+	if (IsCapturing() == true)
+	{
+		EndFrame(DeltaTime);
+	}
+	else
+	{
+		FMemory::Memzero(ScopeCycles, sizeof(ScopeCycles));
+		FMemory::Memzero(Counts, sizeof(Counts));
+	}
+}
+
+void FVehicleProfiler::EndFrame(float DeltaTime)
+{
+	const float FrameMs = DeltaTime * 1000.0f;
+	FString Line = FString::Printf(TEXT("%u,%.3f"), NumFrames, FrameMs);
+	FrameSamples.Add(FrameMs);
+	for (int32 Scope = 0; Scope < NumScopes; ++Scope)
+	{
+		const float ScopeMs = FPlatformTime::ToMilliseconds(ScopeCycles[Scope]);
+		Line += FString::Printf(TEXT(",%.4f"), ScopeMs);
+		ScopeSamples[Scope].Add(ScopeMs);
+	}
+	for (int32 Counter = 0; Counter < NumCounters; ++Counter)
+	{
+		Line += FString::Printf(TEXT(",%d"), Counts[Counter]);
+	}
+	WriteLine(*File, Line);
+
+	++NumFrames;
+	FMemory::Memzero(ScopeCycles, sizeof(ScopeCycles));
+	FMemory::Memzero(Counts, sizeof(Counts));
+}
+
+const TCHAR* FVehicleProfiler::GetScopeName(EScope Scope)
+{
+	return ScopeNames[Scope];
+}
+
+float FVehicleProfiler::GetPercentile(const TArray<float>& Samples, float Percent)
+{
+	TArray<float> Sorted = Samples;
+	Sorted.Sort();
+	return Percentile(Sorted, Percent);
+}
+
+void FVehicleProfiler::LogSummary() const
+{
+	if (FrameSamples.Num() == 0)
+	{
+		UE_LOG(LogVehicleProfiler, Display, TEXT("No frames captured, start a capture with Vehicle.Profile.Start"));
+		return;
+	}
+
+	UE_LOG(LogVehicleProfiler, Display, TEXT("%d frames%s"), FrameSamples.Num(), IsCapturing() ? TEXT(", still capturing") : TEXT(""));
+	UE_LOG(LogVehicleProfiler, Display, TEXT("  %-24s %10s %10s %10s %10s"), TEXT("Scope (ms)"), TEXT("p50"), TEXT("p95"), TEXT("p99"), TEXT("max"));
+
+	TArray<float> Sorted = FrameSamples;
+	Sorted.Sort();
+	UE_LOG(LogVehicleProfiler, Display, TEXT("  %-24s %10.3f %10.3f %10.3f %10.3f"), TEXT("Frame"), Percentile(Sorted, 50.0f), Percentile(Sorted, 95.0f), Percentile(Sorted, 99.0f), Sorted.Last());
+	for (int32 Scope = 0; Scope < NumScopes; ++Scope)
+	{
+		Sorted = ScopeSamples[Scope];
+		Sorted.Sort();
+		UE_LOG(LogVehicleProfiler, Display, TEXT("  %-24s %10.4f %10.4f %10.4f %10.4f"), ScopeNames[Scope], Percentile(Sorted, 50.0f), Percentile(Sorted, 95.0f), Percentile(Sorted, 99.0f), Sorted.Last());
+	}
+}
+
+static void StartVehicleProfile(const TArray<FString>& Args)
+{
+	FVehicleProfiler::Get().StartCapture((Args.Num() > 0) ? Args[0] : FString());
+}
+
+static void StopVehicleProfile()
+{
+	FVehicleProfiler::Get().StopCapture();
+}
+
+static void LogVehicleProfileSummary()
+{
+	FVehicleProfiler::Get().LogSummary();
+}
+
+static FAutoConsoleCommand StartVehicleProfileCommand(
+	TEXT("Vehicle.Profile.Start"),
+	TEXT("Capture per frame vehicle timings and counts to Saved/Profiling/<name>.csv, the name defaults to a timestamp"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&StartVehicleProfile)
+	);
+
+static FAutoConsoleCommand StopVehicleProfileCommand(
+	TEXT("Vehicle.Profile.Stop"),
+	TEXT("Stop the vehicle frame capture, close the file and log the summary"),
+	FConsoleCommandDelegate::CreateStatic(&StopVehicleProfile)
+	);
+
+static FAutoConsoleCommand VehicleProfileSummaryCommand(
+	TEXT("Vehicle.Profile.Summary"),
+	TEXT("Log p50/p95/p99 of every vehicle scope over the current or last capture"),
+	FConsoleCommandDelegate::CreateStatic(&LogVehicleProfileSummary)
+	);
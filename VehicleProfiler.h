@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Tickable.h"
+
+/**
+ * Per frame timings of the vehicle code, written to a CSV file while capturing.
+ * Works without the stats system, so captures can be taken in test builds. Each frame is one row
+ * with the milliseconds spent in every scope and the counters, and the summary gives the p50, p95
+ * and p99 of each scope over the capture.
+ */
+class FVehicleProfiler : public FTickableGameObject
+{
+public:
+	enum EScope
+	{
+		PawnTick,
+		TickManager,
+		UpdateHUDStrings,
+		SetupInCarHUD,
+		UpdatePhysicsMaterial,
+		EnableIncarView,
+		DrawHUD,
+		NumScopes,
+	};
+
+	enum ECounter
+	{
+		VehiclesTicked,
+		StringsReformatted,
+		MaterialSwaps,
+		InCarRenderStates,
+		NumCounters,
+	};
+
+	static FVehicleProfiler& Get();
+
+	/**
+	 * Broadcast once a frame after the world has ticked, before the frame is written. Per frame
+	 * vehicle stats are reported from here, so self ticking vehicles don't report them once each.
+	 */
+	static FSimpleMulticastDelegate& OnEndFrame();
+
+	/** Start writing frames to Saved/Profiling/<Name or timestamp>.csv */
+	void StartCapture(const FString& Name);
+
+	void StopCapture();
+
+	bool IsCapturing() const { return File != nullptr; }
+
+	/** Time spent in a scope this frame */
+	FORCEINLINE void AddCycles(EScope Scope, uint32 Cycles)
+	{
+		ScopeCycles[Scope] += Cycles;
+	}
+
+	FORCEINLINE void AddCount(ECounter Counter, int32 Count)
+	{
+		Counts[Counter] += Count;
+	}
+
+	/** Log the p50, p95 and p99 of every scope over the current or last capture */
+	void LogSummary() const;
+
+	/** Milliseconds of each frame of the current or last capture */
+	const TArray<float>& GetScopeSamples(EScope Scope) const { return ScopeSamples[Scope]; }
+	const TArray<float>& GetFrameSamples() const { return FrameSamples; }
+
+	static const TCHAR* GetScopeName(EScope Scope);
+
+	/** Value at a percentile (0-100) of unsorted samples */
+	static float GetPercentile(const TArray<float>& Samples, float Percent);
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return true; }
+	virtual bool IsTickableWhenPaused() const override { return true; }
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+private:
+	FVehicleProfiler();
+
+	/** Write the frame that just ended and start the next one */
+	void EndFrame(float DeltaTime);
+
+	FArchive* File;
+	FString FilePath;
+	uint32 NumFrames;
+	uint32 ScopeCycles[NumScopes];
+	int32 Counts[NumCounters];
+	/** Milliseconds of every captured frame, for the summary */
+	TArray<float> ScopeSamples[NumScopes];
+	TArray<float> FrameSamples;
+};
+
+/** Adds the time until the end of the scope to the profiler when it is capturing */
+struct FVehicleProfileScope
+{
+	FORCEINLINE FVehicleProfileScope(FVehicleProfiler::EScope InScope)
+		: Scope(InScope)
+		, StartCycles(FVehicleProfiler::Get().IsCapturing() ? FPlatformTime::Cycles() : 0)
+	{
+	}
+
+	FORCEINLINE ~FVehicleProfileScope()
+	{
+		if (StartCycles != 0)
+		{
+			FVehicleProfiler::Get().AddCycles(Scope, FPlatformTime::Cycles() - StartCycles);
+		}
+	}
+
+private:
+	FVehicleProfiler::EScope Scope;
+	uint32 StartCycles;
+};
+
+/** Cycle counter in STATGROUP_Vehicle and a profiler scope for the rest of the block */
+#define VEHICLE_SCOPE_CYCLE_COUNTER(Stat, Scope) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	FVehicleProfileScope VehicleProfileScope_##Scope(FVehicleProfiler::Scope)
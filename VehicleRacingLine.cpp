@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleRacingLine.h"
+
+void FVehicleRacingLine::Build(const TArray<FVector>& InPoints, float InSpacing, bool bInClosedLoop, const FVehicleRacingLineLimits& Limits)
+{
+	Points = InPoints;
+	Spacing = FMath::Max(InSpacing, 1.0f);
+	bClosedLoop = bInClosedLoop;
+
+	const int32 Count = Points.Num();
+	Curvature.Init(0.0f, Count);
+	TargetSpeed.Init(Limits.MaxSpeed, Count);
+	if (Count < 3)
+	{
+		return;
+	}
+
+	// Turn angle between the neighbouring segments over the distance it happens in
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if ((bClosedLoop == false) && ((Index == 0) || (Index == Count - 1)))
+		{
+			continue;
+		}
+
+		const FVector In = (Points[Index] - Points[Wrap(Index - 1)]).GetSafeNormal();
+		const FVector Out = (Points[Wrap(Index + 1)] - Points[Index]).GetSafeNormal();
+		const float Angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(In, Out), -1.0f, 1.0f));
+		Curvature[Index] = Angle / Spacing;
+
+		if (Curvature[Index] > KINDA_SMALL_NUMBER)
+		{
+			TargetSpeed[Index] = FMath::Min(FMath::Sqrt(Limits.MaxLateralAccel / Curvature[Index]), Limits.MaxSpeed);
+		}
+	}
+
+	// Brake in time for every corner (v^2 = u^2 + 2as), twice round a loop so it wraps
+	const int32 Passes = bClosedLoop ? 2 : 1;
+	for (int32 Pass = 0; Pass < Passes; ++Pass)
+	{
+		for (int32 Index = Count - 2 + (bClosedLoop ? 1 : 0); Index >= 0; --Index)
+		{
+			const float Next = TargetSpeed[Wrap(Index + 1)];
+			TargetSpeed[Index] = FMath::Min(TargetSpeed[Index], FMath::Sqrt(Next * Next + 2.0f * Limits.MaxBrakeDecel * Spacing));
+		}
+	}
+
+	// And do not ask for more than the car can accelerate to
+	for (int32 Pass = 0; Pass < Passes; ++Pass)
+	{
+		for (int32 Index = (bClosedLoop ? 0 : 1); Index < Count; ++Index)
+		{
+			const float Previous = TargetSpeed[Wrap(Index - 1)];
+			TargetSpeed[Index] = FMath::Min(TargetSpeed[Index], FMath::Sqrt(Previous * Previous + 2.0f * Limits.MaxAccel * Spacing));
+		}
+	}
+}
+
+int32 FVehicleRacingLine::FindNearest(const FVector& Location, int32 Hint) const
+{
+	if (Points.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+	if (Points.IsValidIndex(Hint) == false)
+	{
+		return FindNearestFull(Location);
+	}
+
+	// Walk whichever way gets closer
+	int32 Best = Hint;
+	float BestDistSquared = FVector::DistSquared(Points[Best], Location);
+	for (int32 Direction = -1; Direction <= 1; Direction += 2)
+	{
+		for (int32 Step = 0; Step < 64; ++Step)
+		{
+			const int32 Next = Wrap(Best + Direction);
+			const float DistSquared = FVector::DistSquared(Points[Next], Location);
+			if ((Next == Best) || (DistSquared >= BestDistSquared))
+			{
+				break;
+			}
+			Best = Next;
+			BestDistSquared = DistSquared;
+		}
+	}
+	return Best;
+}
+
+int32 FVehicleRacingLine::FindNearestFull(const FVector& Location) const
+{
+	int32 Best = INDEX_NONE;
+	float BestDistSquared = MAX_FLT;
+	for (int32 Index = 0; Index < Points.Num(); ++Index)
+	{
+		const float DistSquared = FVector::DistSquared(Points[Index], Location);
+		if (DistSquared < BestDistSquared)
+		{
+			Best = Index;
+			BestDistSquared = DistSquared;
+		}
+	}
+	return Best;
+}
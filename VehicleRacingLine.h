@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/** Limits used to turn the line's curvature into a speed profile */
+struct FVehicleRacingLineLimits
+{
+	/** Sideways grip in cm/s^2 */
+	float MaxLateralAccel;
+	/** Braking in cm/s^2 */
+	float MaxBrakeDecel;
+	/** Acceleration in cm/s^2 */
+	float MaxAccel;
+	/** Top speed in cm/s */
+	float MaxSpeed;
+
+	FVehicleRacingLineLimits()
+		: MaxLateralAccel(900.0f)
+		, MaxBrakeDecel(1200.0f)
+		, MaxAccel(500.0f)
+		, MaxSpeed(4000.0f)
+	{
+	}
+};
+
+/**
+ * A racing line resampled at a fixed spacing with the speed each point can be taken at.
+ * The speed profile comes from the curvature (v = sqrt(a / k)) and is then limited by braking
+ * into and accelerating out of every corner. Read only once built, so it can be used from any thread.
+ */
+struct FVehicleRacingLine
+{
+	/** Points along the line, Spacing apart */
+	TArray<FVector> Points;
+	/** Curvature at each point in 1/cm */
+	TArray<float> Curvature;
+	/** Speed each point can be taken at in cm/s */
+	TArray<float> TargetSpeed;
+	float Spacing;
+	/** The last point connects back to the first */
+	bool bClosedLoop;
+
+	FVehicleRacingLine()
+		: Spacing(100.0f)
+		, bClosedLoop(true)
+	{
+	}
+
+	int32 Num() const { return Points.Num(); }
+
+	/** Index on the line, wrapped on a loop and clamped otherwise */
+	FORCEINLINE int32 Wrap(int32 Index) const
+	{
+		const int32 Count = Points.Num();
+		if (bClosedLoop == true)
+		{
+			return ((Index % Count) + Count) % Count;
+		}
+		return FMath::Clamp(Index, 0, Count - 1);
+	}
+
+	/**
+	 * Build from points that are already evenly spaced.
+	 *
+	 * @param	InPoints	points along the line
+	 * @param	InSpacing	distance between the points
+	 */
+	void Build(const TArray<FVector>& InPoints, float InSpacing, bool bInClosedLoop, const FVehicleRacingLineLimits& Limits);
+
+	/**
+	 * Nearest point to a location, searching around a previous result.
+	 * Cars only move a few points per frame, so this is a short walk rather than a full search.
+	 */
+	int32 FindNearest(const FVector& Location, int32 Hint) const;
+
+	/** Nearest point looking at every point, for the first lookup */
+	int32 FindNearestFull(const FVector& Location) const;
+};
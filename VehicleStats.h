@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+DECLARE_STATS_GROUP(TEXT("Vehicle"), STATGROUP_Vehicle, STATCAT_Advanced);
+
+/** HUD string formats that were served from the cache in the last second */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("HUD Formats Skipped/s"), STAT_VehicleHUDFormatsSkipped, STATGROUP_Vehicle, );
+/** HUD string formats that had to be rebuilt in the last second */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("HUD Formats Rebuilt/s"), STAT_VehicleHUDFormatsRebuilt, STATGROUP_Vehicle, );
+/** Physics material switches this frame, each one rebuilds the vehicle's physics shapes */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Friction Changes"), STAT_VehicleFrictionChanges, STATGROUP_Vehicle, );
+/** Game thread time of the onscreen HUD */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HUD Draw"), STAT_VehicleHUDDraw, STATGROUP_Vehicle, );
+/** HUD text elements laid out again this frame */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("HUD Elements Rebuilt"), STAT_VehicleHUDElementsRebuilt, STATGROUP_Vehicle, );
+/** Bits of replicated vehicle state written this frame, all connections */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Net State Bits"), STAT_VehicleNetStateBits, STATGROUP_Vehicle, );
+/** Game thread time of the race session: track distance, gates and standings */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Race Session"), STAT_VehicleRaceSession, STATGROUP_Vehicle, );
+/** Places swapped in the race standings this frame */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Race Position Swaps"), STAT_VehicleRacePositionSwaps, STATGROUP_Vehicle, );
+/** Game thread time scoring vehicle significance */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Significance"), STAT_VehicleSignificance, STATGROUP_Vehicle, );
+/** Vehicles that changed significance tier this frame */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Significance Changes"), STAT_VehicleSignificanceChanges, STATGROUP_Vehicle, );
+/** Game thread time of vehicles ticking themselves, and of the tick manager ticking the rest */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pawn Tick"), STAT_VehiclePawnTick, STATGROUP_Vehicle, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick Manager"), STAT_VehicleTickManager, STATGROUP_Vehicle, );
+/** Parts of the vehicle tick */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update HUD Strings"), STAT_VehicleUpdateHUDStrings, STATGROUP_Vehicle, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Setup InCar HUD"), STAT_VehicleSetupInCarHUD, STATGROUP_Vehicle, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Physics Material"), STAT_VehicleUpdatePhysicsMaterial, STATGROUP_Vehicle, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enable InCar View"), STAT_VehicleEnableIncarView, STATGROUP_Vehicle, );
+/** Game thread time handing out pooled vehicles, spawning included when the pool is empty */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pool Acquire"), STAT_VehiclePoolAcquire, STATGROUP_Vehicle, );
+/** In-car display render states created in the last second, by text mesh rebuilds or the dashboard */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("InCar Render States/s"), STAT_VehicleInCarRenderStates, STATGROUP_Vehicle, );
+/** Game thread ms of vehicle ticking per simulated vehicle second, over the last second */
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Sim ms/Vehicle s"), STAT_VehicleSimCost, STATGROUP_Vehicle, );
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleSubsystemSchedule.h"
+
+namespace
+{
+	/** Phase for the next vehicle, stepped by the golden ratio so any number of vehicles are spread evenly */
+	float NextVehiclePhase = 0.0f;
+
+	TAutoConsoleVariable<int32> CVarEveryFrame(
+		TEXT("Vehicle.Schedule.EveryFrame"),
+		0,
+		TEXT("1 runs every vehicle subsystem every frame, whatever its rate, for comparing against the old tick."),
+		ECVF_Cheat);
+}
+
+FVehicleSubsystemSchedule::FVehicleSubsystemSchedule()
+	: bForceAll(true)
+{
+	for (int32 Subsystem = 0; Subsystem < NumSubsystems; ++Subsystem)
+	{
+		BaseInterval[Subsystem] = 0.0f;
+		Interval[Subsystem] = 0.0f;
+		TimeLeft[Subsystem] = 0.0f;
+	}
+}
+
+void FVehicleSubsystemSchedule::Init(const FVehicleSubsystemRates& InRates)
+{
+	const float Rates[NumSubsystems] = { InRates.MaterialRate, InRates.HUDTextRate, InRates.AudioRate, InRates.CameraRate };
+
+	const float Phase = NextVehiclePhase;
+	NextVehiclePhase = FMath::Fractional(NextVehiclePhase + 0.618034f);
+
+	for (int32 Subsystem = 0; Subsystem < NumSubsystems; ++Subsystem)
+	{
+		BaseInterval[Subsystem] = ((InRates.bEveryFrame == false) && (Rates[Subsystem] > 0.0f)) ? 1.0f / Rates[Subsystem] : 0.0f;
+		Interval[Subsystem] = BaseInterval[Subsystem];
+		TimeLeft[Subsystem] = Interval[Subsystem] * Phase;
+	}
+
+	// Everything once straight away so nothing shows stale values
+	bForceAll = true;
+}
+
+void FVehicleSubsystemSchedule::SetRateScale(float Scale)
+{
+	const float InvScale = 1.0f / FMath::Max(Scale, 0.01f);
+	for (int32 Subsystem = 0; Subsystem < NumSubsystems; ++Subsystem)
+	{
+		Interval[Subsystem] = BaseInterval[Subsystem] * InvScale;
+		// Do not wait out a long interval from before when speeding up
+		TimeLeft[Subsystem] = FMath::Min(TimeLeft[Subsystem], Interval[Subsystem]);
+	}
+}
+
+uint32 FVehicleSubsystemSchedule::Advance(float DeltaSeconds)
+{
+	uint32 DueMask = 0;
+	for (int32 Subsystem = 0; Subsystem < NumSubsystems; ++Subsystem)
+	{
+		TimeLeft[Subsystem] -= DeltaSeconds;
+		if (TimeLeft[Subsystem] <= 0.0f)
+		{
+			// Keep the phase, but never owe more than one update
+			TimeLeft[Subsystem] = FMath::Max(TimeLeft[Subsystem] + Interval[Subsystem], 0.0f);
+			DueMask |= (1 << Subsystem);
+		}
+	}
+
+	if ((bForceAll == true) || (CVarEveryFrame.GetValueOnGameThread() != 0))
+	{
+		bForceAll = false;
+		DueMask = (1 << NumSubsystems) - 1;
+	}
+	return DueMask;
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VehicleSubsystemSchedule.generated.h"
+
+/** How often each part of a vehicle's tick runs, 0 runs it every frame */
+USTRUCT()
+struct FVehicleSubsystemRates
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Run everything every frame, the rates below are ignored */
+	UPROPERTY(Category = Schedule, EditAnywhere)
+	bool bEveryFrame;
+
+	/** Physics material switches, Hz */
+	UPROPERTY(Category = Schedule, EditAnywhere, meta = (ClampMin = "0"))
+	float MaterialRate;
+
+	/** HUD strings and the in-car text, Hz */
+	UPROPERTY(Category = Schedule, EditAnywhere, meta = (ClampMin = "0"))
+	float HUDTextRate;
+
+	/** Engine sound RPM parameter, Hz */
+	UPROPERTY(Category = Schedule, EditAnywhere, meta = (ClampMin = "0"))
+	float AudioRate;
+
+	/** In-car head look, Hz */
+	UPROPERTY(Category = Schedule, EditAnywhere, meta = (ClampMin = "0"))
+	float CameraRate;
+
+	FVehicleSubsystemRates()
+		: bEveryFrame(false)
+		, MaterialRate(10.0f)
+		, HUDTextRate(15.0f)
+		, AudioRate(30.0f)
+		, CameraRate(0.0f)
+	{
+	}
+};
+
+/**
+ * Decides which of a vehicle's subsystems are due this frame.
+ * Each vehicle gets its own phase so vehicles with the same rates do not all update on the same
+ * frame. A subsystem runs at most once a frame and a slow frame does not cause a burst of
+ * catch up updates.
+ */
+struct FVehicleSubsystemSchedule
+{
+	enum ESubsystem
+	{
+		Material,
+		HUDText,
+		Audio,
+		Camera,
+		NumSubsystems,
+	};
+
+	FVehicleSubsystemSchedule();
+
+	/** Set the rates and pick this vehicle's phase */
+	void Init(const FVehicleSubsystemRates& InRates);
+
+	/** Advance by a frame, returns a mask of the subsystems due (1 << ESubsystem) */
+	uint32 Advance(float DeltaSeconds);
+
+	/**
+	 * Slow every rate down, eg for cars far from the view. Subsystems that run every frame keep doing so.
+	 * @param	Scale	share of the configured rates, 1 for full rate
+	 */
+	void SetRateScale(float Scale);
+
+	/** Run everything on the next Advance, eg after a teleport or becoming the view target */
+	void ForceAll() { bForceAll = true; }
+
+	static bool IsDue(uint32 DueMask, ESubsystem Subsystem)
+	{
+		return (DueMask & (1 << Subsystem)) != 0;
+	}
+
+private:
+	/** Seconds between updates from the rates, 0 for every frame */
+	float BaseInterval[NumSubsystems];
+	/** Seconds between updates after the rate scale */
+	float Interval[NumSubsystems];
+	/** Seconds until the next update */
+	float TimeLeft[NumSubsystems];
+	bool bForceAll;
+};
@@ -0,0 +1,350 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleTelemetry.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVehicleTelemetry, Log, All);
+
+namespace VehicleTelemetryFormat
+{
+	void Quantize(const FVehicleTelemetrySample& Sample, int64 (&OutValues)[NumColumns])
+	{
+		OutValues[Time] = Sample.TimeUs;
+		// cm/s and whole RPM are finer than anything we display
+		OutValues[Speed] = FMath::RoundToInt(Sample.Speed);
+		OutValues[RPM] = FMath::RoundToInt(Sample.RPM);
+		OutValues[Gear] = Sample.Gear;
+		OutValues[Throttle] = FMath::RoundToInt(Sample.Throttle * 1000.0f);
+		OutValues[Steering] = FMath::RoundToInt(Sample.Steering * 1000.0f);
+		OutValues[Handbrake] = Sample.bHandbrake ? 1 : 0;
+		OutValues[Lap] = Sample.Lap;
+		// Millimetres
+		OutValues[LocationX] = FMath::RoundToInt(Sample.Location.X * 10.0f);
+		OutValues[LocationY] = FMath::RoundToInt(Sample.Location.Y * 10.0f);
+		OutValues[LocationZ] = FMath::RoundToInt(Sample.Location.Z * 10.0f);
+		OutValues[Pitch] = FRotator::CompressAxisToShort(Sample.Rotation.Pitch);
+		OutValues[Yaw] = FRotator::CompressAxisToShort(Sample.Rotation.Yaw);
+		OutValues[Roll] = FRotator::CompressAxisToShort(Sample.Rotation.Roll);
+	}
+
+	void Dequantize(const int64* Values, FVehicleTelemetrySample& OutSample)
+	{
+		OutSample.TimeUs = Values[Time];
+		OutSample.Speed = (float)Values[Speed];
+		OutSample.RPM = (float)Values[RPM];
+		OutSample.Gear = (int32)Values[Gear];
+		OutSample.Throttle = (float)Values[Throttle] / 1000.0f;
+		OutSample.Steering = (float)Values[Steering] / 1000.0f;
+		OutSample.bHandbrake = Values[Handbrake] != 0;
+		OutSample.Lap = (int32)Values[Lap];
+		OutSample.Location = FVector(Values[LocationX] / 10.0f, Values[LocationY] / 10.0f, Values[LocationZ] / 10.0f);
+		OutSample.Rotation.Pitch = FRotator::DecompressAxisFromShort((uint16)Values[Pitch]);
+		OutSample.Rotation.Yaw = FRotator::DecompressAxisFromShort((uint16)Values[Yaw]);
+		OutSample.Rotation.Roll = FRotator::DecompressAxisFromShort((uint16)Values[Roll]);
+	}
+
+	void WriteVarInt(TArray<uint8>& Out, int64 Value)
+	{
+		// Zigzag so small negative deltas stay small
+		uint64 Bits = ((uint64)Value << 1) ^ (uint64)(Value >> 63);
+		while (Bits >= 0x80)
+		{
+			Out.Add((uint8)(Bits | 0x80));
+			Bits >>= 7;
+		}
+		Out.Add((uint8)Bits);
+	}
+
+	bool ReadVarInt(const uint8*& Cursor, const uint8* End, int64& OutValue)
+	{
+		uint64 Bits = 0;
+		int32 Shift = 0;
+		while (Cursor < End)
+		{
+			const uint8 Byte = *Cursor++;
+			Bits |= (uint64)(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				OutValue = (int64)(Bits >> 1) ^ -(int64)(Bits & 1);
+				return true;
+			}
+			Shift += 7;
+			if (Shift >= 64)
+			{
+				break;
+			}
+		}
+		return false;
+	}
+}
+
+FVehicleTelemetryRecorder& FVehicleTelemetryRecorder::Get()
+{
+	static FVehicleTelemetryRecorder Recorder;
+	return Recorder;
+}
+
+FVehicleTelemetryRecorder::FVehicleTelemetryRecorder()
+	: ChannelCapacity(512)
+	, BlockSize(VehicleTelemetryFormat::DefaultBlockSize)
+	, bRecording(false)
+	, Thread(nullptr)
+{
+}
+
+FVehicleTelemetryRecorder::~FVehicleTelemetryRecorder()
+{
+	StopRecording();
+}
+
+void FVehicleTelemetryRecorder::StartRecording()
+{
+	check(IsInGameThread());
+	if (bRecording == true)
+	{
+		return;
+	}
+
+	SessionDirectory = FPaths::GameSavedDir() / TEXT("Telemetry") / FDateTime::Now().ToString();
+	IFileManager::Get().MakeDirectory(*SessionDirectory, true);
+	ChannelNameCounts.Empty();
+
+	StopTaskCounter.Reset();
+	bRecording = true;
+	Thread = FRunnableThread::Create(this, TEXT("VehicleTelemetryWriter"), 0, TPri_BelowNormal);
+
+	UE_LOG(LogVehicleTelemetry, Log, TEXT("Recording telemetry to %s"), *SessionDirectory);
+}
+
+void FVehicleTelemetryRecorder::StopRecording()
+{
+	if (bRecording == false)
+	{
+		return;
+	}
+
+	// The writer flushes and closes every file on the way out
+	Stop();
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+	bRecording = false;
+
+	UE_LOG(LogVehicleTelemetry, Log, TEXT("Telemetry recording stopped"));
+}
+
+FVehicleTelemetryChannelPtr FVehicleTelemetryRecorder::OpenChannel(const FString& Name)
+{
+	check(IsInGameThread());
+	if (bRecording == false)
+	{
+		return nullptr;
+	}
+
+	// A pooled car comes back under the same name, its earlier drive keeps its file
+	int32& NameCount = ChannelNameCounts.FindOrAdd(Name);
+	const FString Filename = SessionDirectory / ((NameCount == 0) ? FString::Printf(TEXT("%s.vtel"), *Name) : FString::Printf(TEXT("%s.%d.vtel"), *Name, NameCount));
+	++NameCount;
+
+	FVehicleTelemetryChannelPtr Channel = MakeShareable(new FVehicleTelemetryChannel(Name, Filename, ChannelCapacity));
+	{
+		FScopeLock Lock(&NewChannelsLock);
+		NewChannels.Add(Channel);
+	}
+	return Channel;
+}
+
+void FVehicleTelemetryRecorder::CloseChannel(const FVehicleTelemetryChannelPtr& Channel)
+{
+	if (Channel.IsValid())
+	{
+		Channel->bOpen.Set(0);
+	}
+}
+
+void FVehicleTelemetryRecorder::Stop()
+{
+	StopTaskCounter.Increment();
+}
+
+uint32 FVehicleTelemetryRecorder::Run()
+{
+	while (StopTaskCounter.GetValue() == 0)
+	{
+		if (DrainChannels(false) == 0)
+		{
+			FPlatformProcess::Sleep(0.005f);
+		}
+	}
+	DrainChannels(true);
+	return 0;
+}
+
+int32 FVehicleTelemetryRecorder::DrainChannels(bool bFlush)
+{
+	// Take the new channels and create their files outside the lock so OpenChannel never waits on disk
+	TArray<FVehicleTelemetryChannelPtr> ChannelsToOpen;
+	{
+		FScopeLock Lock(&NewChannelsLock);
+		Exchange(ChannelsToOpen, NewChannels);
+	}
+
+	for (int32 Index = 0; Index < ChannelsToOpen.Num(); ++Index)
+	{
+		const FString& Filename = ChannelsToOpen[Index]->GetFilename();
+		FArchive* File = IFileManager::Get().CreateFileWriter(*Filename);
+		if (File == nullptr)
+		{
+			UE_LOG(LogVehicleTelemetry, Warning, TEXT("Could not create %s"), *Filename);
+			ChannelsToOpen[Index]->bOpen.Set(0);
+			continue;
+		}
+
+		uint32 Magic = VehicleTelemetryFormat::Magic;
+		uint32 Version = VehicleTelemetryFormat::Version;
+		FString Name = ChannelsToOpen[Index]->GetName();
+		*File << Magic << Version << BlockSize << Name;
+
+		FChannelWriter& Writer = Writers[Writers.AddDefaulted()];
+		Writer.Channel = ChannelsToOpen[Index];
+		Writer.File = File;
+		Writer.Pending.Reserve(BlockSize * 2);
+	}
+
+	int32 NumMoved = 0;
+	for (int32 WriterIndex = Writers.Num() - 1; WriterIndex >= 0; --WriterIndex)
+	{
+		FChannelWriter& Writer = Writers[WriterIndex];
+
+		// Read the flag before draining so everything pushed before the close is picked up
+		const bool bClosing = bFlush || (Writer.Channel->IsOpen() == false);
+
+		FVehicleTelemetrySample Sample;
+		while (Writer.Channel->Queue.Dequeue(Sample))
+		{
+			Writer.Pending.Add(Sample);
+			++NumMoved;
+
+			if ((uint32)Writer.Pending.Num() >= BlockSize)
+			{
+				WriteBlock(Writer);
+			}
+		}
+
+		if (bClosing == true)
+		{
+			FinishFile(Writer);
+			Writers.RemoveAtSwap(WriterIndex);
+		}
+	}
+	return NumMoved;
+}
+
+void FVehicleTelemetryRecorder::WriteBlock(FChannelWriter& Writer)
+{
+	using namespace VehicleTelemetryFormat;
+
+	const int32 NumSamples = FMath::Min<int32>(Writer.Pending.Num(), BlockSize);
+	if (NumSamples == 0)
+	{
+		return;
+	}
+
+	for (int32 Column = 0; Column < NumColumns; ++Column)
+	{
+		Writer.ColumnBytes[Column].Reset();
+	}
+
+	// Every block deltas from zero so it can be decoded without its neighbours
+	int64 Previous[NumColumns] = { 0 };
+	int64 Values[NumColumns];
+	for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		Quantize(Writer.Pending[SampleIndex], Values);
+		for (int32 Column = 0; Column < NumColumns; ++Column)
+		{
+			int64 Delta = Values[Column] - Previous[Column];
+			if (IsWrappedColumn(Column))
+			{
+				// Shortest way round the circle
+				Delta = (int16)(uint16)Delta;
+			}
+			WriteVarInt(Writer.ColumnBytes[Column], Delta);
+			Previous[Column] = Values[Column];
+		}
+	}
+
+	FBlockInfo& Info = Writer.Index[Writer.Index.AddUninitialized()];
+	Info.FirstTimeUs = Writer.Pending[0].TimeUs;
+	Info.LastTimeUs = Writer.Pending[NumSamples - 1].TimeUs;
+	Info.Offset = Writer.File->Tell();
+	Info.NumSamples = NumSamples;
+	Info.FirstLap = Writer.Pending[0].Lap;
+
+	FArchive& File = *Writer.File;
+	uint32 BlockSamples = NumSamples;
+	File << BlockSamples;
+	for (int32 Column = 0; Column < NumColumns; ++Column)
+	{
+		uint32 ColumnSize = Writer.ColumnBytes[Column].Num();
+		File << ColumnSize;
+		File.Serialize(Writer.ColumnBytes[Column].GetData(), ColumnSize);
+	}
+
+	Writer.Pending.RemoveAt(0, NumSamples, false);
+}
+
+void FVehicleTelemetryRecorder::FinishFile(FChannelWriter& Writer)
+{
+	while (Writer.Pending.Num() > 0)
+	{
+		WriteBlock(Writer);
+	}
+
+	FArchive& File = *Writer.File;
+	int64 IndexOffset = File.Tell();
+	int32 NumBlocks = Writer.Index.Num();
+	File << NumBlocks;
+	for (int32 BlockIndex = 0; BlockIndex < NumBlocks; ++BlockIndex)
+	{
+		VehicleTelemetryFormat::FBlockInfo& Info = Writer.Index[BlockIndex];
+		File << Info.FirstTimeUs << Info.LastTimeUs << Info.Offset << Info.NumSamples << Info.FirstLap;
+	}
+	uint32 Magic = VehicleTelemetryFormat::Magic;
+	File << IndexOffset << Magic;
+
+	File.Close();
+	delete Writer.File;
+	Writer.File = nullptr;
+
+	Writer.Channel->bOpen.Set(0);
+	if (Writer.Channel->GetNumDropped() > 0)
+	{
+		UE_LOG(LogVehicleTelemetry, Warning, TEXT("%s dropped %d samples, the writer could not keep up"), *Writer.Channel->GetName(), Writer.Channel->GetNumDropped());
+	}
+}
+
+static void StartTelemetryRecording()
+{
+	FVehicleTelemetryRecorder::Get().StartRecording();
+}
+
+static void StopTelemetryRecording()
+{
+	FVehicleTelemetryRecorder::Get().StopRecording();
+}
+
+static FAutoConsoleCommand StartTelemetryCommand(
+	TEXT("Vehicle.Telemetry.Start"),
+	TEXT("Start recording telemetry for every vehicle to Saved/Telemetry"),
+	FConsoleCommandDelegate::CreateStatic(&StartTelemetryRecording)
+	);
+
+static FAutoConsoleCommand StopTelemetryCommand(
+	TEXT("Vehicle.Telemetry.Stop"),
+	TEXT("Stop recording vehicle telemetry and close the files"),
+	FConsoleCommandDelegate::CreateStatic(&StopTelemetryRecording)
+	);
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Containers/CircularQueue.h"
+
+/** State of one vehicle for one tick */
+struct FVehicleTelemetrySample
+{
+	/** Simulation time the sample was taken at */
+	int64 TimeUs;
+	/** Forward speed in cm/s */
+	float Speed;
+	float RPM;
+	int32 Gear;
+	float Throttle;
+	float Steering;
+	bool bHandbrake;
+	/** Lap the vehicle was on */
+	int32 Lap;
+	FVector Location;
+	FRotator Rotation;
+};
+
+/**
+ * On disk layout of a telemetry file (.vtel)
+ *
+ *	Header		Magic, Version, BlockSize, Name
+ *	Block*		NumSamples then one chunk per column (EColumn order). Each chunk is its byte size
+ *				followed by the zigzag varint deltas of the quantized column. Every block starts
+ *				from zero so it can be decoded on its own.
+ *	Index		Num entries of { FirstTimeUs, LastTimeUs, Offset, NumSamples, FirstLap }
+ *	Footer		IndexOffset, Magic
+ */
+namespace VehicleTelemetryFormat
+{
+	const uint32 Magic = 0x4C455456; // 'VTEL'
+	const uint32 Version = 1;
+	const uint32 DefaultBlockSize = 256;
+
+	enum EColumn
+	{
+		Time,
+		Speed,
+		RPM,
+		Gear,
+		Throttle,
+		Steering,
+		Handbrake,
+		Lap,
+		LocationX,
+		LocationY,
+		LocationZ,
+		Pitch,
+		Yaw,
+		Roll,
+		NumColumns
+	};
+
+	/** Entry in the seek index */
+	struct FBlockInfo
+	{
+		int64 FirstTimeUs;
+		int64 LastTimeUs;
+		int64 Offset;
+		uint32 NumSamples;
+		int32 FirstLap;
+	};
+
+	/** Quantize one sample into its column values */
+	void Quantize(const FVehicleTelemetrySample& Sample, int64 (&OutValues)[NumColumns]);
+
+	/** Rebuild a sample from NumColumns column values */
+	void Dequantize(const int64* Values, FVehicleTelemetrySample& OutSample);
+
+	/** Columns holding 16 bit angles whose deltas wrap */
+	FORCEINLINE bool IsWrappedColumn(int32 Column)
+	{
+		return (Column == Pitch) || (Column == Yaw) || (Column == Roll);
+	}
+
+	/** Append a zigzag varint */
+	void WriteVarInt(TArray<uint8>& Out, int64 Value);
+
+	/** Read a zigzag varint, @return false if it runs past End */
+	bool ReadVarInt(const uint8*& Cursor, const uint8* End, int64& OutValue);
+}
+
+/**
+ * Single producer / single consumer stream of samples for one vehicle.
+ * The game thread enqueues, the recorder's writer thread dequeues. Neither side takes a lock.
+ */
+class FVehicleTelemetryChannel
+{
+public:
+	FVehicleTelemetryChannel(const FString& InName, const FString& InFilename, uint32 Capacity)
+		: Name(InName)
+		, Filename(InFilename)
+		, Queue(Capacity)
+		, bOpen(1)
+	{
+	}
+
+	/** Queue a sample, called from the game thread only. Drops the sample if the writer has fallen behind */
+	FORCEINLINE void Push(const FVehicleTelemetrySample& Sample)
+	{
+		if (Queue.Enqueue(Sample) == false)
+		{
+			NumDropped.Increment();
+		}
+	}
+
+	/** Still accepted by the recorder */
+	bool IsOpen() const { return bOpen.GetValue() != 0; }
+
+	/** Samples lost because the queue was full */
+	int32 GetNumDropped() const { return NumDropped.GetValue(); }
+
+	const FString& GetName() const { return Name; }
+
+	/** File the channel is written to, in the session directory */
+	const FString& GetFilename() const { return Filename; }
+
+private:
+	friend class FVehicleTelemetryRecorder;
+
+	FString Name;
+	FString Filename;
+	TCircularQueue<FVehicleTelemetrySample> Queue;
+	FThreadSafeCounter bOpen;
+	FThreadSafeCounter NumDropped;
+};
+
+typedef TSharedPtr<FVehicleTelemetryChannel, ESPMode::ThreadSafe> FVehicleTelemetryChannelPtr;
+
+/**
+ * Records telemetry channels to disk on a background thread.
+ * Each channel becomes its own file in the session directory.
+ */
+class FVehicleTelemetryRecorder : public FRunnable
+{
+public:
+	static FVehicleTelemetryRecorder& Get();
+
+	/** Start a recording session writing to Saved/Telemetry/<timestamp> */
+	void StartRecording();
+
+	/** Flush and close every channel and stop the writer thread */
+	void StopRecording();
+
+	bool IsRecording() const { return bRecording; }
+
+	/**
+	 * Open a stream for one vehicle, must be called on the game thread. The file is named after the
+	 * vehicle, a name opened again in the same session gets a sequence number so earlier files are kept.
+	 */
+	FVehicleTelemetryChannelPtr OpenChannel(const FString& Name);
+
+	/** Stop accepting samples from a vehicle, what was queued is still written */
+	void CloseChannel(const FVehicleTelemetryChannelPtr& Channel);
+
+	/** Directory of the current (or last) session */
+	const FString& GetSessionDirectory() const { return SessionDirectory; }
+
+	// Begin FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable interface
+
+private:
+	FVehicleTelemetryRecorder();
+	~FVehicleTelemetryRecorder();
+
+	/** Writer side state of one channel */
+	struct FChannelWriter
+	{
+		FVehicleTelemetryChannelPtr Channel;
+		FArchive* File;
+		/** Samples waiting for a full block */
+		TArray<FVehicleTelemetrySample> Pending;
+		TArray<VehicleTelemetryFormat::FBlockInfo> Index;
+		/** Scratch buffers reused for every block */
+		TArray<uint8> ColumnBytes[VehicleTelemetryFormat::NumColumns];
+	};
+
+	/** Drain every channel once, @return number of samples moved */
+	int32 DrainChannels(bool bFlush);
+
+	void WriteBlock(FChannelWriter& Writer);
+	void FinishFile(FChannelWriter& Writer);
+
+	/** Samples buffered per channel between the game and writer threads */
+	uint32 ChannelCapacity;
+	uint32 BlockSize;
+
+	bool bRecording;
+	FString SessionDirectory;
+
+	/** Channels opened per name this session, for unique file names */
+	TMap<FString, int32> ChannelNameCounts;
+
+	FRunnableThread* Thread;
+	FThreadSafeCounter StopTaskCounter;
+
+	/** Channels added on the game thread and not yet picked up by the writer */
+	FCriticalSection NewChannelsLock;
+	TArray<FVehicleTelemetryChannelPtr> NewChannels;
+
+	/** Only touched by the writer thread */
+	TArray<FChannelWriter> Writers;
+};
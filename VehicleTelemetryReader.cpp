@@ -0,0 +1,348 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "F.h"
+#include "VehicleTelemetryReader.h"
+
+#if PLATFORM_WINDOWS
+#include "AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "HideWindowsPlatformTypes.h"
+#elif PLATFORM_LINUX || PLATFORM_MAC
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogVehicleTelemetryReader, Log, All);
+
+namespace
+{
+	/** Bounds checked reads of the little endian values FArchive wrote */
+	template<typename T>
+	bool ReadValue(const uint8*& Cursor, const uint8* End, T& OutValue)
+	{
+		if (Cursor + sizeof(T) > End)
+		{
+			return false;
+		}
+		FMemory::Memcpy(&OutValue, Cursor, sizeof(T));
+		Cursor += sizeof(T);
+		return true;
+	}
+
+	/** Read an FString as serialized by FArchive */
+	bool ReadString(const uint8*& Cursor, const uint8* End, FString& OutString)
+	{
+		int32 SaveNum = 0;
+		if (ReadValue(Cursor, End, SaveNum) == false)
+		{
+			return false;
+		}
+		if (SaveNum == 0)
+		{
+			OutString.Empty();
+			return true;
+		}
+
+		// Negative length means UCS2, MIN_int32 has no positive length
+		if (SaveNum == MIN_int32)
+		{
+			return false;
+		}
+		const bool bUnicode = SaveNum < 0;
+		const int32 NumChars = FMath::Abs(SaveNum);
+		const int64 NumBytes = bUnicode ? (int64)NumChars * sizeof(UCS2CHAR) : (int64)NumChars;
+		if (NumBytes > (int64)(End - Cursor))
+		{
+			return false;
+		}
+
+		if (bUnicode == true)
+		{
+			OutString = FString(NumChars - 1, (const UCS2CHAR*)Cursor);
+		}
+		else
+		{
+			OutString = FString(NumChars - 1, (const ANSICHAR*)Cursor);
+		}
+		Cursor += NumBytes;
+		return true;
+	}
+}
+
+FVehicleTelemetryReader::FVehicleTelemetryReader()
+	: Data(nullptr)
+	, DataSize(0)
+	, FileHandle(nullptr)
+	, MappingHandle(nullptr)
+	, NumSamples(0)
+{
+}
+
+FVehicleTelemetryReader::~FVehicleTelemetryReader()
+{
+	Close();
+}
+
+bool FVehicleTelemetryReader::Open(const FString& Filename)
+{
+	using namespace VehicleTelemetryFormat;
+
+	Close();
+	if (MapFile(Filename) == false)
+	{
+		UE_LOG(LogVehicleTelemetryReader, Warning, TEXT("Could not open %s"), *Filename);
+		return false;
+	}
+
+	const uint8* End = Data + DataSize;
+	const uint8* Cursor = Data;
+	uint32 FileMagic = 0, FileVersion = 0, BlockSize = 0;
+	bool bValid = ReadValue(Cursor, End, FileMagic) && ReadValue(Cursor, End, FileVersion) && ReadValue(Cursor, End, BlockSize) && ReadString(Cursor, End, Name);
+	bValid = bValid && (FileMagic == Magic) && (FileVersion == Version);
+
+	// Footer is the index offset followed by the magic again
+	int64 IndexOffset = 0;
+	uint32 FooterMagic = 0;
+	if (bValid == true)
+	{
+		const int32 FooterSize = sizeof(int64) + sizeof(uint32);
+		const uint8* Footer = End - FooterSize;
+		bValid = (DataSize >= FooterSize) && ReadValue(Footer, End, IndexOffset) && ReadValue(Footer, End, FooterMagic);
+		bValid = bValid && (FooterMagic == Magic) && (IndexOffset > 0) && (IndexOffset < DataSize);
+	}
+
+	if (bValid == true)
+	{
+		Cursor = Data + IndexOffset;
+		int32 NumBlocks = 0;
+		bValid = ReadValue(Cursor, End, NumBlocks) && (NumBlocks >= 0);
+
+		// The count comes from the file, don't reserve more entries than the rest of it can hold
+		const int64 EntrySize = sizeof(int64) * 3 + sizeof(uint32) + sizeof(int32);
+		bValid = bValid && ((int64)NumBlocks * EntrySize <= (int64)(End - Cursor));
+		if (bValid == true)
+		{
+			Index.Reserve(NumBlocks);
+		}
+		for (int32 BlockIndex = 0; bValid && (BlockIndex < NumBlocks); ++BlockIndex)
+		{
+			FBlockInfo& Info = Index[Index.AddUninitialized()];
+			bValid = ReadValue(Cursor, End, Info.FirstTimeUs) && ReadValue(Cursor, End, Info.LastTimeUs) && ReadValue(Cursor, End, Info.Offset)
+				&& ReadValue(Cursor, End, Info.NumSamples) && ReadValue(Cursor, End, Info.FirstLap);
+			NumSamples += bValid ? Info.NumSamples : 0;
+		}
+	}
+
+	if (bValid == false)
+	{
+		UE_LOG(LogVehicleTelemetryReader, Warning, TEXT("%s is not a complete telemetry file"), *Filename);
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FVehicleTelemetryReader::Close()
+{
+	UnmapFile();
+	Name.Empty();
+	Index.Empty();
+	NumSamples = 0;
+}
+
+int32 FVehicleTelemetryReader::FindBlock(int64 TimeUs) const
+{
+	if (Index.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	// Last block starting at or before TimeUs
+	int32 Low = 0;
+	int32 High = Index.Num() - 1;
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High + 1) / 2;
+		if (Index[Mid].FirstTimeUs <= TimeUs)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid - 1;
+		}
+	}
+	return Low;
+}
+
+int32 FVehicleTelemetryReader::FindLapStartBlock(int32 Lap) const
+{
+	// The lap can start part way through the block before the first one that begins on (or after) it
+	for (int32 BlockIndex = 0; BlockIndex < Index.Num(); ++BlockIndex)
+	{
+		if (Index[BlockIndex].FirstLap >= Lap)
+		{
+			if (BlockIndex == 0)
+			{
+				return (Index[0].FirstLap == Lap) ? 0 : INDEX_NONE;
+			}
+			return BlockIndex - 1;
+		}
+	}
+	return (Index.Num() > 0) ? Index.Num() - 1 : INDEX_NONE;
+}
+
+bool FVehicleTelemetryReader::DecodeBlock(int32 BlockIndex, TArray<FVehicleTelemetrySample>& OutSamples) const
+{
+	using namespace VehicleTelemetryFormat;
+
+	if (Index.IsValidIndex(BlockIndex) == false)
+	{
+		return false;
+	}
+
+	// The index comes from the file too, so don't trust it to point inside the mapping
+	const FBlockInfo& Info = Index[BlockIndex];
+	if ((Info.Offset < 0) || (Info.Offset >= DataSize))
+	{
+		return false;
+	}
+
+	const uint8* End = Data + DataSize;
+	const uint8* Cursor = Data + Info.Offset;
+	uint32 BlockSamples = 0;
+	if ((ReadValue(Cursor, End, BlockSamples) == false) || (BlockSamples != Info.NumSamples))
+	{
+		return false;
+	}
+
+	// Every column has a size and at least one byte per sample, so a count the rest of the file can't hold is corrupt
+	const int64 MinBlockSize = (int64)NumColumns * (sizeof(uint32) + (int64)BlockSamples);
+	if (MinBlockSize > (int64)(End - Cursor))
+	{
+		return false;
+	}
+
+	const int32 FirstSample = OutSamples.AddZeroed(BlockSamples);
+	FVehicleTelemetrySample* Samples = OutSamples.GetData() + FirstSample;
+
+	// Decode column by column straight into the samples, then convert each row back
+	TArray<int64> Values;
+	Values.AddUninitialized(BlockSamples * NumColumns);
+	for (int32 Column = 0; Column < NumColumns; ++Column)
+	{
+		uint32 ColumnSize = 0;
+		if ((ReadValue(Cursor, End, ColumnSize) == false) || ((int64)ColumnSize > (int64)(End - Cursor)))
+		{
+			OutSamples.SetNum(FirstSample);
+			return false;
+		}
+
+		const uint8* ColumnCursor = Cursor;
+		const uint8* ColumnEnd = Cursor + ColumnSize;
+		int64 Value = 0;
+		for (uint32 SampleIndex = 0; SampleIndex < BlockSamples; ++SampleIndex)
+		{
+			int64 Delta = 0;
+			if (ReadVarInt(ColumnCursor, ColumnEnd, Delta) == false)
+			{
+				OutSamples.SetNum(FirstSample);
+				return false;
+			}
+			Value += Delta;
+			if (IsWrappedColumn(Column))
+			{
+				Value &= 0xFFFF;
+			}
+			Values[SampleIndex * NumColumns + Column] = Value;
+		}
+		Cursor = ColumnEnd;
+	}
+
+	for (uint32 SampleIndex = 0; SampleIndex < BlockSamples; ++SampleIndex)
+	{
+		Dequantize(&Values[SampleIndex * NumColumns], Samples[SampleIndex]);
+	}
+	return true;
+}
+
+bool FVehicleTelemetryReader::MapFile(const FString& Filename)
+{
+	const FString FullPath = FPaths::ConvertRelativePathToFull(Filename);
+
+#if PLATFORM_WINDOWS
+	HANDLE File = CreateFileW(*FullPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER Size;
+		HANDLE Mapping = (GetFileSizeEx(File, &Size) && (Size.QuadPart > 0)) ? CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+		const void* View = (Mapping != nullptr) ? MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (View != nullptr)
+		{
+			FileHandle = File;
+			MappingHandle = Mapping;
+			Data = (const uint8*)View;
+			DataSize = Size.QuadPart;
+			return true;
+		}
+		if (Mapping != nullptr)
+		{
+			CloseHandle(Mapping);
+		}
+		CloseHandle(File);
+	}
+#elif PLATFORM_LINUX || PLATFORM_MAC
+	const int File = open(TCHAR_TO_UTF8(*FullPath), O_RDONLY);
+	if (File >= 0)
+	{
+		struct stat FileStat;
+		if ((fstat(File, &FileStat) == 0) && (FileStat.st_size > 0))
+		{
+			void* View = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+			if (View != MAP_FAILED)
+			{
+				// The mapping keeps the file alive
+				close(File);
+				Data = (const uint8*)View;
+				DataSize = FileStat.st_size;
+				MappingHandle = View;
+				return true;
+			}
+		}
+		close(File);
+	}
+#endif
+
+	// No mapping on this platform (or it failed), read it in one go
+	if (FFileHelper::LoadFileToArray(LoadedData, *FullPath, FILEREAD_Silent) && (LoadedData.Num() > 0))
+	{
+		Data = LoadedData.GetData();
+		DataSize = LoadedData.Num();
+		return true;
+	}
+	return false;
+}
+
+void FVehicleTelemetryReader::UnmapFile()
+{
+#if PLATFORM_WINDOWS
+	if (MappingHandle != nullptr)
+	{
+		UnmapViewOfFile(Data);
+		CloseHandle((HANDLE)MappingHandle);
+		CloseHandle((HANDLE)FileHandle);
+	}
+#elif PLATFORM_LINUX || PLATFORM_MAC
+	if (MappingHandle != nullptr)
+	{
+		munmap(MappingHandle, DataSize);
+	}
+#endif
+	MappingHandle = nullptr;
+	FileHandle = nullptr;
+	Data = nullptr;
+	DataSize = 0;
+	LoadedData.Empty();
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VehicleTelemetry.h"
+
+/**
+ * Reads a telemetry file written by FVehicleTelemetryRecorder.
+ * The file is memory mapped where the platform allows it (loaded in one read otherwise), only the
+ * seek index is parsed on open and blocks are decoded on request.
+ */
+class FVehicleTelemetryReader
+{
+public:
+	FVehicleTelemetryReader();
+	~FVehicleTelemetryReader();
+
+	/** Map the file and read its index */
+	bool Open(const FString& Filename);
+
+	void Close();
+
+	bool IsOpen() const { return Data != nullptr; }
+
+	/** Name of the vehicle the file was recorded from */
+	const FString& GetName() const { return Name; }
+
+	int32 GetNumBlocks() const { return Index.Num(); }
+
+	const VehicleTelemetryFormat::FBlockInfo& GetBlockInfo(int32 BlockIndex) const { return Index[BlockIndex]; }
+
+	int64 GetNumSamples() const { return NumSamples; }
+
+	/** Block holding TimeUs, or the nearest one. INDEX_NONE if the file is empty */
+	int32 FindBlock(int64 TimeUs) const;
+
+	/** First block recorded on Lap, INDEX_NONE if the lap is not in the file */
+	int32 FindLapStartBlock(int32 Lap) const;
+
+	/** Decode one block and append its samples to OutSamples */
+	bool DecodeBlock(int32 BlockIndex, TArray<FVehicleTelemetrySample>& OutSamples) const;
+
+private:
+	bool MapFile(const FString& Filename);
+	void UnmapFile();
+
+	const uint8* Data;
+	int64 DataSize;
+
+	/** Platform handles for the mapping */
+	void* FileHandle;
+	void* MappingHandle;
+	/** Used when the platform can not map files */
+	TArray<uint8> LoadedData;
+
+	FString Name;
+	TArray<VehicleTelemetryFormat::FBlockInfo> Index;
+	int64 NumSamples;
+};